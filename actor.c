@@ -0,0 +1,202 @@
+#include "defs.h"
+
+
+/*
+    Function: landAgent
+    Purpose: Places an agent that has arrived at a room into that room.
+    Params:
+        Input:
+            AgentMessageType *message (in/out) - the arriving agent
+            RoomType *room (in) - the room it arrived at
+        Output: void
+*/
+static void landAgent(AgentMessageType *message, RoomType *room) {
+    if (message->isHunter) {
+        HunterType *hunter = message->agent;
+        // Add the hunter to the room it moved to
+        insertAtHeadHunter(&(room->hunters), hunter);
+        LOG(LOG_HUNTER_MOVE, l_hunterMove(hunter->name, room->name));
+    } else {
+        // Place the ghost in the room it moved to
+        room->ghost = message->agent;
+        LOG(LOG_GHOST_MOVE, l_ghostMove(room->name));
+    }
+    message->arriving = C_FALSE;
+}
+
+
+/*
+    Function: deliverAgent
+    Purpose: Acts for one agent in a room owned by the calling thread, then keeps it in the room or sends it on to the next one.
+    Params:
+        Input:
+            HouseType *house (in) - the house where the agent is
+            AgentMessageType *message (in/out) - the agent to act for
+            RoomType *room (in) - the room the message was delivered to
+        Output: void
+*/
+static void deliverAgent(HouseType *house, AgentMessageType *message, RoomType *room) {
+    // An agent that has just arrived is placed in the room, and acts from the next pass on
+    if (message->arriving) {
+        landAgent(message, room);
+        postMail(&(room->mailbox), &(message->node));
+        return;
+    }
+
+    RoomType *moveTo = NULL;
+    int outcome;
+    if (message->isHunter) {
+        HunterType *hunter = message->agent;
+        outcome = stepHunter(house, hunter, &moveTo);
+        // A moving hunter leaves this room now and is placed by the owner of the next one
+        if (outcome == STEP_MOVING) {
+            removeHunterFromRoom(room, hunter);
+            hunter->currentRoom = moveTo;
+        }
+    } else {
+        GhostType *ghost = message->agent;
+        // Every ghost action is a tick
+        countTick(house);
+        outcome = stepGhost(house, ghost, room, &moveTo);
+        // A moving ghost leaves this room now and is placed by the owner of the next one
+        if (outcome == STEP_MOVING) {
+            room->ghost = NULL;
+            ghost->room = moveTo;
+        }
+    }
+
+    // An agent that left the house is not sent anywhere
+    if (outcome == STEP_STAYED) {
+        postMail(&(room->mailbox), &(message->node));
+    } else if (outcome == STEP_MOVING) {
+        message->arriving = C_TRUE;
+        postMail(&(moveTo->mailbox), &(message->node));
+    }
+}
+
+
+/*
+    Function: roomOwnerThread
+    Purpose: Represents a room-owner thread of the actor engine: acts for every agent in its rooms once per pass, without locking any room.
+    Params:
+        Input: void *arg (in) - the room owner
+        Output: void
+*/
+void *roomOwnerThread(void *arg) {
+    RoomOwnerType *owner = (RoomOwnerType *)arg;
+    HouseType *house = owner->house;
+    // Each owner draws from its own stream of the hunt's seed, after the hunter streams
+    seedRandom(deriveSeed(house->seed, 2 + house->config->hunters + owner->index));
+
+    // Act until the hunt is over
+    while (!isHuntOver(house)) {
+        for (int i = 0; i < owner->numRooms && !isHuntOver(house); i++) {
+            RoomType *room = owner->rooms[i];
+            // Only deliver what is in the mailbox now, so agents kept in the room act again next pass
+            int pending = atomic_load_explicit(&room->mailbox.count, memory_order_relaxed);
+            for (int j = 0; j < pending; j++) {
+                MailNodeType *node = takeMail(&(room->mailbox));
+                // A sender is still linking its message, it will be delivered next pass
+                if (node == NULL) {
+                    break;
+                }
+                deliverAgent(house, (AgentMessageType *)node, room);
+            }
+        }
+        // Sleep for a while before the next pass
+        pauseAgent(house);
+    }
+    // Add the phases this thread timed to the profile
+    flushProfile();
+    return NULL;
+}
+
+
+/*
+    Function: postAgent
+    Purpose: Sends an agent that is already in a room to that room's mailbox, to start acting.
+    Params:
+        Input:
+            AgentMessageType *message (out) - the message embedded in the agent
+            int isHunter (in) - C_TRUE for a hunter, C_FALSE for the ghost
+            void *agent (in) - the hunter or ghost
+            RoomType *room (in) - the room the agent is in
+        Output: void
+*/
+static void postAgent(AgentMessageType *message, int isHunter, void *agent, RoomType *room) {
+    message->isHunter = isHunter;
+    message->arriving = C_FALSE;
+    message->agent = agent;
+    postMail(&(room->mailbox), &(message->node));
+}
+
+
+/*
+    Function: runRoomActors
+    Purpose: Simulates a hunt with the actor engine. Rooms are dealt out to room-owner threads, each agent is a message in the mailbox
+        of its room, and moving sends it to the mailbox of the next room, so no room is ever locked.
+    Params:
+        Input:
+            HouseType *house (in) - the house where the hunters and the ghost are
+        Output: void
+*/
+void runRoomActors(HouseType *house) {
+    int numHunters = house->registry.count;
+    // Every hunter is in the house before any owner can act
+    atomic_store(&house->huntersInHouse, numHunters);
+
+    // Send each hunter, then the ghost, to its room
+    for (int i = 0; i < numHunters; i++) {
+        HunterType *hunter = &house->registry.table[i];
+        metricsAdd(house->metrics, MET_HUNTERS_ALIVE, 1);
+        postAgent(&(hunter->message), C_TRUE, hunter, hunter->currentRoom);
+    }
+    GhostType *ghost = getGhostInHouse(house);
+    postAgent(&(ghost->message), C_FALSE, ghost, ghost->room);
+
+    // Deal the rooms out to the owners in turn, never starting an owner without a room
+    int numRooms = house->rooms.count;
+    int numOwners = house->config->roomOwners < numRooms ? house->config->roomOwners : numRooms;
+    RoomOwnerType owners[numOwners];
+    RoomType *rooms[numRooms];
+    int next = 0;
+    for (int i = 0; i < numOwners; i++) {
+        owners[i].house = house;
+        owners[i].rooms = &rooms[next];
+        owners[i].numRooms = 0;
+        owners[i].index = i;
+        int index = 0;
+        for (RoomNodeType *roomNode = house->rooms.head; roomNode != NULL; roomNode = roomNode->next, index++) {
+            if (index % numOwners == i) {
+                rooms[next++] = roomNode->room;
+                owners[i].numRooms++;
+            }
+        }
+    }
+
+    // Start the owners, recording which thread owns each room
+    pthread_t threads[numOwners];
+    for (int i = 0; i < numOwners; i++) {
+        pthread_create(&threads[i], NULL, roomOwnerThread, (void *)&owners[i]);
+        for (int j = 0; j < owners[i].numRooms; j++) {
+            owners[i].rooms[j]->roomPThread = threads[i];
+        }
+    }
+
+    // Wait for all owners to finish
+    for (int i = 0; i < numOwners; i++) {
+        pthread_join(threads[i], NULL);
+    }
+    huntersStopped(house);
+
+    // Empty every mailbox, placing agents that were still on their way so the house can be summarized and cleaned
+    for (int i = 0; i < numRooms; i++) {
+        MailNodeType *node;
+        while ((node = takeMail(&(rooms[i]->mailbox))) != NULL) {
+            AgentMessageType *message = (AgentMessageType *)node;
+            if (message->arriving) {
+                landAgent(message, rooms[i]);
+            }
+        }
+    }
+}
@@ -0,0 +1,264 @@
+#include "defs.h"
+
+// Heap allocations made through the wrapped allocators since fp-bench started
+static atomic_llong allocations = 0;
+
+// The linker sends the simulator's allocations here, see BENCHLDFLAGS in the Makefile
+void *__real_malloc(size_t size);
+void *__real_calloc(size_t count, size_t size);
+void *__real_realloc(void *pointer, size_t size);
+void *__real_aligned_alloc(size_t alignment, size_t size);
+
+void *__wrap_malloc(size_t size) {
+    atomic_fetch_add_explicit(&allocations, 1, memory_order_relaxed);
+    return __real_malloc(size);
+}
+
+void *__wrap_calloc(size_t count, size_t size) {
+    atomic_fetch_add_explicit(&allocations, 1, memory_order_relaxed);
+    return __real_calloc(count, size);
+}
+
+void *__wrap_realloc(void *pointer, size_t size) {
+    atomic_fetch_add_explicit(&allocations, 1, memory_order_relaxed);
+    return __real_realloc(pointer, size);
+}
+
+void *__wrap_aligned_alloc(size_t alignment, size_t size) {
+    atomic_fetch_add_explicit(&allocations, 1, memory_order_relaxed);
+    return __real_aligned_alloc(alignment, size);
+}
+
+// Names of the measures in the baselines file, in the same order as enum ScenarioMetric
+static const char *metricNames[SCENARIO_METRICS] = {
+    "hunts_per_sec",
+    "p99_micros",
+    "allocs_per_hunt"
+};
+
+
+/*
+    Function: compareDouble
+    Purpose: Orders two doubles for qsort.
+    Params:
+        Input:
+            const void *a (in) - the first value
+            const void *b (in) - the second value
+        Output: int - negative, zero or positive as a is below, equal to or above b
+*/
+static int compareDouble(const void *a, const void *b) {
+    double x = *(const double *)a;
+    double y = *(const double *)b;
+    return (x > y) - (x < y);
+}
+
+
+/*
+    Function: runScenario
+    Purpose: Times a scenario: one untimed repetition, so the process's one-time allocations are left out, then timed ones of
+        SCENARIO_HUNTS hunts each, always from seed 1, so every commit plays exactly the same hunts. Each repetition gives a
+        sample of the hunts per second, of the 99th percentile hunt time and of the allocations per hunt.
+    Params:
+        Input:
+            const BenchScenarioType *scenario (in) - the scenario
+            int reps (in) - repetitions to time, at most BASELINE_MAX_REPS
+            ScenarioRunType *run (out) - the samples
+        Output: void
+*/
+void runScenario(const BenchScenarioType *scenario, int reps, ScenarioRunType *run) {
+    ConfigType config;
+    initConfig(&config);
+    config.actionDelay = 0;
+    config.engine = scenario->engine;
+    config.stepThreads = 1;
+    config.roomOwners = 1;
+    config.gridWidth = scenario->gridWidth;
+    config.gridHeight = scenario->gridHeight;
+    config.policy = scenario->policy;
+    config.radio = scenario->radio;
+
+    run->reps = reps;
+    double micros[SCENARIO_HUNTS];
+    for (int rep = -1; rep < reps; rep++) {
+        long long allocated = atomic_load(&allocations);
+        long long start = monotonicNanos();
+        for (int i = 0; i < SCENARIO_HUNTS; i++) {
+            long long huntStart = monotonicNanos();
+            HuntResultType result;
+            runHunt(&config, 1 + i, NULL, NULL, NULL, NULL, &result);
+            micros[i] = (monotonicNanos() - huntStart) / 1000.0;
+        }
+        long long nanos = monotonicNanos() - start;
+        if (rep < 0) {
+            continue;
+        }
+        qsort(micros, SCENARIO_HUNTS, sizeof(double), compareDouble);
+        run->samples[SCEN_HUNTS_PER_SEC][rep] = SCENARIO_HUNTS * 1e9 / (nanos > 0 ? nanos : 1);
+        run->samples[SCEN_P99_MICROS][rep] = micros[(int)(0.99 * (SCENARIO_HUNTS - 1))];
+        run->samples[SCEN_ALLOCS_PER_HUNT][rep] = (double)(atomic_load(&allocations) - allocated) / SCENARIO_HUNTS;
+    }
+}
+
+
+/*
+    Function: recordBaseline
+    Purpose: Appends the samples of a scenario to a baselines file, one line per measure:
+        COMMIT SCENARIO MEASURE COUNT SAMPLE...
+    Params:
+        Input:
+            const char *path (in) - the baselines file, created if missing
+            const char *commit (in) - the commit the samples were measured at
+            const char *scenario (in) - the name of the scenario
+            const ScenarioRunType *run (in) - the samples
+        Output: int - C_TRUE if the samples were written, C_FALSE otherwise
+*/
+int recordBaseline(const char *path, const char *commit, const char *scenario, const ScenarioRunType *run) {
+    FILE *file = fopen(path, "a");
+    if (file == NULL) {
+        perror(path);
+        return C_FALSE;
+    }
+    for (int metric = 0; metric < SCENARIO_METRICS; metric++) {
+        fprintf(file, "%s %s %s %d", commit, scenario, metricNames[metric], run->reps);
+        for (int rep = 0; rep < run->reps; rep++) {
+            fprintf(file, " %.6g", run->samples[metric][rep]);
+        }
+        fprintf(file, "\n");
+    }
+    return fclose(file) == 0 ? C_TRUE : C_FALSE;
+}
+
+
+/*
+    Function: readBaseline
+    Purpose: Finds the samples of one measure of a scenario in a baselines file: those of a given commit, or else those
+        recorded last. Lines starting with # are comments.
+    Params:
+        Input:
+            const char *path (in) - the baselines file
+            const char *against (in) - the commit to compare against, NULL for the last one recorded
+            const char *scenario (in) - the name of the scenario
+            int metric (in) - the measure, from enum ScenarioMetric
+            double samples[] (out) - the samples, at most BASELINE_MAX_REPS
+            char commit[] (out) - the commit they were measured at, MAX_STR long
+        Output: int - the number of samples, 0 if there were none
+*/
+static int readBaseline(const char *path, const char *against, const char *scenario, int metric, double samples[], char commit[]) {
+    FILE *file = fopen(path, "r");
+    if (file == NULL) {
+        return 0;
+    }
+    int found = 0;
+    char line[4096];
+    while (fgets(line, sizeof(line), file) != NULL) {
+        char lineCommit[MAX_STR], lineScenario[MAX_STR], lineMetric[MAX_STR];
+        int count, offset;
+        if (line[0] == '#' || sscanf(line, "%63s %63s %63s %d%n", lineCommit, lineScenario, lineMetric, &count, &offset) != 4 ||
+            strcmp(lineScenario, scenario) != 0 || strcmp(lineMetric, metricNames[metric]) != 0 ||
+            (against != NULL && strcmp(lineCommit, against) != 0) || count < 1 || count > BASELINE_MAX_REPS) {
+            continue;
+        }
+        // A later line for the same measure replaces an earlier one
+        char *cursor = line + offset;
+        int read = 0;
+        while (read < count && sscanf(cursor, "%lf%n", &samples[read], &offset) == 1) {
+            cursor += offset;
+            read++;
+        }
+        if (read == count) {
+            found = count;
+            strcpy(commit, lineCommit);
+        }
+    }
+    fclose(file);
+    return found;
+}
+
+
+/*
+    Function: bootstrapRatio
+    Purpose: Estimates a 95% confidence interval of the ratio of the mean of new samples to the mean of baseline samples,
+        by resampling both with replacement BOOTSTRAP_RESAMPLES times. The resampling draws from a fixed stream, so the
+        same samples always give the same interval.
+    Params:
+        Input:
+            const double *base (in) - the baseline samples
+            int numBase (in) - how many there are
+            const double *fresh (in) - the new samples
+            int numFresh (in) - how many there are
+            double *low (out) - the lower bound of the ratio
+            double *high (out) - the upper bound of the ratio
+        Output: void
+*/
+static void bootstrapRatio(const double *base, int numBase, const double *fresh, int numFresh, double *low, double *high) {
+    static double ratios[BOOTSTRAP_RESAMPLES];
+    uint64_t state = FNV_OFFSET;
+    for (int i = 0; i < BOOTSTRAP_RESAMPLES; i++) {
+        double baseSum = 0.0, freshSum = 0.0;
+        for (int j = 0; j < numBase; j++) {
+            // xorshift64, apart from the hunts' own random numbers
+            state ^= state << 13;
+            state ^= state >> 7;
+            state ^= state << 17;
+            baseSum += base[state % numBase];
+        }
+        for (int j = 0; j < numFresh; j++) {
+            state ^= state << 13;
+            state ^= state >> 7;
+            state ^= state << 17;
+            freshSum += fresh[state % numFresh];
+        }
+        double baseMean = baseSum / numBase;
+        ratios[i] = baseMean != 0.0 ? (freshSum / numFresh) / baseMean : (freshSum == 0.0 ? 1.0 : 2.0);
+    }
+    qsort(ratios, BOOTSTRAP_RESAMPLES, sizeof(double), compareDouble);
+    *low = ratios[(int)(0.025 * BOOTSTRAP_RESAMPLES)];
+    *high = ratios[(int)(0.975 * BOOTSTRAP_RESAMPLES) - 1];
+}
+
+
+/*
+    Function: compareBaseline
+    Purpose: Compares the samples of a scenario to its baseline and prints a row per measure: both means, the change, its
+        confidence interval and the verdict. A measure regressed only if the whole interval is worse than the threshold, so
+        noise alone rarely fails a run.
+    Params:
+        Input:
+            const char *path (in) - the baselines file
+            const char *against (in) - the commit to compare against, NULL for the last one recorded
+            const char *scenario (in) - the name of the scenario
+            const ScenarioRunType *run (in) - the new samples
+            double threshold (in) - the percentage a measure may worsen by
+        Output: int - C_TRUE if no measure regressed, C_FALSE otherwise
+*/
+int compareBaseline(const char *path, const char *against, const char *scenario, const ScenarioRunType *run, double threshold) {
+    int passed = C_TRUE;
+    for (int metric = 0; metric < SCENARIO_METRICS; metric++) {
+        double base[BASELINE_MAX_REPS];
+        char commit[MAX_STR];
+        int numBase = readBaseline(path, against, scenario, metric, base, commit);
+        double freshMean = 0.0;
+        for (int rep = 0; rep < run->reps; rep++) {
+            freshMean += run->samples[metric][rep] / run->reps;
+        }
+        if (numBase == 0) {
+            printf("%-10s %-16s %12s %12.1f %8s %20s  no baseline\n", scenario, metricNames[metric], "-", freshMean, "-", "-");
+            continue;
+        }
+        double baseMean = 0.0;
+        for (int i = 0; i < numBase; i++) {
+            baseMean += base[i] / numBase;
+        }
+        double low, high;
+        bootstrapRatio(base, numBase, run->samples[metric], run->reps, &low, &high);
+
+        // Throughput regresses downwards, time and allocations upwards
+        int regressed = metric == SCEN_HUNTS_PER_SEC ? high < 1.0 - threshold / 100.0 : low > 1.0 + threshold / 100.0;
+        char interval[MAX_STR];
+        snprintf(interval, sizeof(interval), "[%+.1f%%, %+.1f%%]", 100.0 * (low - 1.0), 100.0 * (high - 1.0));
+        printf("%-10s %-16s %12.1f %12.1f %+7.1f%% %20s  %s vs %s\n", scenario, metricNames[metric], baseMean, freshMean,
+               baseMean != 0.0 ? 100.0 * (freshMean / baseMean - 1.0) : 0.0, interval, regressed ? "REGRESSED" : "ok", commit);
+        passed = passed && !regressed;
+    }
+    return passed;
+}
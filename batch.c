@@ -0,0 +1,417 @@
+#include "defs.h"
+
+
+/*
+    Function: initConfig
+    Purpose: Initializes the runtime parameters of a hunt to the defaults of the original simulation.
+    Params:
+        Input: ConfigType *config (out) - the parameters to initialize
+        Output: void
+*/
+void initConfig(ConfigType *config) {
+    config->hunters = NUM_HUNTERS;
+    config->fearMax = FEAR_MAX;
+    config->boredomMax = BOREDOM_MAX;
+    config->actionDelay = ACTION_DELAY;
+    config->engine = ENGINE_THREADS;
+    config->roomOwners = ROOM_OWNERS;
+    config->stepThreads = STEP_THREADS;
+    config->taskThreads = TASK_THREADS;
+    config->wake = WAKE_DELAY;
+    config->radio = C_FALSE;
+    config->radioLatency = RADIO_LATENCY;
+    config->radioLoss = RADIO_LOSS;
+    config->radioBandwidth = RADIO_BANDWIDTH;
+    config->radioInterval = RADIO_INTERVAL;
+    config->policy = POLICY_RANDOM;
+    config->gridWidth = 0;
+    config->gridHeight = 0;
+    config->evidenceCap = EVIDENCE_CAP;
+    config->evidencePolicy = EVIDENCE_COALESCE;
+    config->samplePeriod = 0;
+    config->sampleStream = C_FALSE;
+}
+
+
+/*
+    Function: parseConfigOption
+    Purpose: Sets one runtime parameter of a hunt from an option and its value, as given on fp's command line. Shared by fp
+        and by the library, so both accept the same options.
+    Params:
+        Input:
+            ConfigType *config (in/out) - the runtime parameters to set, values out of range are checked by validConfig
+            const char *option (in) - the option, such as --fear-max
+            const char *value (in) - its value
+        Output: int - C_TRUE if the option is a runtime parameter, C_FALSE otherwise
+*/
+int parseConfigOption(ConfigType *config, const char *option, const char *value) {
+    if (strcmp(option, "--hunters") == 0) {
+        // Hunters placed in the van
+        config->hunters = atoi(value);
+    } else if (strcmp(option, "--fear-max") == 0) {
+        // Fear at which a hunter leaves
+        config->fearMax = atoi(value);
+    } else if (strcmp(option, "--boredom-max") == 0) {
+        // Boredom at which a hunter or the ghost leaves
+        config->boredomMax = atoi(value);
+    } else if (strcmp(option, "--delay") == 0) {
+        // Microseconds agents sleep between actions
+        config->actionDelay = atoi(value);
+    } else if (strcmp(option, "--engine") == 0) {
+        // How agents are run: a thread each, or as messages between room owners
+        config->engine = strcmp(value, "actor") == 0 ? ENGINE_ACTOR : strcmp(value, "threads") == 0 ? ENGINE_THREADS :
+                         strcmp(value, "lockstep") == 0 ? ENGINE_LOCKSTEP :
+                         strcmp(value, "tasks") == 0 ? ENGINE_TASKS : -1;
+    } else if (strcmp(option, "--wake") == 0) {
+        // How the threads engine paces its agents: a blind sleep, or parked until something happens
+        config->wake = strcmp(value, "delay") == 0 ? WAKE_DELAY : strcmp(value, "event") == 0 ? WAKE_EVENT : -1;
+    } else if (strcmp(option, "--radio") == 0) {
+        // Whether hunters exchange evidence over radios instead of sharing it directly
+        config->radio = strcmp(value, "on") == 0 ? C_TRUE : strcmp(value, "off") == 0 ? C_FALSE : -1;
+    } else if (strcmp(option, "--radio-latency") == 0) {
+        // Actions of the receiver before a report can be used
+        config->radioLatency = atoi(value);
+    } else if (strcmp(option, "--radio-loss") == 0) {
+        // Percentage of reports lost on the air
+        config->radioLoss = atoi(value);
+    } else if (strcmp(option, "--radio-bandwidth") == 0) {
+        // Reports a hunter can take in per action
+        config->radioBandwidth = atoi(value);
+    } else if (strcmp(option, "--radio-interval") == 0) {
+        // Actions between status reports
+        config->radioInterval = atoi(value);
+    } else if (strcmp(option, "--policy") == 0) {
+        // How hunters and the ghost pick where to move
+        config->policy = strcmp(value, "directed") == 0 ? POLICY_DIRECTED : strcmp(value, "random") == 0 ? POLICY_RANDOM : -1;
+    } else if (strcmp(option, "--map") == 0) {
+        // The original house, or a generated grid of W by H rooms
+        config->gridWidth = 0;
+        config->gridHeight = 0;
+        if (strcmp(value, "house") != 0 && sscanf(value, "grid:%dx%d", &config->gridWidth, &config->gridHeight) != 2) {
+            config->gridWidth = -1;
+        }
+    } else if (strcmp(option, "--evidence-cap") == 0) {
+        // Most pieces of evidence a room holds
+        config->evidenceCap = atoi(value);
+    } else if (strcmp(option, "--evidence-policy") == 0) {
+        // What a full room does with a new piece of evidence
+        config->evidencePolicy = strcmp(value, "oldest") == 0 ? EVIDENCE_OLDEST :
+                                 strcmp(value, "coalesce") == 0 ? EVIDENCE_COALESCE : -1;
+    } else if (strcmp(option, "--room-owners") == 0) {
+        // Room-owner threads in the actor engine
+        config->roomOwners = atoi(value);
+    } else if (strcmp(option, "--step-threads") == 0) {
+        // Threads deciding in parallel in the lockstep engine
+        config->stepThreads = atoi(value);
+    } else if (strcmp(option, "--task-threads") == 0) {
+        // Threads of the pool running the tasks engine
+        config->taskThreads = atoi(value);
+    } else {
+        return C_FALSE;
+    }
+    return C_TRUE;
+}
+
+
+/*
+    Function: validConfig
+    Purpose: Checks that every runtime parameter of a hunt is one the simulation can run with.
+    Params:
+        Input: const ConfigType *config (in) - the runtime parameters to check
+        Output: int - C_TRUE if they are valid, C_FALSE otherwise
+*/
+int validConfig(const ConfigType *config) {
+    if (config->hunters < 1 || config->hunters > MAX_ARR || config->fearMax < 1 || config->boredomMax < 1 ||
+        config->actionDelay < 0 || config->engine < 0 || config->roomOwners < 1 || config->stepThreads < 1 || config->taskThreads < 1 ||
+        config->wake < 0 ||
+        config->radio < 0 || config->radioLatency < 0 || config->radioLoss < 0 ||
+        config->radioLoss > 100 || config->radioBandwidth < 1 || config->radioInterval < 0 ||
+        config->policy < 0 || config->evidenceCap < 1 || config->evidencePolicy < 0 || config->gridWidth < 0 || config->gridHeight < 0 ||
+        ((config->gridWidth > 0 || config->gridHeight > 0) &&
+         (config->gridWidth < 1 || config->gridHeight < 1 || config->gridWidth > ROUTE_MAX_ROOMS ||
+          config->gridHeight > ROUTE_MAX_ROOMS || config->gridWidth * config->gridHeight < 2 ||
+          config->gridWidth * config->gridHeight > ROUTE_MAX_ROOMS))) {
+        return C_FALSE;
+    }
+    return C_TRUE;
+}
+
+
+/*
+    Function: nameHunters
+    Purpose: Names the hunters Hunter1, Hunter2, ... for hunts that run unattended.
+    Params:
+        Input:
+            char hunterNames[][MAX_STR] (out) - the names of the hunters
+            int numHunters (in) - the number of hunters
+        Output: void
+*/
+void nameHunters(char hunterNames[][MAX_STR], int numHunters) {
+    for (int i = 0; i < numHunters; i++) {
+        sprintf(hunterNames[i], "Hunter%d", i + 1);
+    }
+}
+
+
+/*
+    Function: setupHunt
+    Purpose: Builds a house for one hunt: rooms, the ghost and the hunters in the van, all drawn from the hunt's seed.
+    Params:
+        Input:
+            HouseType *house (out) - the house to build
+            const ConfigType *config (in) - the runtime parameters of the hunt, must outlive the house
+            unsigned int seed (in) - the seed of the hunt
+            char hunterNames[][MAX_STR] (in) - the names of the config->hunters hunters
+            MetricsType *metrics (in) - the metrics to publish into, may be NULL
+        Output: void
+*/
+void setupHunt(HouseType *house, const ConfigType *config, unsigned int seed, char hunterNames[][MAX_STR], MetricsType *metrics) {
+    // Initialize the house
+    initHouse(house);
+    house->config = config;
+    house->seed = seed;
+    house->metrics = metrics;
+    // Placing the ghost and equipping the hunters draws from the setup stream of the seed
+    seedRandom(deriveSeed(seed, 0));
+
+    // Populate the rooms in the house, from the original map or a generated grid
+    if (config->gridWidth > 0) {
+        populateGrid(house, config->gridWidth, config->gridHeight);
+    } else {
+        populateRooms(house);
+    }
+    // Number the rooms, and look up the next-hop table when movement is directed
+    buildRoutes(house);
+    // Initialize the ghost and place it randomly in the house
+    initAndPlaceGhostRandomly(house);
+    // Register the hunters with the house, in id order, and place them in the van
+    initRegistry(&house->registry, config->hunters);
+    // Every hunter may exit for either reason, so size both lists of exits to the hunters
+    house->huntersExitedFear.hunters = malloc(sizeof(HunterType *) * config->hunters);
+    house->huntersExitedBoredom.hunters = malloc(sizeof(HunterType *) * config->hunters);
+    for (int i = 0; i < config->hunters; i++) {
+        initHunterAndPlaceInVan(house, hunterNames[i]);
+    }
+    // Give the hunters radios, if the hunt uses them
+    setupRadios(house);
+    // Allocate the sample ring up front, so sampling never allocates during the hunt
+    startSamples(house);
+}
+
+
+/*
+    Function: summarizeHunt
+    Purpose: Records the outcome of a finished hunt in its compact form.
+    Params:
+        Input:
+            HouseType *house (in) - the house where the hunt took place
+            HuntResultType *result (out) - the outcome of the hunt
+        Output: void
+*/
+void summarizeHunt(HouseType *house, HuntResultType *result) {
+    // Zero the whole record, padding included, since it is sent as raw bytes
+    memset(result, 0, sizeof(HuntResultType));
+    result->seed = house->seed;
+    result->ticks = atomic_load(&house->ticks);
+    result->exitedFear = house->huntersExitedFear.size;
+    result->exitedBoredom = house->huntersExitedBoredom.size;
+    result->evidenceCollected = house->sharedEvidenceCount;
+    result->outcome = atomic_load(&house->state);
+    result->ghostClass = getGhostInHouse(house)->ghostType;
+    // Only match a ghost when there is enough evidence, as printHouse does
+    result->identifiedClass = reviewEvidence(house) >= 3 ? getGhostMatch(house) : GH_UNKNOWN;
+    result->cached = C_FALSE;
+    result->micros = house->micros;
+    // Add up the traffic of every radio
+    for (int i = 0; house->radios != NULL && i < house->config->hunters; i++) {
+        RadioType *radio = &house->radios[i];
+        result->radioSent += radio->sent;
+        result->radioLost += radio->lost;
+        result->radioDelivered += radio->delivered;
+        result->radioLatency += radio->latency;
+        result->radioWaitMicros += radio->waitNanos / 1000;
+    }
+}
+
+
+/*
+    Function: prepareHunt
+    Purpose: Reuses the outcome of an unattended hunt from the result cache, unless the hunt is sampled, or else builds its
+        house, ready to simulate.
+    Params:
+        Input:
+            const ConfigType *config (in) - the runtime parameters of the hunt
+            unsigned int seed (in) - the seed of the hunt
+            MetricsType *metrics (in) - the metrics to publish into, may be NULL
+            CacheType *cache (in) - the result cache to reuse, may be NULL
+            HeatmapType *heatmap (in) - the room activity the hunt is added to, NULL if not tracked
+            HouseType *house (out) - the house of the hunt, built unless the outcome was cached
+            uint64_t *key (out) - the key of the hunt in the cache, for concludeHunt
+            HuntResultType *result (out) - the outcome of the hunt, if it was cached
+        Output: int - C_TRUE if the house was built and must be simulated, C_FALSE if the outcome was cached
+*/
+int prepareHunt(const ConfigType *config, unsigned int seed, MetricsType *metrics, CacheType *cache, HeatmapType *heatmap,
+                HouseType *house, uint64_t *key, HuntResultType *result) {
+    // Reuse the outcome if this exact hunt was simulated before
+    *key = 0;
+    if (cache != NULL) {
+        *key = cacheKey(config, cache->mapHash, seed);
+        // A sampled hunt is always played, as a cached outcome has no samples, but its outcome is still stored
+        if (config->samplePeriod <= 0 && lookupCache(cache, *key, result) == C_TRUE) {
+            result->cached = C_TRUE;
+            metricsAdd(metrics, MET_RUNS_COMPLETED, 1);
+            return C_FALSE;
+        }
+    }
+
+    // Name the hunters automatically
+    char hunterNames[config->hunters][MAX_STR];
+    nameHunters(hunterNames, config->hunters);
+
+    // Build the house, the hunters' names are copied into it
+    setupHunt(house, config, seed, hunterNames, metrics);
+    if (heatmap != NULL) {
+        trackHeat(house);
+    }
+    return C_TRUE;
+}
+
+
+/*
+    Function: concludeHunt
+    Purpose: Records the outcome of a simulated unattended hunt, then frees its house.
+    Params:
+        Input:
+            HouseType *house (in/out) - the house of the simulated hunt, cleaned on return
+            MetricsType *metrics (in) - the metrics to publish into, may be NULL
+            CacheType *cache (in) - the result cache to extend, may be NULL
+            uint64_t key (in) - the key of the hunt in the cache, from prepareHunt
+            DistributionsType *distributions (in/out) - the distributions to count the hunt in, may be NULL
+            HeatmapType *heatmap (in/out) - the room activity to add the hunt to, may be NULL
+            HuntResultType *result (out) - the outcome of the hunt
+        Output: void
+*/
+void concludeHunt(HouseType *house, MetricsType *metrics, CacheType *cache, uint64_t key, DistributionsType *distributions,
+                  HeatmapType *heatmap, HuntResultType *result) {
+    // Record the outcome before the house is freed
+    summarizeHunt(house, result);
+    recordHunt(distributions, house);
+    addHeat(heatmap, house);
+    writeSamples(house);
+    cleanHouse(house);
+    metricsAdd(metrics, MET_RUNS_COMPLETED, 1);
+
+    // Keep the outcome for the next sweep over the same point, unless it was cancelled
+    if (cache != NULL && result->outcome != HUNT_CANCELLED) {
+        storeCache(cache, key, result);
+    }
+}
+
+
+/*
+    Function: runHunt
+    Purpose: Simulates one unattended hunt from its seed and records its outcome, or reuses the outcome from the result cache.
+    Params:
+        Input:
+            const ConfigType *config (in) - the runtime parameters of the hunt
+            unsigned int seed (in) - the seed of the hunt
+            MetricsType *metrics (in) - the metrics to publish into, may be NULL
+            CacheType *cache (in) - the result cache to reuse and extend, may be NULL
+            DistributionsType *distributions (in/out) - the distributions to count a simulated hunt in, may be NULL
+            HeatmapType *heatmap (in/out) - the room activity to add a simulated hunt to, may be NULL
+            HuntResultType *result (out) - the outcome of the hunt
+        Output: void
+*/
+void runHunt(const ConfigType *config, unsigned int seed, MetricsType *metrics, CacheType *cache, DistributionsType *distributions,
+             HeatmapType *heatmap, HuntResultType *result) {
+    HouseType house;
+    uint64_t key;
+    if (prepareHunt(config, seed, metrics, cache, heatmap, &house, &key, result) == C_FALSE) {
+        return;
+    }
+    // Simulate the hunt until its outcome is decided
+    simulateHunt(&house);
+    concludeHunt(&house, metrics, cache, key, distributions, heatmap, result);
+}
+
+
+/*
+    Function: initSweepSummary
+    Purpose: Initializes an empty sweep summary.
+    Params:
+        Input: SweepSummaryType *summary (out) - the summary to initialize
+        Output: void
+*/
+void initSweepSummary(SweepSummaryType *summary) {
+    memset(summary, 0, sizeof(SweepSummaryType));
+}
+
+
+/*
+    Function: addHuntResult
+    Purpose: Merges the outcome of one hunt into a sweep summary.
+    Params:
+        Input:
+            SweepSummaryType *summary (in/out) - the summary to merge into
+            const HuntResultType *result (in) - the outcome of the hunt
+        Output: void
+*/
+void addHuntResult(SweepSummaryType *summary, const HuntResultType *result) {
+    summary->runs++;
+    summary->cached += result->cached;
+    summary->ticks += result->ticks;
+    summary->micros += result->micros;
+    summary->radioSent += result->radioSent;
+    summary->radioLost += result->radioLost;
+    summary->radioDelivered += result->radioDelivered;
+    summary->radioLatency += result->radioLatency;
+    summary->radioWaitMicros += result->radioWaitMicros;
+    // Count the winner
+    if (result->outcome == HUNT_HUNTERS_WON) {
+        summary->hunterWins++;
+    } else if (result->outcome == HUNT_GHOST_WON) {
+        summary->ghostWins++;
+    } else {
+        summary->cancelled++;
+    }
+    // Count whether the ghost was matched, and whether correctly
+    if (result->identifiedClass != GH_UNKNOWN) {
+        summary->identified++;
+        if (result->identifiedClass == result->ghostClass) {
+            summary->correct++;
+        }
+    }
+}
+
+
+/*
+    Function: printSweepSummary
+    Purpose: Prints the merged outcomes of a sweep.
+    Params:
+        Input: const SweepSummaryType *summary (in) - the summary to print
+        Output: void
+*/
+void printSweepSummary(const SweepSummaryType *summary) {
+    // Avoid dividing by zero when nothing ran
+    double runs = summary->runs > 0 ? (double)summary->runs : 1.0;
+
+    printf("\n=== Sweep Summary ===\n");
+    printf("Hunts simulated:   %lld (%lld from the result cache)\n", summary->runs, summary->cached);
+    printf("Hunters won:       %lld (%.1f%%)\n", summary->hunterWins, 100.0 * summary->hunterWins / runs);
+    printf("Ghost won:         %lld (%.1f%%)\n", summary->ghostWins, 100.0 * summary->ghostWins / runs);
+    printf("Cancelled:         %lld\n", summary->cancelled);
+    printf("Ghost identified:  %lld (%.1f%%)\n", summary->identified, 100.0 * summary->identified / runs);
+    printf("Correctly matched: %lld (%.1f%%)\n", summary->correct, 100.0 * summary->correct / runs);
+    printf("Mean ticks:        %.1f\n", summary->ticks / runs);
+    // Print the radio traffic when the hunters used radios
+    if (summary->radioSent > 0) {
+        printRadio(summary->radioSent, summary->radioLost, summary->radioDelivered, summary->radioLatency,
+                   summary->radioWaitMicros, summary->micros);
+    }
+    // Print the estimates with their confidence intervals
+    printEstimates(summary);
+    // Only mention lost seeds when a worker kept crashing
+    if (summary->failed > 0) {
+        printf("Seeds lost:        %lld (their shard crashed %d times)\n", summary->failed, SHARD_ATTEMPTS);
+    }
+}
@@ -0,0 +1,629 @@
+#include "defs.h"
+#if defined(__x86_64__) || defined(__i386__)
+#include <x86intrin.h> // for __rdtsc
+#endif
+
+// Results the compiler must not optimize away
+static volatile long long benchSink = 0;
+
+
+/*
+    Function: readCycles
+    Purpose: Reads the processor's time stamp counter, which ticks at a constant rate close to the nominal clock.
+    Params:
+        Output: long long - the counter, 0 where there is none
+*/
+static inline long long readCycles() {
+#if defined(__x86_64__) || defined(__i386__)
+    return (long long)__rdtsc();
+#else
+    return 0;
+#endif
+}
+
+
+/*
+    Function: startSample
+    Purpose: Starts timing a repetition.
+    Params:
+        Input: BenchSampleType *sample (out) - the sample, holding the start until stopSample
+        Output: void
+*/
+static void startSample(BenchSampleType *sample) {
+    sample->nanos = monotonicNanos();
+    sample->cycles = readCycles();
+}
+
+
+/*
+    Function: stopSample
+    Purpose: Stops timing a repetition.
+    Params:
+        Input: BenchSampleType *sample (in/out) - the sample started by startSample, holding the elapsed time after
+        Output: void
+*/
+static void stopSample(BenchSampleType *sample) {
+    sample->cycles = readCycles() - sample->cycles;
+    sample->nanos = monotonicNanos() - sample->nanos;
+}
+
+
+/*
+    Function: appendEvidence
+    Purpose: Adds evidence at the tail of an evidence list, so a list keeps its shape after its last node is removed.
+    Params:
+        Input:
+            EvidenceListType *list (in/out) - the list to add to
+            enum EvidenceType type (in) - the evidence to add
+        Output: void
+*/
+static void appendEvidence(EvidenceListType *list, enum EvidenceType type) {
+    Evidence *node = malloc(sizeof(Evidence));
+    node->etype = type;
+    node->next = NULL;
+    if (list->tail == NULL) {
+        list->head = node;
+    } else {
+        list->tail->next = node;
+    }
+    list->tail = node;
+    list->count++;
+}
+
+
+/*
+    Function: fillEvidence
+    Purpose: Fills an empty evidence list with EMF followed by one piece of a target type, which every search has to walk to.
+    Params:
+        Input:
+            EvidenceListType *list (out) - the list to fill
+            int size (in) - the length of the list
+            enum EvidenceType target (in) - the type of the last piece
+        Output: void
+*/
+static void fillEvidence(EvidenceListType *list, int size, enum EvidenceType target) {
+    list->head = NULL;
+    list->tail = NULL;
+    list->count = 0;
+    for (int i = 0; i < size - 1; i++) {
+        appendEvidence(list, EMF);
+    }
+    appendEvidence(list, target);
+}
+
+
+/*
+    Function: fillRoomEvidence
+    Purpose: Fills a room to its cap with one piece of a target type, the oldest, then EMF, so every search from the newest
+        piece has to walk to it.
+    Params:
+        Input:
+            RoomType *room (in/out) - the room to fill
+            ConfigType *config (out) - parameters keeping the oldest pieces first, with the room's length as the cap
+            int size (in) - the number of pieces
+            enum EvidenceType target (in) - the type of the oldest piece
+        Output: void
+*/
+static void fillRoomEvidence(RoomType *room, ConfigType *config, int size, enum EvidenceType target) {
+    initConfig(config);
+    config->evidenceCap = size;
+    config->evidencePolicy = EVIDENCE_OLDEST;
+    leaveEvidence(&(room->evidence), target, config);
+    for (int i = 0; i < size - 1; i++) {
+        leaveEvidence(&(room->evidence), EMF, config);
+    }
+}
+
+
+/*
+    Function: restoreOldest
+    Purpose: Puts a piece of evidence back as the oldest of a room, so the room keeps its shape after that piece is taken.
+    Params:
+        Input:
+            RoomEvidenceType *evidence (in/out) - the evidence of the room, one piece short of its cap
+            enum EvidenceType type (in) - the evidence to put back
+        Output: void
+*/
+static void restoreOldest(RoomEvidenceType *evidence, enum EvidenceType type) {
+    evidence->start = (evidence->start + evidence->capacity - 1) % evidence->capacity;
+    evidence->ring[evidence->start] = type;
+    evidence->counts[type]++;
+    evidence->count++;
+}
+
+
+/*
+    Function: benchInsertHunter
+    Purpose: Times inserting a hunter at the head of a room's hunter list of a given length.
+    Params:
+        Input:
+            int size (in) - the length of the list before inserting
+            int ops (in) - the number of inserts to time
+            BenchSampleType *sample (out) - the time taken
+        Output: void
+*/
+static void benchInsertHunter(int size, int ops, BenchSampleType *sample) {
+    HunterRegistryType registry;
+    initRegistry(&registry, 1);
+    RoomType *room = createRoom("Bench");
+    HunterType *hunter = createHunter(&registry, "Bench", room);
+    for (int i = 0; i < size; i++) {
+        insertAtHeadHunter(&(room->hunters), hunter);
+    }
+
+    startSample(sample);
+    for (int i = 0; i < ops; i++) {
+        insertAtHeadHunter(&(room->hunters), hunter);
+    }
+    stopSample(sample);
+
+    cleanRoom(room);
+    cleanRegistry(&registry);
+}
+
+
+/*
+    Function: benchRemoveHunter
+    Purpose: Times removing the last hunter of a room's hunter list, which walks the whole list, then inserting it back at the head.
+    Params:
+        Input:
+            int size (in) - the length of the list
+            int ops (in) - the number of removals to time
+            BenchSampleType *sample (out) - the time taken
+        Output: void
+*/
+static void benchRemoveHunter(int size, int ops, BenchSampleType *sample) {
+    HunterRegistryType registry;
+    initRegistry(&registry, size);
+    RoomType *room = createRoom("Bench");
+    for (int i = 0; i < size; i++) {
+        char name[MAX_STR];
+        sprintf(name, "Hunter%d", i + 1);
+        insertAtHeadHunter(&(room->hunters), createHunter(&registry, name, room));
+    }
+
+    startSample(sample);
+    for (int i = 0; i < ops; i++) {
+        HunterType *last = room->hunters.tail->hunter;
+        removeHunterFromRoom(room, last);
+        insertAtHeadHunter(&(room->hunters), last);
+    }
+    stopSample(sample);
+
+    cleanRoom(room);
+    cleanRegistry(&registry);
+}
+
+
+/*
+    Function: benchInsertEvidence
+    Purpose: Times inserting evidence at the head of an evidence list of a given length.
+    Params:
+        Input:
+            int size (in) - the length of the list before inserting
+            int ops (in) - the number of inserts to time
+            BenchSampleType *sample (out) - the time taken
+        Output: void
+*/
+static void benchInsertEvidence(int size, int ops, BenchSampleType *sample) {
+    EvidenceListType list;
+    fillEvidence(&list, size, EMF);
+
+    startSample(sample);
+    for (int i = 0; i < ops; i++) {
+        insertAtHeadEvidence(&list, SOUND);
+    }
+    stopSample(sample);
+
+    cleanEvidenceList(&list);
+}
+
+
+/*
+    Function: benchRemoveEvidence
+    Purpose: Times removing the only piece of a type from the tail of an evidence list, then appending it again.
+    Params:
+        Input:
+            int size (in) - the length of the list
+            int ops (in) - the number of removals to time
+            BenchSampleType *sample (out) - the time taken
+        Output: void
+*/
+static void benchRemoveEvidence(int size, int ops, BenchSampleType *sample) {
+    EvidenceListType list;
+    fillEvidence(&list, size, SOUND);
+
+    startSample(sample);
+    for (int i = 0; i < ops; i++) {
+        removeEvidence(&list, SOUND);
+        appendEvidence(&list, SOUND);
+    }
+    stopSample(sample);
+
+    cleanEvidenceList(&list);
+}
+
+
+/*
+    Function: benchLeaveEvidence
+    Purpose: Times the ghost leaving evidence in a full room, which forgets its oldest piece each time.
+    Params:
+        Input:
+            int size (in) - the cap of the room's evidence
+            int ops (in) - the number of pieces to time
+            BenchSampleType *sample (out) - the time taken
+        Output: void
+*/
+static void benchLeaveEvidence(int size, int ops, BenchSampleType *sample) {
+    RoomType *room = createRoom("Bench");
+    ConfigType config;
+    fillRoomEvidence(room, &config, size, EMF);
+
+    startSample(sample);
+    for (int i = 0; i < ops; i++) {
+        leaveEvidence(&(room->evidence), SOUND, &config);
+    }
+    stopSample(sample);
+
+    cleanRoom(room);
+}
+
+
+/*
+    Function: benchCollectEvidence
+    Purpose: Times a hunter collecting the piece of evidence it can detect when it is the oldest of a full room, then
+        putting it back.
+    Params:
+        Input:
+            int size (in) - the pieces of evidence in the room, its cap
+            int ops (in) - the number of collections to time
+            BenchSampleType *sample (out) - the time taken
+        Output: void
+*/
+static void benchCollectEvidence(int size, int ops, BenchSampleType *sample) {
+    HouseType house;
+    initHouse(&house);
+    initRegistry(&house.registry, 1);
+    RoomType *room = createRoom("Bench");
+    ConfigType config;
+    fillRoomEvidence(room, &config, size, SOUND);
+    HunterType *hunter = createHunter(&house.registry, "Bench", room);
+    hunter->equipmentType = SOUND;
+
+    startSample(sample);
+    for (int i = 0; i < ops; i++) {
+        collectEvidence(&house, hunter, room);
+        restoreOldest(&(room->evidence), SOUND);
+        // Keep the shared evidence from filling up
+        house.sharedEvidenceCount = 0;
+    }
+    stopSample(sample);
+
+    cleanRoom(room);
+    cleanRegistry(&house.registry);
+    sem_destroy(&(house.evidenceSem));
+}
+
+
+/*
+    Function: fillSharedEvidence
+    Purpose: Fills a house's shared evidence with the three types of a Poltergeist, in turn.
+    Params:
+        Input:
+            HouseType *house (out) - the house to fill, initialized
+            int size (in) - the pieces of shared evidence, at most MAX_ARR
+        Output: void
+*/
+static void fillSharedEvidence(HouseType *house, int size) {
+    const EvidenceType types[] = {EMF, TEMPERATURE, FINGERPRINTS};
+    for (int i = 0; i < size; i++) {
+        house->sharedEvidence[i] = types[i % 3];
+    }
+    house->sharedEvidenceCount = size;
+}
+
+
+/*
+    Function: benchReviewEvidence
+    Purpose: Times reviewing the shared evidence of a house for unique types.
+    Params:
+        Input:
+            int size (in) - the pieces of shared evidence
+            int ops (in) - the number of reviews to time
+            BenchSampleType *sample (out) - the time taken
+        Output: void
+*/
+static void benchReviewEvidence(int size, int ops, BenchSampleType *sample) {
+    HouseType house;
+    initHouse(&house);
+    fillSharedEvidence(&house, size);
+
+    startSample(sample);
+    for (int i = 0; i < ops; i++) {
+        benchSink += reviewEvidence(&house);
+    }
+    stopSample(sample);
+
+    sem_destroy(&(house.evidenceSem));
+}
+
+
+/*
+    Function: benchGhostMatch
+    Purpose: Times matching the shared evidence of a house to a ghost class.
+    Params:
+        Input:
+            int size (in) - the pieces of shared evidence
+            int ops (in) - the number of matches to time
+            BenchSampleType *sample (out) - the time taken
+        Output: void
+*/
+static void benchGhostMatch(int size, int ops, BenchSampleType *sample) {
+    HouseType house;
+    initHouse(&house);
+    fillSharedEvidence(&house, size);
+
+    startSample(sample);
+    for (int i = 0; i < ops; i++) {
+        benchSink += getGhostMatch(&house);
+    }
+    stopSample(sample);
+
+    sem_destroy(&(house.evidenceSem));
+}
+
+
+/*
+    Function: benchMoveHunter
+    Purpose: Times a hunter moving to a random connected room, in a map where every room is connected to every other.
+    Params:
+        Input:
+            int size (in) - the number of rooms connected to each room
+            int ops (in) - the number of moves to time
+            BenchSampleType *sample (out) - the time taken
+        Output: void
+*/
+static void benchMoveHunter(int size, int ops, BenchSampleType *sample) {
+    int numRooms = size + 1;
+    RoomType *rooms[numRooms];
+    for (int i = 0; i < numRooms; i++) {
+        char name[MAX_STR];
+        sprintf(name, "Room %d", i);
+        rooms[i] = createRoom(name);
+        for (int j = 0; j < i; j++) {
+            connectRooms(rooms[i], rooms[j]);
+        }
+    }
+    HunterRegistryType registry;
+    initRegistry(&registry, 1);
+    HunterType *hunter = createHunter(&registry, "Bench", rooms[0]);
+    insertAtHeadHunter(&(rooms[0]->hunters), hunter);
+
+    startSample(sample);
+    for (int i = 0; i < ops; i++) {
+        moveHunterToRandomRoom(hunter, hunter->currentRoom);
+    }
+    stopSample(sample);
+
+    for (int i = 0; i < numRooms; i++) {
+        cleanRoom(rooms[i]);
+    }
+    cleanRegistry(&registry);
+}
+
+
+/*
+    Function: benchRandInt
+    Purpose: Times drawing a random integer from the calling thread's stream.
+    Params:
+        Input:
+            int size (in) - the width of the range drawn from
+            int ops (in) - the number of draws to time
+            BenchSampleType *sample (out) - the time taken
+        Output: void
+*/
+static void benchRandInt(int size, int ops, BenchSampleType *sample) {
+    startSample(sample);
+    for (int i = 0; i < ops; i++) {
+        benchSink += randInt(0, size);
+    }
+    stopSample(sample);
+}
+
+
+// Every microbenchmark, in the order they run
+static const BenchCaseType benchCases[] = {
+    {"insertAtHeadHunter",     "list",     {1, 16, 256, 4096}, benchInsertHunter},
+    {"removeHunterFromRoom",   "list",     {1, 16, 256, 4096}, benchRemoveHunter},
+    {"insertAtHeadEvidence",   "list",     {1, 16, 256, 4096}, benchInsertEvidence},
+    {"removeEvidence",         "list",     {1, 16, 256, 4096}, benchRemoveEvidence},
+    {"leaveEvidence",          "cap",      {1, 16, 256, 4096}, benchLeaveEvidence},
+    {"collectEvidence",        "cap",      {1, 16, 256, 4096}, benchCollectEvidence},
+    {"reviewEvidence",         "evidence", {3, 16, MAX_ARR, 0}, benchReviewEvidence},
+    {"getGhostMatch",          "evidence", {3, 16, MAX_ARR, 0}, benchGhostMatch},
+    {"moveHunterToRandomRoom", "degree",   {2, 8, 32, 128},     benchMoveHunter},
+    {"randInt",                "range",    {2, 100, 1 << 20, 0}, benchRandInt},
+};
+
+
+// Every regression scenario, in the order they run
+static const BenchScenarioType benchScenarios[] = {
+    {"house", ENGINE_LOCKSTEP, 0,  0,  POLICY_RANDOM,   C_FALSE},
+    {"grid",  ENGINE_LOCKSTEP, 16, 16, POLICY_DIRECTED, C_FALSE},
+    {"radio", ENGINE_ACTOR,    0,  0,  POLICY_RANDOM,   C_TRUE},
+};
+
+
+/*
+    Function: compareLongLong
+    Purpose: Orders two long longs for qsort.
+    Params:
+        Input:
+            const void *a (in) - the first value
+            const void *b (in) - the second value
+        Output: int - negative, zero or positive as a is below, equal to or above b
+*/
+static int compareLongLong(const void *a, const void *b) {
+    long long x = *(const long long *)a;
+    long long y = *(const long long *)b;
+    return (x > y) - (x < y);
+}
+
+
+/*
+    Function: runCase
+    Purpose: Runs one microbenchmark at one size: untimed warmup repetitions, then timed ones, and prints the median and
+        fastest time per operation.
+    Params:
+        Input:
+            const BenchCaseType *benchCase (in) - the microbenchmark
+            int size (in) - the size of its input
+            int warmup (in) - repetitions to run before timing
+            int reps (in) - repetitions to time
+            int ops (in) - operations per repetition
+        Output: void
+*/
+static void runCase(const BenchCaseType *benchCase, int size, int warmup, int reps, int ops) {
+    BenchSampleType sample;
+    for (int i = 0; i < warmup; i++) {
+        benchCase->run(size, ops, &sample);
+    }
+
+    // Medians are taken over each measure on its own
+    long long nanos[reps];
+    long long cycles[reps];
+    for (int i = 0; i < reps; i++) {
+        benchCase->run(size, ops, &sample);
+        nanos[i] = sample.nanos;
+        cycles[i] = sample.cycles;
+    }
+    qsort(nanos, reps, sizeof(long long), compareLongLong);
+    qsort(cycles, reps, sizeof(long long), compareLongLong);
+
+    char label[MAX_STR];
+    snprintf(label, sizeof(label), "%s=%d", benchCase->sizeName, size);
+    printf("%-24s %-16s %12.2f %12.2f %12.1f\n", benchCase->name, label, (double)nanos[reps / 2] / ops,
+           (double)nanos[0] / ops, (double)cycles[reps / 2] / ops);
+}
+
+
+/*
+    Function: runScenarios
+    Purpose: Runs the regression scenarios, recording their samples as the baseline of a commit, or comparing them to a
+        baseline.
+    Params:
+        Input:
+            const char *path (in) - the baselines file
+            const char *record (in) - the commit to record the samples under, NULL to compare instead
+            const char *against (in) - the commit to compare to, "last" for the last one recorded
+            double threshold (in) - the percentage a measure may worsen by
+            int reps (in) - repetitions to time per scenario
+            const char *filter (in) - only run scenarios whose name contains it, NULL for all
+        Output: int - C_TRUE if the samples were recorded or nothing regressed, C_FALSE otherwise
+*/
+static int runScenarios(const char *path, const char *record, const char *against, double threshold, int reps,
+                        const char *filter) {
+    int passed = C_TRUE;
+    if (record == NULL) {
+        printf("%-10s %-16s %12s %12s %8s %20s  %s\n", "scenario", "measure", "baseline", "new", "change", "95% interval", "verdict");
+    }
+    for (size_t i = 0; i < sizeof(benchScenarios) / sizeof(benchScenarios[0]); i++) {
+        const BenchScenarioType *scenario = &benchScenarios[i];
+        if (filter != NULL && strstr(scenario->name, filter) == NULL) {
+            continue;
+        }
+        ScenarioRunType run;
+        runScenario(scenario, reps, &run);
+        if (record != NULL) {
+            passed = recordBaseline(path, record, scenario->name, &run) && passed;
+            printf("Recorded %d repetitions of %s under %s in %s\n", reps, scenario->name, record, path);
+        } else {
+            passed = compareBaseline(path, strcmp(against, "last") == 0 ? NULL : against, scenario->name, &run, threshold) && passed;
+        }
+    }
+    if (record == NULL) {
+        printf("%s\n", passed ? "No regression beyond the threshold" : "Regression beyond the threshold, see REGRESSED above");
+    }
+    return passed;
+}
+
+
+/*
+    Function: main
+    Purpose: Entry point of fp-bench. Times the core list, room and evidence primitives in isolation, over several input sizes.
+        With --record or --compare, times whole fixed-seed hunts instead, to track regressions between commits.
+    Params:
+        Input:
+            int argc (in) - the number of command line arguments
+            char *argv[] (in) - the command line arguments, [--reps N] [--warmup N] [--ops N] [--filter NAME]
+                [--record COMMIT | --compare COMMIT|last] [--baselines FILE] [--threshold PERCENT]
+    Returns: int - status code of the program execution
+*/
+int main(int argc, char *argv[]) {
+    int reps = 0;
+    int warmup = 3;
+    int ops = 10000;
+    const char *filter = NULL;
+    const char *record = NULL;
+    const char *against = NULL;
+    const char *baselines = "bench-baselines.txt";
+    double threshold = REGRESSION_THRESHOLD;
+
+    // Parse the arguments, every option takes a value
+    for (int i = 1; i < argc; i++) {
+        if (i + 1 >= argc) {
+            reps = -1;
+            break;
+        }
+        char *option = argv[i];
+        char *value = argv[++i];
+        if (strcmp(option, "--reps") == 0) {
+            reps = atoi(value);
+        } else if (strcmp(option, "--warmup") == 0) {
+            warmup = atoi(value);
+        } else if (strcmp(option, "--ops") == 0) {
+            ops = atoi(value);
+        } else if (strcmp(option, "--filter") == 0) {
+            filter = value;
+        } else if (strcmp(option, "--record") == 0) {
+            record = value;
+        } else if (strcmp(option, "--compare") == 0) {
+            against = value;
+        } else if (strcmp(option, "--baselines") == 0) {
+            baselines = value;
+        } else if (strcmp(option, "--threshold") == 0) {
+            threshold = atof(value);
+        } else {
+            reps = -1;
+            break;
+        }
+    }
+    // Each mode has its own default repetitions
+    int scenarios = record != NULL || against != NULL;
+    reps = reps == 0 ? (scenarios ? SCENARIO_REPS : 15) : reps;
+    if (reps < 1 || warmup < 0 || ops < 1 || threshold < 0.0 || (record != NULL && against != NULL) ||
+        (scenarios && reps > BASELINE_MAX_REPS)) {
+        fprintf(stderr, "Usage: %s [--reps N] [--warmup N] [--ops N] [--filter NAME]\n"
+                        "          [--record COMMIT | --compare COMMIT|last] [--baselines FILE] [--threshold PERCENT]\n", argv[0]);
+        return EXIT_FAILURE;
+    }
+
+    // Nothing is logged, and every run draws the same random numbers
+    logMask = 0;
+    seedRandom(1);
+    if (scenarios) {
+        return runScenarios(baselines, record, against, threshold, reps, filter) ? EXIT_SUCCESS : EXIT_FAILURE;
+    }
+
+    printf("%-24s %-16s %12s %12s %12s\n", "benchmark", "size", "median ns/op", "min ns/op", "cycles/op");
+    for (size_t i = 0; i < sizeof(benchCases) / sizeof(benchCases[0]); i++) {
+        const BenchCaseType *benchCase = &benchCases[i];
+        if (filter != NULL && strstr(benchCase->name, filter) == NULL) {
+            continue;
+        }
+        for (int j = 0; j < 4 && benchCase->sizes[j] > 0; j++) {
+            runCase(benchCase, benchCase->sizes[j], warmup, reps, ops);
+        }
+    }
+    return EXIT_SUCCESS;
+}
@@ -0,0 +1,258 @@
+#include "defs.h"
+#include <fcntl.h>     // for open
+#include <sys/file.h>  // for flock
+#include <sys/mman.h>  // for mmap and munmap
+#include <sys/stat.h>  // for fstat
+
+
+/*
+    Function: checksumRecord
+    Purpose: Checksums the key and result of a cache record, so a torn or foreign append is never served.
+    Params:
+        Input: const CacheRecordType *record (in) - the record to checksum
+        Output: uint32_t - the checksum
+*/
+static uint32_t checksumRecord(const CacheRecordType *record) {
+    uint64_t hash = hashBytes(FNV_OFFSET, &record->key, sizeof(record->key));
+    hash = hashBytes(hash, &record->result, sizeof(record->result));
+    // A zeroed record must not pass, so never return 0
+    return (uint32_t)(hash ^ (hash >> 32)) | 1;
+}
+
+
+/*
+    Function: indexRecord
+    Purpose: Adds a record number to the in-memory index under its key, growing the index when it gets half full.
+    Params:
+        Input:
+            CacheType *cache (in/out) - the cache to index into
+            long long number (in) - the number of the record in the file
+        Output: void
+*/
+static void indexRecord(CacheType *cache, long long number) {
+    // Keep the table at most half full, moving every indexed record over when it grows
+    if ((cache->indexed + 1) * 2 > cache->capacity) {
+        uint32_t *old = cache->index;
+        long long oldCapacity = cache->capacity;
+        cache->capacity = oldCapacity == 0 ? 1024 : oldCapacity * 2;
+        cache->index = calloc(cache->capacity, sizeof(uint32_t));
+        for (long long i = 0; i < oldCapacity; i++) {
+            if (old[i] == 0) {
+                continue;
+            }
+            long long slot = cache->records[old[i] - 1].key & (cache->capacity - 1);
+            while (cache->index[slot] != 0) {
+                slot = (slot + 1) & (cache->capacity - 1);
+            }
+            cache->index[slot] = old[i];
+        }
+        free(old);
+    }
+
+    // Linear probing, slots hold the record number plus one so 0 means empty
+    long long slot = cache->records[number].key & (cache->capacity - 1);
+    while (cache->index[slot] != 0) {
+        slot = (slot + 1) & (cache->capacity - 1);
+    }
+    cache->index[slot] = (uint32_t)(number + 1);
+    cache->indexed++;
+}
+
+
+/*
+    Function: refreshCache
+    Purpose: Maps any records appended since the last refresh, by this or any other process, and indexes them.
+    Params:
+        Input: CacheType *cache (in/out) - the cache to refresh
+        Output: void
+*/
+static void refreshCache(CacheType *cache) {
+    // Nothing to do unless the file grew by at least one whole record
+    struct stat info;
+    if (fstat(cache->fd, &info) != 0) {
+        return;
+    }
+    long long total = (info.st_size - (long long)sizeof(CacheHeaderType)) / (long long)sizeof(CacheRecordType);
+    if (total <= cache->scanned) {
+        return;
+    }
+
+    // Map the whole file again, ignoring a trailing partial record still being written
+    size_t size = sizeof(CacheHeaderType) + total * sizeof(CacheRecordType);
+    void *map = mmap(NULL, size, PROT_READ, MAP_SHARED, cache->fd, 0);
+    if (map == MAP_FAILED) {
+        return;
+    }
+    if (cache->map != NULL) {
+        munmap(cache->map, cache->mapped);
+    }
+    cache->map = map;
+    cache->mapped = size;
+    cache->records = (const CacheRecordType *)((const char *)map + sizeof(CacheHeaderType));
+
+    // Index the new records, leaving out any whose checksum does not match
+    for (long long i = cache->scanned; i < total; i++) {
+        if (cache->records[i].check == checksumRecord(&cache->records[i])) {
+            indexRecord(cache, i);
+        }
+    }
+    cache->scanned = total;
+}
+
+
+/*
+    Function: openCache
+    Purpose: Opens (or creates) an on-disk result cache, mapping and indexing the records already in it.
+    Params:
+        Input: const char *path (in) - the path of the cache file
+        Output: CacheType* - the opened cache, or NULL if the file could not be used
+*/
+CacheType *openCache(const char *path) {
+    // Appending only, so concurrent writers never overwrite each other
+    int fd = open(path, O_RDWR | O_CREAT | O_APPEND, 0644);
+    if (fd < 0) {
+        perror(path);
+        return NULL;
+    }
+
+    // Write the header of a new file, or check the header of an existing one, under the file lock
+    CacheHeaderType header;
+    flock(fd, LOCK_EX);
+    struct stat info;
+    fstat(fd, &info);
+    int valid = C_TRUE;
+    if (info.st_size == 0) {
+        memset(&header, 0, sizeof(header));
+        header.magic = CACHE_MAGIC;
+        header.version = CACHE_VERSION;
+        header.recordSize = sizeof(CacheRecordType);
+        valid = write(fd, &header, sizeof(header)) == sizeof(header);
+    } else {
+        valid = pread(fd, &header, sizeof(header), 0) == sizeof(header) && header.magic == CACHE_MAGIC &&
+                header.version == CACHE_VERSION && header.recordSize == sizeof(CacheRecordType);
+    }
+    flock(fd, LOCK_UN);
+    if (!valid) {
+        fprintf(stderr, "%s: not a result cache of this version\n", path);
+        close(fd);
+        return NULL;
+    }
+
+    // Start with nothing mapped and index what is already there
+    CacheType *cache = calloc(1, sizeof(CacheType));
+    cache->fd = fd;
+    cache->mapHash = defaultMapHash();
+    refreshCache(cache);
+    return cache;
+}
+
+
+/*
+    Function: closeCache
+    Purpose: Unmaps and closes a result cache, and frees its index.
+    Params:
+        Input: CacheType *cache (in) - the cache to close, may be NULL
+        Output: void
+*/
+void closeCache(CacheType *cache) {
+    if (cache == NULL) {
+        return;
+    }
+    if (cache->map != NULL) {
+        munmap(cache->map, cache->mapped);
+    }
+    close(cache->fd);
+    free(cache->index);
+    free(cache);
+}
+
+
+/*
+    Function: cacheKey
+    Purpose: Hashes everything a hunt's outcome depends on: the simulator version, the map, the runtime parameters and the seed.
+        Parameters that never change an outcome are cleared first, so hunts that differ only in them share a key.
+    Params:
+        Input:
+            const ConfigType *config (in) - the runtime parameters of the hunt
+            uint64_t mapHash (in) - the hash of the map, from hashHouseMap
+            unsigned int seed (in) - the seed of the hunt
+        Output: uint64_t - the key of the hunt
+*/
+uint64_t cacheKey(const ConfigType *config, uint64_t mapHash, unsigned int seed) {
+    int version = SIM_VERSION;
+    uint64_t hash = hashBytes(FNV_OFFSET, &version, sizeof(version));
+    hash = hashBytes(hash, &mapHash, sizeof(mapHash));
+    // How many threads run a hunt, and whether it is sampled, are not part of it; room owners only matter to the actor engine
+    ConfigType outcome = *config;
+    outcome.stepThreads = 0;
+    outcome.taskThreads = 0;
+    outcome.samplePeriod = 0;
+    outcome.sampleStream = C_FALSE;
+    if (outcome.engine != ENGINE_ACTOR) {
+        outcome.roomOwners = 0;
+    }
+    hash = hashBytes(hash, &outcome, sizeof(ConfigType));
+    return hashBytes(hash, &seed, sizeof(seed));
+}
+
+
+/*
+    Function: lookupCache
+    Purpose: Looks up a cached hunt result, picking up records appended by other writers on a miss.
+    Params:
+        Input:
+            CacheType *cache (in/out) - the cache to look in
+            uint64_t key (in) - the key of the hunt, from cacheKey
+            HuntResultType *result (out) - the cached result, if found
+        Output: int - C_TRUE if the result was cached, C_FALSE otherwise
+*/
+int lookupCache(CacheType *cache, uint64_t key, HuntResultType *result) {
+    // Look once in what is indexed, and once more after catching up with other writers
+    for (int attempt = 0; attempt < 2; attempt++) {
+        if (cache->capacity > 0) {
+            long long slot = key & (cache->capacity - 1);
+            while (cache->index[slot] != 0) {
+                const CacheRecordType *record = &cache->records[cache->index[slot] - 1];
+                if (record->key == key) {
+                    *result = record->result;
+                    cache->hits++;
+                    return C_TRUE;
+                }
+                slot = (slot + 1) & (cache->capacity - 1);
+            }
+        }
+        if (attempt == 0) {
+            refreshCache(cache);
+        }
+    }
+    cache->misses++;
+    return C_FALSE;
+}
+
+
+/*
+    Function: storeCache
+    Purpose: Appends a finished hunt's result to the cache, as a single write so concurrent writers never interleave.
+    Params:
+        Input:
+            CacheType *cache (in) - the cache to append to
+            uint64_t key (in) - the key of the hunt, from cacheKey
+            const HuntResultType *result (in) - the result to store
+        Output: void
+*/
+void storeCache(CacheType *cache, uint64_t key, const HuntResultType *result) {
+    // Build the whole record first, zeroing padding so checksums are stable
+    CacheRecordType record;
+    memset(&record, 0, sizeof(record));
+    record.key = key;
+    record.result = *result;
+    record.result.cached = C_FALSE;
+    record.check = checksumRecord(&record);
+
+    // O_APPEND places the record atomically; the lock keeps it whole on file systems that do not
+    flock(cache->fd, LOCK_EX);
+    if (write(cache->fd, &record, sizeof(record)) != sizeof(record)) {
+        perror("cache");
+    }
+    flock(cache->fd, LOCK_UN);
+}
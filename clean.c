@@ -3,7 +3,7 @@
 
 /*
     Function: cleanHunterList
-    Purpose: Cleans the list of hunters in a room.
+    Purpose: Cleans the list of hunters in a room. The hunters themselves belong to the house's registry.
     Params:
         Input: HunterListType *list (in) - the list of hunters to clean
         Output: void
@@ -16,8 +16,6 @@ void cleanHunterList(HunterListType *list) {
     // Loop through the list
     while (current != NULL) {
         next = current->next;
-        // Clean the hunter
-        free(current->hunter);
         // Free the current node
         free(current);
         current = next;
@@ -34,7 +32,7 @@ void cleanHunterList(HunterListType *list) {
 */
 void cleanRoom(RoomType *room) {
     // Clean the evidence in the room
-    cleanEvidenceList(&(room->evidences));
+    cleanRoomEvidence(&(room->evidence));
     // Free the connected rooms list
     cleanRoomList(room->connectedRooms);
     // Clean the hunters in the room
@@ -94,6 +92,20 @@ void cleanEvidenceList(EvidenceListType *list) {
 }
 
 
+/*
+    Function: cleanRoomEvidence
+    Purpose: Cleans the evidence left in a room.
+    Params:
+        Input: RoomEvidenceType *evidence (in) - the evidence of the room to clean
+        Output: void
+*/
+void cleanRoomEvidence(RoomEvidenceType *evidence) {
+    // Only the ring of the oldest-first policy is allocated
+    free(evidence->ring);
+    evidence->ring = NULL;
+}
+
+
 /*
     Function: cleanHouse
     Purpose: Cleans the overall house
@@ -114,17 +126,21 @@ void cleanHouse(HouseType *house) {
         current = next;
     }
 
-    // Clean the hunters who exited due to fear
-    for (int i = 0; i < house->huntersExitedFear->size; i++) {
-        free(house->huntersExitedFear->hunters[i]);
-    }
-    // Clean the hunters who exited due to boredom
-    for (int i = 0; i < house->huntersExitedBoredom->size; i++) {
-        free(house->huntersExitedBoredom->hunters[i]);
-    }
+    // Free every hunter, wherever and however it left, and the lists of exits pointing at them
+    cleanRegistry(&house->registry);
+    free(house->huntersExitedFear.hunters);
+    free(house->huntersExitedBoredom.hunters);
 
     // free the ghost in the house
     free(ghost);
+    // Free the radios and every report sent over them
+    cleanRadios(house);
+    // Free the room index, the next-hop table is kept for the next house on the same map
+    free(house->roomTable);
+    // Free the room activity counters, if they were tracked
+    free(house->heat);
+    // Free the samples, written out by then
+    free(house->samples);
 
     // Destroy the semaphore
     sem_destroy(&(house->evidenceSem));
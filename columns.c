@@ -0,0 +1,195 @@
+#include "defs.h"
+#include <fcntl.h>     // for open
+#include <sys/file.h>  // for flock
+#include <sys/stat.h>  // for fstat
+#include <sys/uio.h>   // for writev
+
+
+/*
+    Function: chunkSize
+    Purpose: Computes the bytes a chunk of results takes in a results file: its header, then every column one after the
+        other, padded so the next chunk starts 8-byte aligned.
+    Params:
+        Input: uint32_t count (in) - the number of hunts in the chunk
+        Output: size_t - the size of the chunk
+*/
+static size_t chunkSize(uint32_t count) {
+    size_t size = sizeof(ChunkHeaderType) + (size_t)count * RESULTS_RECORD_BYTES;
+    return (size + 7) & ~(size_t)7;
+}
+
+
+/*
+    Function: openResults
+    Purpose: Opens (or creates) a columnar results file for appending, writing its header if the file is new.
+    Params:
+        Input: const char *path (in) - the path of the results file
+        Output: ResultsWriterType* - the writer, or NULL if the file could not be used
+*/
+ResultsWriterType *openResults(const char *path) {
+    // Appending only, so writers in other processes never overwrite each other
+    int fd = open(path, O_WRONLY | O_CREAT | O_APPEND, 0644);
+    if (fd < 0) {
+        perror(path);
+        return NULL;
+    }
+
+    // Write the header of a new file, or check the header of an existing one, under the file lock
+    ResultsHeaderType header;
+    flock(fd, LOCK_EX);
+    struct stat info;
+    fstat(fd, &info);
+    int valid = C_TRUE;
+    if (info.st_size == 0) {
+        memset(&header, 0, sizeof(header));
+        header.magic = RESULTS_MAGIC;
+        header.version = RESULTS_VERSION;
+        header.simVersion = SIM_VERSION;
+        valid = write(fd, &header, sizeof(header)) == sizeof(header);
+    } else {
+        // The descriptor is write-only, so check the header through a second one
+        int check = open(path, O_RDONLY);
+        valid = check >= 0 && pread(check, &header, sizeof(header), 0) == sizeof(header) && header.magic == RESULTS_MAGIC &&
+                header.version == RESULTS_VERSION;
+        if (check >= 0) {
+            close(check);
+        }
+    }
+    flock(fd, LOCK_UN);
+    if (!valid) {
+        fprintf(stderr, "%s: not a results file of this version\n", path);
+        close(fd);
+        return NULL;
+    }
+
+    ResultsWriterType *writer = calloc(1, sizeof(ResultsWriterType));
+    writer->fd = fd;
+    return writer;
+}
+
+
+/*
+    Function: addResult
+    Purpose: Buffers one finished hunt in the writer's columns, appending them as a chunk once RESULTS_CHUNK hunts are buffered.
+    Params:
+        Input:
+            ResultsWriterType *writer (in/out) - the writer to buffer into, may be NULL
+            const HuntResultType *result (in) - the outcome of the hunt
+        Output: void
+*/
+void addResult(ResultsWriterType *writer, const HuntResultType *result) {
+    if (writer == NULL) {
+        return;
+    }
+    int i = writer->count++;
+    writer->seed[i] = result->seed;
+    writer->ticks[i] = result->ticks;
+    writer->exitedFear[i] = result->exitedFear;
+    writer->exitedBoredom[i] = result->exitedBoredom;
+    writer->evidence[i] = result->evidenceCollected;
+    writer->outcome[i] = result->outcome;
+    writer->ghostClass[i] = result->ghostClass;
+    writer->identifiedClass[i] = result->identifiedClass;
+    if (writer->count == RESULTS_CHUNK) {
+        flushResults(writer);
+    }
+}
+
+
+/*
+    Function: flushResults
+    Purpose: Appends the buffered hunts as one chunk, in a single write of the header and every column. O_APPEND places the
+        whole write at the end of the file, so writers in several processes need no lock between them.
+    Params:
+        Input: ResultsWriterType *writer (in/out) - the writer to flush, may be NULL
+        Output: int - C_TRUE if the chunk was written or there was nothing to write, C_FALSE otherwise
+*/
+int flushResults(ResultsWriterType *writer) {
+    if (writer == NULL || writer->count == 0) {
+        return C_TRUE;
+    }
+    uint32_t count = writer->count;
+    ChunkHeaderType header;
+    header.magic = CHUNK_MAGIC;
+    header.count = count;
+    header.size = chunkSize(count);
+    header.writer = (uint32_t)getpid();
+
+    // The columns in file order, see readChunk, then the padding
+    static const char padding[8] = {0};
+    struct iovec parts[] = {
+        {&header, sizeof(header)},
+        {writer->seed, count * sizeof(uint32_t)},
+        {writer->ticks, count * sizeof(uint32_t)},
+        {writer->exitedFear, count * sizeof(uint16_t)},
+        {writer->exitedBoredom, count * sizeof(uint16_t)},
+        {writer->evidence, count * sizeof(uint16_t)},
+        {writer->outcome, count},
+        {writer->ghostClass, count},
+        {writer->identifiedClass, count},
+        {(void *)padding, header.size - sizeof(header) - count * RESULTS_RECORD_BYTES},
+    };
+    writer->count = 0;
+    if (writev(writer->fd, parts, sizeof(parts) / sizeof(parts[0])) != (ssize_t)header.size) {
+        perror("results");
+        return C_FALSE;
+    }
+    return C_TRUE;
+}
+
+
+/*
+    Function: closeResults
+    Purpose: Appends whatever hunts are still buffered, then closes the results file.
+    Params:
+        Input: ResultsWriterType *writer (in) - the writer to close, may be NULL
+        Output: void
+*/
+void closeResults(ResultsWriterType *writer) {
+    if (writer == NULL) {
+        return;
+    }
+    flushResults(writer);
+    close(writer->fd);
+    free(writer);
+}
+
+
+/*
+    Function: readChunk
+    Purpose: Points a set of columns at the chunk found at an offset of a mapped results file, and moves the offset past it.
+        A chunk cut short, such as one still being written, ends the file.
+    Params:
+        Input:
+            const void *map (in) - the mapped results file
+            size_t size (in) - the bytes mapped
+            size_t *offset (in/out) - where the chunk starts, moved to where the next one starts
+            ResultsColumnsType *columns (out) - the columns of the chunk, pointing into the mapping
+        Output: int - C_TRUE if a whole chunk was found, C_FALSE at the end of the file
+*/
+int readChunk(const void *map, size_t size, size_t *offset, ResultsColumnsType *columns) {
+    if (*offset + sizeof(ChunkHeaderType) > size) {
+        return C_FALSE;
+    }
+    const char *chunk = (const char *)map + *offset;
+    const ChunkHeaderType *header = (const ChunkHeaderType *)chunk;
+    if (header->magic != CHUNK_MAGIC || header->size != chunkSize(header->count) || *offset + header->size > size) {
+        return C_FALSE;
+    }
+
+    // Each column follows the one before it, every one of them aligned for its type
+    size_t count = header->count;
+    const char *column = chunk + sizeof(ChunkHeaderType);
+    columns->count = count;
+    columns->writer = header->writer;
+    columns->seed = (const uint32_t *)column;
+    columns->ticks = (const uint32_t *)(column += count * sizeof(uint32_t));
+    columns->exitedFear = (const uint16_t *)(column += count * sizeof(uint32_t));
+    columns->exitedBoredom = (const uint16_t *)(column += count * sizeof(uint16_t));
+    columns->evidence = (const uint16_t *)(column += count * sizeof(uint16_t));
+    columns->outcome = (const uint8_t *)(column += count * sizeof(uint16_t));
+    columns->ghostClass = (const uint8_t *)(column += count);
+    columns->identifiedClass = (const uint8_t *)(column + count);
+    *offset += header->size;
+    return C_TRUE;
+}
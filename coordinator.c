@@ -0,0 +1,467 @@
+#include "defs.h"
+#include <errno.h>      // for errno
+#include <fcntl.h>      // for open
+#include <poll.h>       // for poll
+#include <sys/mman.h>   // for mmap
+#include <sys/socket.h> // for socketpair
+#include <sys/wait.h>   // for waitpid
+
+
+/*
+    Function: writeAll
+    Purpose: Writes a whole buffer to a descriptor, retrying short writes.
+    Params:
+        Input:
+            int fd (in) - the descriptor to write to
+            const void *data (in) - the bytes to write
+            size_t size (in) - the number of bytes to write
+        Output: int - C_TRUE if every byte was written, C_FALSE if the other end is gone
+*/
+static int writeAll(int fd, const void *data, size_t size) {
+    const char *bytes = data;
+    while (size > 0) {
+        ssize_t written = write(fd, bytes, size);
+        if (written < 0 && errno == EINTR) {
+            continue;
+        }
+        if (written <= 0) {
+            return C_FALSE;
+        }
+        bytes += written;
+        size -= written;
+    }
+    return C_TRUE;
+}
+
+
+/*
+    Function: readAll
+    Purpose: Reads exactly a whole buffer from a descriptor, retrying short reads.
+    Params:
+        Input:
+            int fd (in) - the descriptor to read from
+            void *data (out) - the bytes read
+            size_t size (in) - the number of bytes to read
+        Output: int - C_TRUE if every byte was read, C_FALSE on end of file or error
+*/
+static int readAll(int fd, void *data, size_t size) {
+    char *bytes = data;
+    while (size > 0) {
+        ssize_t got = read(fd, bytes, size);
+        if (got < 0 && errno == EINTR) {
+            continue;
+        }
+        if (got <= 0) {
+            return C_FALSE;
+        }
+        bytes += got;
+        size -= got;
+    }
+    return C_TRUE;
+}
+
+
+/*
+    Function: runShardTasks
+    Purpose: Runs in a sweep worker process with the tasks engine: starts the houses of every seed of a shard on the task pool
+        at once, then sends back their results in seed order as they finish, so a crash still leaves a prefix of the shard done.
+    Params:
+        Input:
+            int fd (in) - the worker end of the socket to the coordinator
+            const ShardType *shard (in) - the seeds to simulate and their parameters
+            MetricsType *metrics (in) - the metrics to publish into, may be NULL
+            CacheType *cache (in) - the worker's own handle on the result cache, may be NULL
+            ResultsWriterType *results (in/out) - the worker's own writer of the results file, may be NULL
+            DistributionsType *distributions (in/out) - the worker's slot of distributions
+            HeatmapType *heatmap (in/out) - the worker's slot of room activity, may be NULL
+        Output: int - C_TRUE once every result was sent, C_FALSE if the coordinator went away
+*/
+static int runShardTasks(int fd, const ShardType *shard, MetricsType *metrics, CacheType *cache, ResultsWriterType *results,
+                         DistributionsType *distributions, HeatmapType *heatmap) {
+    int count = shard->count;
+    HouseType *houses = malloc(sizeof(HouseType) * count);
+    HuntTasksType *hunts = malloc(sizeof(HuntTasksType) * count);
+    HuntResultType *outcomes = malloc(sizeof(HuntResultType) * count);
+    uint64_t *keys = malloc(sizeof(uint64_t) * count);
+    char *simulated = malloc(count);
+
+    // Start every hunt not already cached
+    for (int i = 0; i < count; i++) {
+        simulated[i] = prepareHunt(&shard->config, shard->firstSeed + i, metrics, cache, heatmap, &houses[i], &keys[i], &outcomes[i]);
+        if (simulated[i]) {
+            startHuntTasks(&houses[i], &hunts[i]);
+        }
+    }
+
+    // Wait for each in seed order, every hunt still running meanwhile
+    int sent = C_TRUE;
+    for (int i = 0; i < count; i++) {
+        if (simulated[i]) {
+            waitHuntTasks(&hunts[i]);
+            concludeHunt(&houses[i], metrics, cache, keys[i], distributions, heatmap, &outcomes[i]);
+        }
+        // Seeds counted by an earlier attempt are already in the results file
+        if (i >= shard->merged) {
+            addResult(results, &outcomes[i]);
+        }
+        // Once the coordinator is gone, only finish the hunts so their houses are freed
+        if (sent) {
+            sent = writeAll(fd, &outcomes[i], sizeof(HuntResultType));
+        }
+    }
+
+    free(houses);
+    free(hunts);
+    free(outcomes);
+    free(keys);
+    free(simulated);
+    return sent;
+}
+
+
+/*
+    Function: workerLoop
+    Purpose: Runs in a sweep worker process: simulates each shard received from the coordinator and sends back one result per seed.
+    Params:
+        Input:
+            int fd (in) - the worker end of the socket to the coordinator
+            MetricsType *metrics (in) - the metrics to publish into, may be NULL
+            CacheType *cache (in) - the worker's own handle on the result cache, may be NULL
+            ResultsWriterType *results (in/out) - the worker's own writer of the results file, may be NULL
+            DistributionsType *distributions (in/out) - the worker's slot of distributions, shared with the coordinator
+            HeatmapType *heatmap (in/out) - the worker's slot of room activity, shared the same way, may be NULL
+        Output: void
+*/
+void workerLoop(int fd, MetricsType *metrics, CacheType *cache, ResultsWriterType *results, DistributionsType *distributions,
+                HeatmapType *heatmap) {
+    ShardType shard;
+    // Simulate shards until the coordinator closes the socket
+    while (readAll(fd, &shard, sizeof(ShardType)) == C_TRUE) {
+        // The tasks engine runs every hunt of the shard at once
+        if (shard.config.engine == ENGINE_TASKS) {
+            if (runShardTasks(fd, &shard, metrics, cache, results, distributions, heatmap) == C_FALSE) {
+                return;
+            }
+            continue;
+        }
+        for (int i = 0; i < shard.count; i++) {
+            // Simulate the seed and stream its result straight back
+            HuntResultType result;
+            runHunt(&shard.config, shard.firstSeed + i, metrics, cache, distributions, heatmap, &result);
+            // Chunks are appended as the buffer fills, and once more when the worker exits; seeds counted by an earlier
+            // attempt are already in them
+            if (i >= shard.merged) {
+                addResult(results, &result);
+            }
+            if (writeAll(fd, &result, sizeof(HuntResultType)) == C_FALSE) {
+                return;
+            }
+        }
+    }
+}
+
+
+/*
+    Function: spawnWorker
+    Purpose: Forks a sweep worker process connected to the coordinator by a Unix socket pair.
+    Params:
+        Input:
+            WorkerType *worker (out) - the worker to start
+            WorkerType workers[] (in) - every worker, whose coordinator ends the child must close
+            int numWorkers (in) - the number of workers
+            MetricsType *metrics (in) - the metrics the worker publishes into, may be NULL
+            const char *cachePath (in) - the result cache the worker opens for itself, NULL if disabled
+            const char *resultsPath (in) - the results file the worker appends its chunks to, NULL if disabled
+            const TopologyType *topology (in) - the CPUs and nodes the worker's planned placement refers to
+        Output: int - C_TRUE if the worker started, C_FALSE otherwise
+*/
+int spawnWorker(WorkerType *worker, WorkerType workers[], int numWorkers, MetricsType *metrics, const char *cachePath,
+                const char *resultsPath, const TopologyType *topology) {
+    // Create the socket pair, one end for each process
+    int fds[2];
+    if (socketpair(AF_UNIX, SOCK_STREAM, 0, fds) != 0) {
+        perror("socketpair");
+        return C_FALSE;
+    }
+
+    pid_t pid = fork();
+    if (pid < 0) {
+        perror("fork");
+        close(fds[0]);
+        close(fds[1]);
+        return C_FALSE;
+    }
+
+    if (pid == 0) {
+        // In the worker, drop every coordinator end so sockets close when the coordinator exits
+        close(fds[0]);
+        for (int i = 0; i < numWorkers; i++) {
+            if (workers[i].fd >= 0) {
+                close(workers[i].fd);
+            }
+        }
+        // The coordinator owns the terminal, so the worker's hunt logs are discarded, and not even formatted
+        logMask = 0;
+        int devNull = open("/dev/null", O_WRONLY);
+        if (devNull >= 0) {
+            dup2(devNull, STDOUT_FILENO);
+            close(devNull);
+        }
+        // Move to the worker's CPUs and node before anything of a house is allocated
+        applyPlacement(topology, worker);
+        // Time the worker's agents into its own slot of the profile, at the sweep's sampling period
+        if (worker->profile != NULL) {
+            startProfile(worker->profile, profile->period);
+        }
+        // Ctrl-C is handled by the coordinator, which lets in-flight shards finish
+        signal(SIGINT, SIG_IGN);
+        // Each worker opens the cache itself, as file locks are shared by inherited descriptors
+        CacheType *cache = cachePath != NULL ? openCache(cachePath) : NULL;
+        // and buffers its own chunks of the results file, appended without any lock between workers
+        ResultsWriterType *results = resultsPath != NULL ? openResults(resultsPath) : NULL;
+        workerLoop(fds[1], metrics, cache, results, worker->distributions, worker->heatmap);
+        stopTasks();
+        closeResults(results);
+        closeCache(cache);
+        _exit(EXIT_SUCCESS);
+    }
+
+    // In the coordinator, keep only its own end
+    close(fds[1]);
+    worker->pid = pid;
+    worker->fd = fds[0];
+    worker->busy = C_FALSE;
+    worker->received = 0;
+    worker->buffered = 0;
+    return C_TRUE;
+}
+
+
+/*
+    Function: takeSlot
+    Purpose: Empties the shared slot of a worker that is not simulating, first merging the hunts it holds if asked to.
+    Params:
+        Input:
+            WorkerType *worker (in/out) - the worker, idle or reaped
+            DistributionsType *distributions (in/out) - the distributions to merge the slot's into, NULL to drop them
+            HeatmapType *heatmap (in/out) - the room activity to merge the slot's into, NULL to drop it or unless asked for
+        Output: void
+*/
+static void takeSlot(WorkerType *worker, DistributionsType *distributions, HeatmapType *heatmap) {
+    if (worker->distributions != NULL) {
+        if (distributions != NULL) {
+            mergeDistributions(distributions, worker->distributions);
+        }
+        memset(worker->distributions, 0, sizeof(DistributionsType));
+    }
+    if (worker->heatmap != NULL) {
+        if (heatmap != NULL) {
+            mergeHeatmap(heatmap, worker->heatmap);
+        }
+        memset(worker->heatmap, 0, sizeof(HeatmapType));
+    }
+}
+
+
+/*
+    Function: runCoordinator
+    Purpose: Shards the seeds of a sweep over worker processes, merges their results, and retries the shards of crashed workers.
+        Stops handing out shards once the requested estimates have converged; in-flight shards are still merged.
+    Params:
+        Input:
+            const OptionsType *options (in) - the sweep: seeds, runs, workers, shard size and config
+            MetricsType *metrics (in) - the metrics the workers publish into, may be NULL
+            volatile sig_atomic_t *stop (in) - set to stop handing out shards, in-flight shards still finish
+            SweepSummaryType *summary (out) - the merged outcomes
+            DistributionsType *distributions (in/out) - the distributions every worker's are merged into
+            HeatmapType *heatmap (in/out) - the room activity every worker's is merged into, NULL unless asked for
+        Output: int - C_TRUE if the sweep ran, C_FALSE if no worker could be started
+*/
+int runCoordinator(const OptionsType *options, MetricsType *metrics, volatile sig_atomic_t *stop, SweepSummaryType *summary,
+                   DistributionsType *distributions, HeatmapType *heatmap) {
+    int numWorkers = options->workers;
+    initSweepSummary(summary);
+    // A worker dying must show up as a failed write, not kill the coordinator
+    signal(SIGPIPE, SIG_IGN);
+
+    // Cut the seeds into shards; retries are queued after them, each shard is retried at most SHARD_ATTEMPTS - 1 times
+    int numShards = (options->runs + options->shardSize - 1) / options->shardSize;
+    int capacity = numShards * SHARD_ATTEMPTS;
+    ShardType *queue = malloc(sizeof(ShardType) * capacity);
+    int queueHead = 0;
+    int queueTail = 0;
+    for (int i = 0; i < numShards; i++) {
+        ShardType *shard = &queue[queueTail++];
+        shard->firstSeed = options->seed + i * options->shardSize;
+        shard->count = options->runs - i * options->shardSize < options->shardSize ? options->runs - i * options->shardSize : options->shardSize;
+        shard->attempts = 0;
+        shard->merged = 0;
+        shard->config = options->config;
+    }
+
+    // Start the workers, marking the not yet started ones so children do not close bogus descriptors
+    WorkerType *workers = malloc(sizeof(WorkerType) * numWorkers);
+    // Each worker slot counts the hunts of its current shard in its own distributions, shared with the coordinator and
+    // zeroed by the kernel. The coordinator merges a slot once the shard's last result is in, and clears it before the
+    // next shard; a crashed worker's slot is cleared unmerged, so a half-recorded hunt is never counted, and its
+    // replacement carries on in the same slot
+    size_t slotsSize = sizeof(DistributionsType) * numWorkers;
+    DistributionsType *slots = mmap(NULL, slotsSize, PROT_READ | PROT_WRITE, MAP_SHARED | MAP_ANONYMOUS, -1, 0);
+    size_t heatSize = heatmap != NULL ? sizeof(HeatmapType) * numWorkers : 0;
+    HeatmapType *heatSlots = heatmap != NULL ? mmap(NULL, heatSize, PROT_READ | PROT_WRITE, MAP_SHARED | MAP_ANONYMOUS, -1, 0) : MAP_FAILED;
+    size_t profileSize = profile != NULL ? sizeof(ProfileType) * numWorkers : 0;
+    ProfileType *profileSlots = profile != NULL ? mmap(NULL, profileSize, PROT_READ | PROT_WRITE, MAP_SHARED | MAP_ANONYMOUS, -1, 0) : MAP_FAILED;
+    for (int i = 0; i < numWorkers; i++) {
+        workers[i].fd = -1;
+        workers[i].distributions = slots != MAP_FAILED ? &slots[i] : NULL;
+        workers[i].heatmap = heatSlots != MAP_FAILED ? &heatSlots[i] : NULL;
+        workers[i].profile = profileSlots != MAP_FAILED ? &profileSlots[i] : NULL;
+    }
+    // Plan where each worker runs, reporting the machine when placement was asked for
+    TopologyType topology;
+    readTopology(&topology);
+    planPlacement(&topology, options->affinity, workers, numWorkers);
+    if (options->affinity != AFFINITY_NONE) {
+        printTopology(&topology, options->affinity, workers, numWorkers);
+        fflush(stdout);
+    }
+    for (int i = 0; i < numWorkers; i++) {
+        if (spawnWorker(&workers[i], workers, numWorkers, metrics, options->cachePath, options->resultsPath, &topology) == C_FALSE) {
+            workers[i].fd = -1;
+        }
+    }
+
+    struct pollfd *polls = malloc(sizeof(struct pollfd) * numWorkers);
+    int started = C_FALSE;
+    while (C_TRUE) {
+        // Hand a shard to every idle worker, unless asked to stop or the estimates are already good enough
+        int converged = sweepConverged(summary, options->ciWidth, options->ciMetrics);
+        for (int i = 0; i < numWorkers && queueHead < queueTail && !*stop && !converged; i++) {
+            if (workers[i].fd < 0 || workers[i].busy) {
+                continue;
+            }
+            ShardType *shard = &queue[queueHead];
+            shard->attempts++;
+            workers[i].shard = *shard;
+            workers[i].received = 0;
+            workers[i].buffered = 0;
+            workers[i].busy = C_TRUE;
+            queueHead++;
+            started = C_TRUE;
+            // A failed send is noticed by poll below as the worker hanging up
+            writeAll(workers[i].fd, shard, sizeof(ShardType));
+        }
+
+        // Wait on every busy worker, stopping once none is left
+        int numBusy = 0;
+        for (int i = 0; i < numWorkers; i++) {
+            polls[i].fd = workers[i].busy ? workers[i].fd : -1;
+            polls[i].events = POLLIN;
+            polls[i].revents = 0;
+            numBusy += workers[i].busy;
+        }
+        if (numBusy == 0) {
+            break;
+        }
+        if (poll(polls, numWorkers, -1) < 0) {
+            // An interrupt sets *stop, so just go round again
+            if (errno == EINTR) {
+                continue;
+            }
+            perror("poll");
+            break;
+        }
+
+        // Collect results from every worker that has something to say
+        for (int i = 0; i < numWorkers; i++) {
+            WorkerType *worker = &workers[i];
+            if (polls[i].revents == 0) {
+                continue;
+            }
+
+            // Read whatever part of the next result has arrived
+            ssize_t got = read(worker->fd, worker->buffer + worker->buffered, sizeof(HuntResultType) - worker->buffered);
+            if (got < 0 && errno == EINTR) {
+                continue;
+            }
+            if (got > 0) {
+                worker->buffered += got;
+                // Merge a result once all of it has arrived
+                if (worker->buffered == sizeof(HuntResultType)) {
+                    HuntResultType result;
+                    memcpy(&result, worker->buffer, sizeof(HuntResultType));
+                    // Seeds an earlier attempt already sent are simulated again only for the slot's distributions
+                    if (worker->received >= worker->shard.merged) {
+                        addHuntResult(summary, &result);
+                    }
+                    worker->buffered = 0;
+                    worker->received++;
+                    // The shard is done once every seed has a result, each recorded in the slot before it was sent
+                    if (worker->received == worker->shard.count) {
+                        worker->busy = C_FALSE;
+                        takeSlot(worker, distributions, heatmap);
+                    }
+                }
+                continue;
+            }
+
+            // The worker hung up mid-shard, so it crashed: reap it
+            int status = 0;
+            close(worker->fd);
+            waitpid(worker->pid, &status, 0);
+            fprintf(stderr, "Worker %d crashed (%s %d) on seeds %u-%u, %d results in\n", worker->pid,
+                    WIFSIGNALED(status) ? "signal" : "status", WIFSIGNALED(status) ? WTERMSIG(status) : WEXITSTATUS(status),
+                    worker->shard.firstSeed, worker->shard.firstSeed + worker->shard.count - 1, worker->received);
+
+            // The slot holds the crashed shard's hunts, maybe the last one half recorded, so it is dropped and the whole shard
+            // retried. Results arrive in seed order, so the ones already in are not counted again
+            takeSlot(worker, NULL, NULL);
+            ShardType retry = worker->shard;
+            retry.merged = worker->received > retry.merged ? worker->received : retry.merged;
+            if (retry.attempts < SHARD_ATTEMPTS) {
+                queue[queueTail++] = retry;
+            } else {
+                summary->failed += retry.count - retry.merged;
+            }
+
+            // Replace the worker so the sweep keeps its parallelism
+            worker->busy = C_FALSE;
+            worker->fd = -1;
+            if (spawnWorker(worker, workers, numWorkers, metrics, options->cachePath, options->resultsPath, &topology) == C_FALSE) {
+                worker->fd = -1;
+            }
+        }
+    }
+
+    // Seeds still queued without a worker left to take them are lost too, unless the sweep was stopped
+    int converged = sweepConverged(summary, options->ciWidth, options->ciMetrics);
+    for (int i = queueHead; i < queueTail && !*stop && !converged; i++) {
+        summary->failed += queue[i].count;
+    }
+
+    // Closing the sockets tells the workers to exit, then reap them
+    for (int i = 0; i < numWorkers; i++) {
+        if (workers[i].fd >= 0) {
+            close(workers[i].fd);
+            waitpid(workers[i].pid, NULL, 0);
+        }
+    }
+    // Every shard was either merged as it finished or dropped with its worker, so only the phase timings are left
+    if (slots != MAP_FAILED) {
+        munmap(slots, slotsSize);
+    }
+    if (heatSlots != MAP_FAILED) {
+        munmap(heatSlots, heatSize);
+    }
+    if (profileSlots != MAP_FAILED) {
+        for (int i = 0; i < numWorkers; i++) {
+            mergeProfile(profile, &profileSlots[i]);
+        }
+        munmap(profileSlots, profileSize);
+    }
+
+    free(polls);
+    free(workers);
+    free(queue);
+    return started || numShards == 0 ? C_TRUE : C_FALSE;
+}
@@ -0,0 +1,452 @@
+#include "defs.h"
+#include <poll.h>        // for poll, to notice a stop between connections
+#include <sys/socket.h>  // for socket, bind, listen, accept and shutdown
+#include <sys/stat.h>    // for stat, to tell a stale socket from another file
+#include <sys/un.h>      // for struct sockaddr_un
+
+// Set by SIGINT or SIGTERM to stop the daemon once its running jobs finish
+static volatile sig_atomic_t stopRequested = 0;
+// The daemon, shared by the accepting loop and the worker threads
+static DaemonType server;
+
+
+/*
+    Function: handleStop
+    Purpose: Signal handler asking the daemon to stop; it only sets a flag, which the accepting loop and the jobs check.
+    Params:
+        Input: int signum (in) - the signal number, unused
+        Output: void
+*/
+static void handleStop(int signum) {
+    (void)signum;
+    stopRequested = 1;
+}
+
+
+/*
+    Function: socketAddress
+    Purpose: Fills a Unix domain socket address from a path.
+    Params:
+        Input:
+            const char *path (in) - the path of the socket
+            struct sockaddr_un *address (out) - the address
+        Output: int - C_TRUE if the path fits an address, C_FALSE otherwise
+*/
+static int socketAddress(const char *path, struct sockaddr_un *address) {
+    memset(address, 0, sizeof(struct sockaddr_un));
+    address->sun_family = AF_UNIX;
+    if (strlen(path) >= sizeof(address->sun_path)) {
+        fprintf(stderr, "%s: socket path too long\n", path);
+        return C_FALSE;
+    }
+    strcpy(address->sun_path, path);
+    return C_TRUE;
+}
+
+
+/*
+    Function: parseJob
+    Purpose: Reads a job line: the seed and number of hunts, and any runtime parameter, as on fp's command line.
+    Params:
+        Input:
+            DaemonType *daemon (in) - the daemon, whose runtime parameters the job starts from
+            char *line (in/out) - the job line, split into its words
+            DaemonJobType *job (out) - the job
+            const char **error (out) - why the line is not a job, if it is not
+        Output: int - C_TRUE if the line is a job the simulation can run, C_FALSE otherwise
+*/
+static int parseJob(DaemonType *daemon, char *line, DaemonJobType *job, const char **error) {
+    job->config = *daemon->defaults;
+    job->seed = 1;
+    job->runs = 1;
+
+    char *save = NULL;
+    for (char *option = strtok_r(line, " \t\r\n", &save); option != NULL; option = strtok_r(NULL, " \t\r\n", &save)) {
+        char *value = strtok_r(NULL, " \t\r\n", &save);
+        if (value == NULL) {
+            *error = "option without a value";
+            return C_FALSE;
+        }
+        if (strcmp(option, "--runs") == 0) {
+            job->runs = atoi(value);
+        } else if (strcmp(option, "--seed") == 0) {
+            job->seed = (unsigned int)strtoul(value, NULL, 10);
+        } else if (strcmp(option, "--task-threads") == 0) {
+            // The task pool is shared by every job and started once, so its size is the daemon's alone
+            *error = "task threads are set when the daemon starts";
+            return C_FALSE;
+        } else if (parseConfigOption(&job->config, option, value) == C_FALSE) {
+            *error = "unknown option";
+            return C_FALSE;
+        }
+    }
+    if (job->runs < 1 || validConfig(&job->config) == C_FALSE) {
+        *error = "invalid value";
+        return C_FALSE;
+    }
+    return C_TRUE;
+}
+
+
+/*
+    Function: runJob
+    Purpose: Simulates every hunt of a job on the calling worker thread, streaming each outcome to the client as soon as it
+        is decided, then a closing line with the job's totals and latencies. Stops early if the client goes away or the daemon
+        is stopping.
+    Params:
+        Input:
+            DaemonType *daemon (in/out) - the daemon, whose latencies the job is counted in
+            const DaemonJobType *job (in) - the job
+            FILE *out (in) - the connection, to write the results to
+        Output: int - C_TRUE if the client is still there, C_FALSE otherwise
+*/
+static int runJob(DaemonType *daemon, const DaemonJobType *job, FILE *out) {
+    fprintf(out, "ok %d\n", job->runs);
+    SweepSummaryType summary;
+    initSweepSummary(&summary);
+    long long firstMicros = 0;
+    int connected = fflush(out) == 0;
+
+    for (int run = 0; run < job->runs && connected && !*daemon->stop; run++) {
+        HuntResultType result;
+        runHunt(&job->config, job->seed + run, daemon->metrics, NULL, NULL, NULL, &result);
+        addHuntResult(&summary, &result);
+
+        // One line per hunt, the columns of fp-results --csv then the microseconds the hunt took
+        char ghost[16];
+        char identified[16];
+        ghostToString(result.ghostClass, ghost);
+        ghostToString(result.identifiedClass, identified);
+        fprintf(out, "%u,%s,%s,%s,%u,%u,%u,%u,%u\n", result.seed,
+                result.outcome == HUNT_HUNTERS_WON ? "hunters" : result.outcome == HUNT_GHOST_WON ? "ghost" : "none",
+                ghost, identified, result.exitedFear, result.exitedBoredom, result.ticks, result.evidenceCollected, result.micros);
+        connected = fflush(out) == 0;
+        if (run == 0) {
+            firstMicros = (monotonicNanos() - job->submitNanos) / 1000;
+        }
+    }
+    long long micros = (monotonicNanos() - job->submitNanos) / 1000;
+    fprintf(out, "done %lld %lld %lld %lld %lld\n", summary.runs, summary.hunterWins, summary.correct, firstMicros, micros);
+    connected = fflush(out) == 0 && connected;
+
+    // Count the job in the daemon's latencies
+    pthread_mutex_lock(&daemon->lock);
+    long long number = ++daemon->jobs;
+    daemon->hunts += summary.runs;
+    recordValue(&daemon->firstLatency, firstMicros < UINT32_MAX ? firstMicros : UINT32_MAX);
+    recordValue(&daemon->latency, micros < UINT32_MAX ? micros : UINT32_MAX);
+    pthread_mutex_unlock(&daemon->lock);
+    printf("job %lld: %lld of %d hunts from seed %u, first result %lld us, done %lld us\n", number, summary.runs, job->runs, job->seed,
+           firstMicros, micros);
+    fflush(stdout);
+    return connected;
+}
+
+
+/*
+    Function: serveConnection
+    Purpose: Reads job lines from a connection until the client closes it, running each job as it arrives.
+    Params:
+        Input:
+            DaemonType *daemon (in/out) - the daemon
+            int fd (in) - the connection, closed on return
+        Output: void
+*/
+static void serveConnection(DaemonType *daemon, int fd) {
+    FILE *in = fdopen(fd, "r");
+    FILE *out = fdopen(dup(fd), "w");
+    char line[DAEMON_LINE];
+    while (fgets(line, sizeof(line), in) != NULL && !*daemon->stop) {
+        if (strspn(line, " \t\r\n") == strlen(line)) {
+            continue;
+        }
+        // A job's latency counts from the moment its line was read
+        DaemonJobType job;
+        job.submitNanos = monotonicNanos();
+        const char *error = NULL;
+        if (parseJob(daemon, line, &job, &error) == C_FALSE) {
+            fprintf(out, "error %s\n", error);
+            if (fflush(out) != 0) {
+                break;
+            }
+            continue;
+        }
+        if (runJob(daemon, &job, out) == C_FALSE) {
+            break;
+        }
+    }
+    fclose(out);
+    fclose(in);
+}
+
+
+/*
+    Function: workerThread
+    Purpose: A worker thread of the daemon: warms itself by simulating one hunt of the daemon's map, flat out on the lockstep
+        engine, then serves waiting connections one at a time until the daemon stops. The thread, its heap arena and the tables of the
+        map stay warm from one job to the next.
+    Params:
+        Input: void *arg (in) - the worker's index into the daemon, as an intptr_t
+        Output: void* - always NULL
+*/
+static void *workerThread(void *arg) {
+    int index = (int)(intptr_t)arg;
+    // Whatever engine and delay the daemon defaults to, the warm-up hunt is played flat out on this thread alone, so it takes
+    // microseconds rather than a real-time hunt
+    ConfigType warm = *server.defaults;
+    warm.actionDelay = 0;
+    warm.engine = ENGINE_LOCKSTEP;
+    warm.stepThreads = 1;
+    warm.samplePeriod = 0;
+    HuntResultType result;
+    runHunt(&warm, 1, NULL, NULL, NULL, NULL, &result);
+
+    pthread_mutex_lock(&server.lock);
+    while (C_TRUE) {
+        while (server.count == 0 && !server.stopping) {
+            pthread_cond_wait(&server.ready, &server.lock);
+        }
+        if (server.stopping) {
+            break;
+        }
+        int fd = server.pending[server.head];
+        server.head = (server.head + 1) % DAEMON_BACKLOG;
+        server.count--;
+        server.serving[index] = fd;
+        pthread_mutex_unlock(&server.lock);
+
+        serveConnection(&server, fd);
+
+        pthread_mutex_lock(&server.lock);
+        server.serving[index] = -1;
+    }
+    pthread_mutex_unlock(&server.lock);
+    return NULL;
+}
+
+/*
+    Function: serveJobs
+    Purpose: Listens on a Unix domain socket and hands each connection to a warm worker thread, until SIGINT or SIGTERM.
+        On stopping, idle connections are shut down, running jobs end after their current hunt, and the latencies of every
+        job served are printed.
+    Params:
+        Input:
+            const char *path (in) - the path of the socket, a stale socket left there is replaced
+            int numThreads (in) - the worker threads
+            const ConfigType *defaults (in) - the runtime parameters jobs start from
+            MetricsType *metrics (in) - the metrics every hunt publishes into, may be NULL
+        Output: int - C_TRUE if the daemon served until stopped, C_FALSE if it could not listen
+*/
+static int serveJobs(const char *path, int numThreads, const ConfigType *defaults, MetricsType *metrics) {
+    struct sockaddr_un address;
+    if (socketAddress(path, &address) == C_FALSE) {
+        return C_FALSE;
+    }
+    // Only a socket is replaced, never a file that happens to have the same name
+    struct stat info;
+    if (stat(path, &info) == 0 && S_ISSOCK(info.st_mode)) {
+        unlink(path);
+    }
+    int listenFd = socket(AF_UNIX, SOCK_STREAM, 0);
+    if (listenFd < 0 || bind(listenFd, (struct sockaddr *)&address, sizeof(address)) != 0 || listen(listenFd, DAEMON_BACKLOG) != 0) {
+        perror(path);
+        if (listenFd >= 0) {
+            close(listenFd);
+        }
+        return C_FALSE;
+    }
+
+    memset(&server, 0, sizeof(server));
+    server.listenFd = listenFd;
+    server.defaults = defaults;
+    server.metrics = metrics;
+    server.stop = &stopRequested;
+    server.numThreads = numThreads;
+    server.threads = malloc(sizeof(pthread_t) * numThreads);
+    server.serving = malloc(sizeof(int) * numThreads);
+    pthread_mutex_init(&server.lock, NULL);
+    pthread_cond_init(&server.ready, NULL);
+    for (int i = 0; i < numThreads; i++) {
+        server.serving[i] = -1;
+        pthread_create(&server.threads[i], NULL, workerThread, (void *)(intptr_t)i);
+    }
+    printf("Serving jobs on %s with %d worker threads\n", path, numThreads);
+    fflush(stdout);
+
+    // Accept connections, waking regularly to notice a stop
+    while (!stopRequested) {
+        struct pollfd waiting = {listenFd, POLLIN, 0};
+        if (poll(&waiting, 1, 200) <= 0) {
+            continue;
+        }
+        int fd = accept(listenFd, NULL, NULL);
+        if (fd < 0) {
+            continue;
+        }
+        pthread_mutex_lock(&server.lock);
+        if (server.count == DAEMON_BACKLOG) {
+            pthread_mutex_unlock(&server.lock);
+            const char *busy = "error busy\n";
+            if (write(fd, busy, strlen(busy)) < 0) {
+                // The client is gone already
+            }
+            close(fd);
+            continue;
+        }
+        server.pending[(server.head + server.count) % DAEMON_BACKLOG] = fd;
+        server.count++;
+        pthread_cond_signal(&server.ready);
+        pthread_mutex_unlock(&server.lock);
+    }
+
+    // Stop: no more connections, idle ones end their read, and the worker threads return once their job does
+    close(listenFd);
+    unlink(path);
+    pthread_mutex_lock(&server.lock);
+    server.stopping = C_TRUE;
+    for (int i = 0; i < numThreads; i++) {
+        if (server.serving[i] >= 0) {
+            shutdown(server.serving[i], SHUT_RD);
+        }
+    }
+    while (server.count > 0) {
+        close(server.pending[server.head]);
+        server.head = (server.head + 1) % DAEMON_BACKLOG;
+        server.count--;
+    }
+    pthread_cond_broadcast(&server.ready);
+    pthread_mutex_unlock(&server.lock);
+    for (int i = 0; i < numThreads; i++) {
+        pthread_join(server.threads[i], NULL);
+    }
+    stopTasks();
+
+    printf("\n=== Served %lld jobs, %lld hunts ===\n", server.jobs, server.hunts);
+    printf("%-24s %10s %10s %10s %10s %10s\n", "latency from submission", "mean us", "p50 us", "p90 us", "p99 us", "max us");
+    const HistogramType *histograms[2] = {&server.firstLatency, &server.latency};
+    const char *names[2] = {"first result", "last result"};
+    for (int i = 0; i < 2; i++) {
+        const HistogramType *histogram = histograms[i];
+        printf("%-24s %10.0f %10u %10u %10u %10u\n", names[i], histogram->count > 0 ? (double)histogram->sum / histogram->count : 0.0,
+               valueAtPercentile(histogram, 50.0), valueAtPercentile(histogram, 90.0), valueAtPercentile(histogram, 99.0),
+               histogram->max);
+    }
+
+    free(server.threads);
+    free(server.serving);
+    pthread_mutex_destroy(&server.lock);
+    pthread_cond_destroy(&server.ready);
+    return C_TRUE;
+}
+
+
+/*
+    Function: submitJob
+    Purpose: Sends one job to a running daemon and prints every line it streams back, until the job is done.
+    Params:
+        Input:
+            const char *path (in) - the path of the daemon's socket
+            int argc (in) - the number of words of the job
+            char *argv[] (in) - the words of the job, options and their values
+        Output: int - C_TRUE if the job was done, C_FALSE if the daemon could not be reached or refused the job
+*/
+static int submitJob(const char *path, int argc, char *argv[]) {
+    struct sockaddr_un address;
+    if (socketAddress(path, &address) == C_FALSE) {
+        return C_FALSE;
+    }
+    int fd = socket(AF_UNIX, SOCK_STREAM, 0);
+    if (fd < 0 || connect(fd, (struct sockaddr *)&address, sizeof(address)) != 0) {
+        perror(path);
+        if (fd >= 0) {
+            close(fd);
+        }
+        return C_FALSE;
+    }
+
+    FILE *out = fdopen(dup(fd), "w");
+    for (int i = 0; i < argc; i++) {
+        fprintf(out, "%s%s", i > 0 ? " " : "", argv[i]);
+    }
+    fprintf(out, "\n");
+    fclose(out);
+
+    FILE *in = fdopen(fd, "r");
+    char line[DAEMON_LINE];
+    int done = C_FALSE;
+    while (fgets(line, sizeof(line), in) != NULL) {
+        fputs(line, stdout);
+        if (strncmp(line, "done ", 5) == 0) {
+            done = C_TRUE;
+            break;
+        }
+        if (strncmp(line, "error ", 6) == 0) {
+            break;
+        }
+    }
+    fclose(in);
+    return done;
+}
+
+
+/*
+    Function: main
+    Purpose: Entry point of fp-daemon. Serves hunt and sweep jobs on a Unix domain socket from warm worker threads, or with
+        --submit sends one job to a running daemon and prints its results.
+    Params:
+        Input:
+            int argc (in) - the number of command line arguments
+            char *argv[] (in) - the command line arguments
+    Returns: int - status code of the program execution
+*/
+int main(int argc, char *argv[]) {
+    if (argc >= 3 && strcmp(argv[1], "--submit") == 0) {
+        return submitJob(argv[2], argc - 3, argv + 3) ? EXIT_SUCCESS : EXIT_FAILURE;
+    }
+
+    // Parse the daemon's own options, the runtime parameters being the defaults of every job
+    const char *path = argc >= 2 ? argv[1] : NULL;
+    int numThreads = DAEMON_THREADS;
+    const char *metricsPath = NULL;
+    ConfigType defaults;
+    initConfig(&defaults);
+    int valid = path != NULL && path[0] != '-';
+    for (int i = 2; i < argc && valid; i += 2) {
+        const char *value = i + 1 < argc ? argv[i + 1] : NULL;
+        if (value == NULL) {
+            valid = C_FALSE;
+        } else if (strcmp(argv[i], "--threads") == 0) {
+            numThreads = atoi(value);
+        } else if (strcmp(argv[i], "--metrics") == 0) {
+            metricsPath = value;
+        } else {
+            valid = parseConfigOption(&defaults, argv[i], value);
+        }
+    }
+    if (!valid || numThreads < 1 || validConfig(&defaults) == C_FALSE) {
+        printf("Usage: %s SOCKET [--threads N] [--metrics FILE] [runtime options of fp]\n"
+               "       %s --submit SOCKET [--runs N] [--seed S] [runtime options of fp]\n", argv[0], argv[0]);
+        return EXIT_FAILURE;
+    }
+
+    MetricsType *metrics = NULL;
+    if (metricsPath != NULL) {
+        metrics = openMetrics(metricsPath);
+        if (metrics == NULL) {
+            return EXIT_FAILURE;
+        }
+    }
+
+    // Nothing is logged, a client that goes away is noticed by its failed writes, and a signal stops the daemon
+    logMask = 0;
+    signal(SIGPIPE, SIG_IGN);
+    struct sigaction stop;
+    memset(&stop, 0, sizeof(stop));
+    stop.sa_handler = handleStop;
+    sigaction(SIGINT, &stop, NULL);
+    sigaction(SIGTERM, &stop, NULL);
+
+    int served = serveJobs(path, numThreads, &defaults, metrics);
+    closeMetrics(metrics);
+    return served ? EXIT_SUCCESS : EXIT_FAILURE;
+}
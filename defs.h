@@ -4,6 +4,14 @@
 #include <pthread.h>
 #include <semaphore.h>
 #include <unistd.h> // for usleep function
+#include <stdatomic.h> // for the lock-free metrics counters
+#include <stdint.h> // for the fixed-width result fields
+#include <signal.h> // for sig_atomic_t
+#if defined(__x86_64__) || defined(__i386__)
+#include <x86intrin.h> // for __rdtsc, the profiler's clock
+#else
+#include <time.h> // for clock_gettime, the profiler's clock elsewhere
+#endif
 
 #define MAX_STR 64
 #define MAX_RUNS 50
@@ -17,6 +25,74 @@
 #define FEAR_MAX 10
 #define MAX_ARR 128
 #define LOGGING  C_TRUE
+#define METRICS_MAGIC 0x53484d54 // "SHMT", marks a valid metrics file
+#define METRICS_VERSION 3
+#define ACTION_DELAY 10000 // Default microseconds agents sleep between actions
+#define SHARD_SIZE 16 // Default number of seeds handed to a worker at a time
+#define SHARD_ATTEMPTS 3 // Times a shard is tried before its seeds are given up on
+#define SIM_VERSION 4 // Bump whenever a change alters hunt outcomes, so cached results are not reused
+#define CACHE_MAGIC 0x43524853 // "SHRC", marks a result cache file
+#define CACHE_VERSION 2
+#define RESULTS_MAGIC 0x53524853 // "SHRS", marks a columnar results file
+#define RESULTS_VERSION 1
+#define CHUNK_MAGIC 0x4b4e4843 // "CHNK", marks each chunk of a results file
+#define RESULTS_CHUNK 4096 // Hunts a results writer buffers before appending them as one chunk
+#define RESULTS_RECORD_BYTES 17 // Bytes one hunt takes across the columns of a chunk
+#define CACHE_LINE 64 // Bytes per cache line, so counters written by different threads never share one
+#define PROFILE_BUCKETS 48 // Power-of-two buckets of profiled phase durations, in clock ticks
+#define HIST_SUB_BITS 7 // Values below 2^7 get a bucket each, every larger power of two is split into 2^6 buckets
+#define HIST_SUB_BUCKETS (1 << HIST_SUB_BITS)
+#define HIST_BUCKETS (HIST_SUB_BUCKETS + (32 - HIST_SUB_BITS) * (HIST_SUB_BUCKETS / 2)) // Buckets covering every uint32_t
+#define FNV_OFFSET 0xcbf29ce484222325ULL // Starting value of an FNV-1a hash
+#define CI_Z 1.96 // Normal quantile of the 95% confidence intervals
+#define CI_MIN_RUNS 30 // Hunts needed before early stopping trusts an interval
+#define CI_GHOST_WIN 1 // Early stopping metric: probability that the ghost wins
+#define CI_ACCURACY 2 // Early stopping metric: probability that a matched ghost is the real one
+#define ENGINE_THREADS 0 // Engine: one thread per agent, locking each room it acts in
+#define ENGINE_ACTOR 1 // Engine: room owners act for the agents in their rooms, moves are messages
+#define ENGINE_LOCKSTEP 2 // Engine: every agent decides from the same tick in parallel, then the decisions are applied in order
+#define ENGINE_TASKS 3 // Engine: every agent is a task resumed for one action at a time by a small pool of threads
+#define ROOM_OWNERS 2 // Default number of room-owner threads in the actor engine
+#define STEP_THREADS 2 // Default number of threads deciding in parallel in the lockstep engine
+#define TASK_THREADS 2 // Default number of threads in the pool running the tasks engine's agents
+#define WAKE_DELAY 0 // Threads engine pacing: agents sleep out the delay between actions
+#define WAKE_EVENT 1 // Threads engine pacing: idle hunters park in their room through the periods where they would change nothing
+#define WAKE_PLAN 16 // Most actions a hunter draws ahead to find the periods it can park through
+#define POLICY_RANDOM 0 // Movement: uniform random walk
+#define POLICY_DIRECTED 1 // Movement: towards goals, along the precomputed next-hop table
+#define ROUTE_MAX_ROOMS 4096 // Most rooms a generated map may have, bounding the next-hop table
+#define ROUTE_NONE 255 // Next-hop slot meaning "already there" or "unreachable"
+#define RADIO_LATENCY 2 // Default actions of the receiver before a report that reached its radio can be used
+#define RADIO_LOSS 0 // Default percentage of reports lost on the air
+#define RADIO_BANDWIDTH 4 // Default reports a hunter can take in per action
+#define RADIO_INTERVAL 5 // Default actions between a hunter's status reports, 0 to only report new evidence
+#define EVIDENCE_CAP 64 // Default most pieces of evidence a room holds, in all (oldest) or of each type (coalesce)
+#define EVIDENCE_OLDEST 0 // Room evidence: a full room forgets its oldest piece to take a new one
+#define EVIDENCE_COALESCE 1 // Room evidence: the pieces of a type are one count, which stops at the cap
+#define SCENARIO_HUNTS 1000 // Hunts per timed repetition of a regression scenario
+#define SCENARIO_REPS 10 // Default timed repetitions of a regression scenario
+#define BASELINE_MAX_REPS 64 // Most repetitions a baseline keeps the samples of
+#define BOOTSTRAP_RESAMPLES 2000 // Resamples drawn for a bootstrap confidence interval
+#define REGRESSION_THRESHOLD 10.0 // Default percentage a measure may worsen by before it is a regression
+#define SAMPLE_PERIOD 10 // Default ghost ticks between samples of a hunt's state
+#define SAMPLE_RING 1024 // Samples a hunt's ring holds before the oldest is overwritten, or the ring is written out when streaming
+#define SAMPLE_WRITE 16384 // Bytes of sample lines formatted before they are written out at once
+#define DAEMON_THREADS 2 // Default worker threads of fp-daemon, each serving one connection at a time
+#define DAEMON_BACKLOG 64 // Most accepted connections fp-daemon holds while every worker thread is busy
+#define DAEMON_LINE 1024 // Longest job line fp-daemon reads
+#define AFFINITY_NONE 0 // Worker placement: left to the scheduler
+#define AFFINITY_NODE 1 // Worker placement: pinned to the CPUs of one NUMA node, memory preferred from that node
+#define AFFINITY_CORE 2 // Worker placement: pinned to one CPU, memory preferred from its node
+#define TOPOLOGY_MAX_NODES 32 // Most NUMA nodes placement tells apart
+#define TOPOLOGY_MAX_CPUS 1024 // Most CPUs placement tells apart
+
+// Measures of a regression scenario, in the order they are stored and compared
+enum ScenarioMetric {
+    SCEN_HUNTS_PER_SEC,    // Hunts simulated per second of wall-clock time, higher is better
+    SCEN_P99_MICROS,       // 99th percentile of the microseconds a hunt took, lower is better
+    SCEN_ALLOCS_PER_HUNT,  // Heap allocations per hunt, lower is better
+    SCENARIO_METRICS
+};
 
 // Enums for Evidence and Ghost types
 typedef enum EvidenceType EvidenceType;
@@ -33,10 +109,56 @@ typedef struct Evidence Evidence;
 typedef struct House HouseType;
 typedef struct Hunter HunterType;
 typedef struct HunterList HunterListType;
+typedef struct HunterRegistry HunterRegistryType;
 typedef struct RoomNode RoomNodeType;
 typedef struct EvidenceList EvidenceListType;
+typedef struct RoomEvidence RoomEvidenceType;
 typedef struct RoomList RoomListType;
 typedef struct ThreadData ThreadDataType;
+typedef struct Metrics MetricsType;
+typedef struct Options OptionsType;
+typedef struct Config ConfigType;
+typedef struct HuntResult HuntResultType;
+typedef struct SweepSummary SweepSummaryType;
+typedef struct Shard ShardType;
+typedef struct Worker WorkerType;
+typedef struct Topology TopologyType;
+typedef struct CacheHeader CacheHeaderType;
+typedef struct CacheRecord CacheRecordType;
+typedef struct Cache CacheType;
+typedef struct ResultsHeader ResultsHeaderType;
+typedef struct ChunkHeader ChunkHeaderType;
+typedef struct ResultsWriter ResultsWriterType;
+typedef struct ResultsColumns ResultsColumnsType;
+typedef struct ResultsSummary ResultsSummaryType;
+typedef struct Histogram HistogramType;
+typedef struct Distributions DistributionsType;
+typedef struct RoomHeat RoomHeatType;
+typedef struct Heatmap HeatmapType;
+typedef struct PhaseProfile PhaseProfileType;
+typedef struct Profile ProfileType;
+typedef struct MailNode MailNodeType;
+typedef struct Mailbox MailboxType;
+typedef struct AgentMessage AgentMessageType;
+typedef struct RoomOwner RoomOwnerType;
+typedef struct RadioReport RadioReportType;
+typedef struct Radio RadioType;
+typedef struct RouteTable RouteTableType;
+typedef struct Intent IntentType;
+typedef struct Lockstep LockstepType;
+typedef struct LockstepWorker LockstepWorkerType;
+typedef struct AgentTask AgentTaskType;
+typedef struct HuntTasks HuntTasksType;
+typedef struct TaskPool TaskPoolType;
+typedef struct BenchSample BenchSampleType;
+typedef struct BenchCase BenchCaseType;
+typedef struct BenchScenario BenchScenarioType;
+typedef struct ScenarioRun ScenarioRunType;
+typedef struct SpectraHunt SpectraHuntType;
+typedef struct Sample SampleType;
+typedef struct SampleRing SampleRingType;
+typedef struct DaemonJob DaemonJobType;
+typedef struct Daemon DaemonType;
 
 enum EvidenceType
 {
@@ -65,6 +187,150 @@ enum LoggerDetails
     LOG_INSUFFICIENT,
     LOG_UNKNOWN
 };
+enum LogCategory
+{
+    LOG_HUNTER_INIT,      // A hunter is placed in the van
+    LOG_HUNTER_MOVE,      // A hunter moves to another room
+    LOG_HUNTER_REVIEW,    // A hunter reviews the evidence, off by default as it is the most frequent
+    LOG_HUNTER_COLLECT,   // A hunter collects evidence
+    LOG_HUNTER_EXIT,      // A hunter leaves the house
+    LOG_GHOST_INIT,       // The ghost is placed
+    LOG_GHOST_MOVE,       // The ghost moves to another room
+    LOG_GHOST_EVIDENCE,   // The ghost leaves evidence
+    LOG_GHOST_EXIT,       // The ghost leaves the house
+    LOG_CATEGORY_COUNT
+};
+enum Distribution
+{
+    DIST_TICKS_TO_IDENTIFY, // Ghost ticks until a hunter left with the ghost identified, for hunts the hunters won
+    DIST_FINAL_FEAR,        // Fear of each hunter when the hunt ended
+    DIST_EXIT_BOREDOM,      // Boredom of each hunter that left the house, when it left
+    DIST_EVIDENCE_DROPPED,  // Evidence the ghost dropped in each hunt
+    DIST_HUNTER_MOVES,      // Moves of each hunter in each hunt
+    DIST_COUNT
+};
+enum HeatCounter
+{
+    HEAT_HUNTER_VISITS,      // Hunters that moved into the room
+    HEAT_GHOST_TICKS,        // Ghost ticks spent in the room
+    HEAT_EVIDENCE_DROPPED,   // Evidence the ghost left in the room
+    HEAT_EVIDENCE_COLLECTED, // Evidence hunters collected in the room
+    HEAT_EVIDENCE_FORGOTTEN, // Evidence the room forgot or merged because it was full
+    HEAT_FEAR,               // Fear hunters gained in the room
+    HEAT_COUNT
+};
+enum ProfilePhase
+{
+    PROF_HUNTER_LOCK,     // A hunter waiting for its room's lock
+    PROF_HUNTER_DECIDE,   // A hunter updating its fear and boredom and picking its action, and where to move
+    PROF_HUNTER_COLLECT,  // A hunter collecting evidence
+    PROF_HUNTER_MOVE,     // A hunter moving between the hunter lists of two rooms
+    PROF_HUNTER_REVIEW,   // A hunter reviewing the evidence, and leaving with it
+    PROF_GHOST_SCAN,      // The ghost locking each room in turn, looking for itself
+    PROF_GHOST_DECIDE,    // The ghost updating its boredom and picking its action, and where to move
+    PROF_GHOST_EVIDENCE,  // The ghost dropping evidence
+    PROF_GHOST_MOVE,      // The ghost moving between rooms
+    PROF_COUNT
+};
+enum HuntState
+{
+    HUNT_RUNNING,      // The outcome is not decided yet
+    HUNT_HUNTERS_WON,  // A hunter left with sufficient evidence
+    HUNT_GHOST_WON,    // Every hunter left because of fear or boredom
+    HUNT_CANCELLED     // The hunt was stopped from outside before it was decided
+};
+enum MetricCounter
+{
+    MET_TICKS,            // Ghost ticks (one per performGhostAction call)
+    MET_HUNTER_COLLECT,   // Hunter collect actions
+    MET_HUNTER_MOVE,      // Hunter move actions
+    MET_HUNTER_REVIEW,    // Hunter review actions
+    MET_GHOST_EVIDENCE,   // Evidence dropped by the ghost
+    MET_GHOST_MOVE,       // Ghost moves
+    MET_GHOST_IDLE,       // Ghost ticks where nothing happened
+    MET_HUNTERS_ALIVE,    // Gauge of hunters currently in a house
+    MET_EVIDENCE_EMF,     // Evidence collected, one counter per EvidenceType in enum order
+    MET_EVIDENCE_TEMPERATURE,
+    MET_EVIDENCE_FINGERPRINTS,
+    MET_EVIDENCE_SOUND,
+    MET_ROOM_LOCK_WAITS,  // Room locks that were contended and had to block
+    MET_RADIO_SENT,       // Radio reports put on the air
+    MET_RADIO_LOST,       // Radio reports lost on the air
+    MET_RADIO_DELIVERED,  // Radio reports taken in by their receiver
+    MET_EVENT_WAKEUPS,    // Parked hunters woken by an event in their room before their idle periods ran out
+    MET_IDLE_SKIPPED,     // Idle hunter periods slept through rather than woken for
+    MET_RUNS_COMPLETED,   // Hunts finished (more than one in batch mode)
+    MET_COUNT
+};
+enum StepOutcome
+{
+    STEP_STAYED,  // The agent acted and stays in its room
+    STEP_MOVING,  // The agent picked a connected room to move to
+    STEP_EXITED   // The agent left the house
+};
+enum AgentAction
+{
+    ACT_COLLECT,   // A hunter collects evidence
+    ACT_MOVE,      // The agent moves to a connected room
+    ACT_REVIEW,    // A hunter reviews the evidence
+    ACT_EVIDENCE,  // The ghost leaves evidence
+    ACT_IDLE       // The ghost does nothing
+};
+
+// Structure representing a link in a mailbox, embedded in whatever is being sent
+struct MailNode
+{
+    MailNodeType *_Atomic next; // Next node in the mailbox, set by the sender that follows
+};
+
+// Structure representing a lock-free mailbox: any thread may post, only the owner takes
+struct Mailbox
+{
+    MailNodeType *_Atomic head; // Most recently posted node, swapped in by senders
+    MailNodeType *tail;         // Oldest node not taken yet, touched only by the owner
+    MailNodeType stub;          // Placeholder node so the mailbox is never empty of links
+    atomic_int count;           // Nodes posted and not taken yet
+};
+
+// Structure representing an agent travelling between rooms as a message in the actor engine
+struct AgentMessage
+{
+    MailNodeType node;  // Link in the mailbox of the room the agent is in or arriving at, must come first
+    int isHunter;       // C_TRUE if the agent is a hunter, C_FALSE for the ghost
+    int arriving;       // C_TRUE if the agent still has to be placed in the room
+    void *agent;        // The hunter or ghost
+};
+
+// Structure representing a radio report: everything a hunter knew when it sent it
+struct RadioReport
+{
+    MailNodeType node;        // Link in the receiver's inbox, then in the sender's spares, must come first
+    RadioReportType *pending; // Next report waiting out its latency at the receiver
+    RadioReportType *next;    // Next report allocated by the same sender, so every report can be freed
+    int sender;               // Radio of the sender, which gets the report back once it is used
+    int knowledge;            // Evidence known to the sender, one bit per EvidenceType
+    int arrivedAt;            // Receiver's action count when the report reached its radio
+    long long sentAt;         // Monotonic nanoseconds when the report was sent
+};
+
+// Structure representing a hunter's radio, owned by the house so it outlives the hunter
+struct Radio
+{
+    MailboxType inbox;            // Reports sent to this hunter
+    MailboxType spares;           // Reports of this hunter's that receivers are done with
+    RadioReportType *pendingHead; // Reports received and waiting out their latency, oldest first
+    RadioReportType *pendingTail; // Newest report waiting out its latency
+    RadioReportType *allocated;   // Every report this hunter ever allocated
+    atomic_int listening;         // C_TRUE while the hunter is in the house, so others skip it once it left
+    int index;                    // Position of the radio in the house
+    int knowledge;                // Evidence this hunter knows of, one bit per EvidenceType
+    int actions;                  // Actions taken by the hunter, the radio's clock
+    long long sent;               // Reports this hunter put on the air
+    long long lost;               // Reports of this hunter's lost on the air
+    long long delivered;          // Reports this hunter took in
+    long long latency;            // Actions the delivered reports waited in total
+    long long waitNanos;          // Nanoseconds the delivered reports took from sending to being taken in, in total
+};
 
 // Structure representing a Ghost
 struct Ghost
@@ -73,6 +339,8 @@ struct Ghost
     GhostClass ghostType; // Type of the ghost
     struct Room *room;    // The room where the ghost is located
     int boredomTimer;     // Timer representing the ghost's boredom
+    int evidenceDropped;  // Evidence the ghost left so far
+    AgentMessageType message; // The ghost as a message, in the actor engine
 };
 
 // Structure representing a Node in the Room list
@@ -101,8 +369,8 @@ struct RoomArray
 // Structure representing an array of Hunters
 struct HunterArray
 {
-    HunterType *hunters[MAX_ARR]; // Array of HunterType pointers
-    int size;                     // Current size of the array
+    HunterType **hunters; // Array of HunterType pointers, sized to the hunters of the hunt
+    int size;             // Current size of the array
 };
 
 // Structure representing a Node in the Ghost list
@@ -135,17 +403,38 @@ struct EvidenceList
     int count;      // Number of elements in the evidence list
 };
 
+// Structure representing the evidence left in a room, bounded whatever the length of the hunt
+struct RoomEvidence
+{
+    uint8_t *ring;           // Pieces by age from start, the oldest first, allocated on the first drop; NULL when coalescing
+    int capacity;            // Slots of the ring
+    int start;               // Slot of the oldest piece in the ring
+    int count;               // Pieces in the room
+    int peak;                // Most pieces the room held at once
+    int counts[EV_COUNT];    // Pieces of each EvidenceType in the room
+    long long discarded;     // Pieces forgotten because the room was full
+};
+
 
 // Structure representing a Hunter
 struct Hunter
 {
-    int id;                             // Unique identifier for the hunter
+    int id;                             // Dense identifier, the hunter's position in the house's registry
     char name[MAX_STR];                 // Name of the hunter
     enum EvidenceType equipmentType;    // Type of equipment the hunter possesses
     struct Evidence *collectedEvidence; // Evidence collected by the hunter
-    int fear;                           // Fear level of the hunter
-    int boredomTimer;                   // Timer representing the hunter's boredom
+    atomic_int fear;                    // Fear level of the hunter, written by its own thread and sampled by the ghost's
+    atomic_int boredomTimer;            // Timer representing the hunter's boredom, sampled the same way
     struct Room *currentRoom;           // Current room of the hunter
+    AgentMessageType message;           // The hunter as a message, in the actor engine
+    RadioType *radio;                   // The hunter's radio, NULL when hunters share evidence directly
+    int ghostSeen;                      // Id of the room the hunter last met the ghost in, -1 if never
+    int moves;                          // Rooms the hunter moved to so far
+    atomic_int exited;                  // C_TRUE once the hunter left the house, sampled the same way
+    uint8_t planned[WAKE_PLAN];         // Actions drawn ahead for the coming periods under --wake event, the next first
+    int plannedCount;                   // Actions drawn ahead and not yet taken
+    int idlePeriods;                    // Leading planned periods that would only add to the boredom timer, to park through
+    unsigned int seenEvents;            // Events of the hunter's room when its idle periods were planned
 };
 
 // Structure representing the list of Hunters
@@ -156,29 +445,87 @@ struct HunterList
     int count;             // Number of elements in the hunter list
 };
 
+// Structure representing the hunters of a house: a table indexed by id, and a hash index from name to id
+struct HunterRegistry
+{
+    HunterType *table;  // Every hunter, indexed by id, allocated once so hunters never move
+    int count;          // Hunters registered, the next id to hand out
+    int capacity;       // Hunters the table can hold
+    int *index;         // Open-addressed slots holding the id of the hunter hashed there, -1 if empty
+    int indexMask;      // Slots in the index minus one, the slot count being a power of two
+};
+
 // Structure representing a Room
 struct Room
 {
     int id;                        // Unique identifier for the room
     char name[MAX_STR];            // Name of the room
     struct Ghost *ghost;           // Ghost present in the room
-    struct EvidenceList evidences; // List of evidence in the room
+    RoomEvidenceType evidence;     // Evidence left in the room
     struct HunterList hunters;     // List of hunters in the room
     RoomListType* connectedRooms;  // List of rooms connected to this room
-    pthread_t roomPThread;         // Thread for the room
+    pthread_t roomPThread;         // Thread that owns the room in the actor engine
     sem_t roomSem;                 // Semaphore for room access control
+    atomic_uint events;            // Events parked hunters wake on: the ghost entering, evidence dropped, the hunt ending
+    atomic_int parked;             // Hunters parked on the room's events, so signalling an empty room costs no system call
+    MailboxType mailbox;           // Agents in or arriving at the room, in the actor engine
 };
 
 // Structure representing the House
 struct House
 {
     RoomListType rooms;                            // List of rooms in the house
-    HunterListType hunters;                        // List of hunters in the house
-    enum EvidenceType sharedEvidence[MAX_ARR];     // Array for shared evidence
-    HunterArrayType huntersExitedFear[MAX_ARR];    // Array for hunters who exited due to fear
-    HunterArrayType huntersExitedBoredom[MAX_ARR]; // Array for hunters who exited due to boredom
+    HunterRegistryType registry;                   // Every hunter of the house, which owns them
+    uint8_t sharedEvidence[MAX_ARR];               // Array for shared evidence, one EvidenceType per byte
+    HunterArrayType huntersExitedFear;             // Hunters who exited due to fear
+    HunterArrayType huntersExitedBoredom;          // Hunters who exited due to boredom
     int sharedEvidenceCount;                       // Count of shared evidence
     sem_t evidenceSem;                             // Semaphore for evidence access control
+    MetricsType *metrics;                          // Live metrics to publish into, NULL if disabled
+    atomic_int state;                              // enum HuntState, checked by every agent between actions
+    atomic_int huntersInHouse;                     // Hunters that have not exited yet
+    atomic_int ticks;                              // Ghost ticks so far
+    const ConfigType *config;                      // Runtime parameters of the hunt
+    unsigned int seed;                             // Seed every random stream of the hunt derives from
+    RadioType *radios;                             // One radio per hunter, NULL when the radio network is off
+    long long micros;                              // Wall-clock microseconds the hunt took to simulate
+    RoomType **roomTable;                          // Every room, indexed by its id
+    const RouteTableType *routes;                  // Next-hop table of the map, NULL unless movement is directed
+    atomic_int evidenceHint[EV_COUNT];             // Id of the room the ghost last left each evidence type in, -1 if none
+    atomic_int hunterHint;                         // Id of the room a hunter last moved to, -1 if none
+    atomic_int evidenceMask;                       // Evidence types collected so far, one bit per EvidenceType
+    RoomHeatType *heat;                            // Per-room activity counters, indexed by room id, NULL unless tracked
+    GhostType *ghost;                              // The ghost, once placed, which owns the sample ring while it acts
+    atomic_int roomEvidence;                       // Pieces of evidence in all the rooms, only counted while sampling
+    SampleRingType *samples;                       // The hunt's samples not yet written out, NULL unless sampling
+};
+
+// Structure representing the state of a hunt at one tick, read without taking any room's lock
+struct Sample {
+    uint32_t tick;           // Ghost tick the sample was taken at, before the ghost acted
+    uint16_t hunters;        // Hunters still in the house
+    uint16_t maxFear;        // Highest fear of the hunters still in the house
+    uint32_t fear;           // Total fear of the hunters still in the house
+    uint32_t boredom;        // Total boredom of the hunters still in the house
+    uint32_t roomEvidence;   // Pieces of evidence in all the rooms
+    uint8_t evidenceTypes;   // Distinct evidence types collected so far
+    int16_t ghostRoom;       // Id of the ghost's room
+};
+
+// Structure representing the samples of a hunt not yet written out, allocated once as the house is built
+struct SampleRing {
+    int start;                        // Slot of the oldest sample
+    int count;                        // Samples held
+    SampleType slots[SAMPLE_RING];    // The samples, from start round to start + count
+};
+
+// Structure representing the next-hop table of a map, shared by every house built from that map
+struct RouteTable {
+    uint64_t mapHash;       // Hash of the map, from hashHouseMap
+    int numRooms;           // Rooms in the map
+    int wide;               // C_TRUE if slots take a byte each, C_FALSE if two are packed per byte
+    uint8_t *hops;          // Slot in the connected rooms of the first step from one room to another, by target then source
+    RouteTableType *next;   // Next table in the process-wide cache
 };
 
 // Structure representing the thread data
@@ -187,7 +534,525 @@ struct ThreadData {
     HunterType *hunter; // Pointer to the hunter
 };
 
+// Structure representing what an agent decided to do in one action, before any of it touches shared state
+struct Intent {
+    int action;                  // enum AgentAction
+    RoomType *moveTo;            // Room to move to with ACT_MOVE, NULL to stay
+    enum EvidenceType evidence;  // Evidence the ghost leaves with ACT_EVIDENCE
+    int evidenceCount;           // Unique evidence a hunter found with ACT_REVIEW
+    int timed;                   // C_TRUE if the action was picked by the profiler's sampling
+    uint64_t ticks;              // Profiler clock ticks spent working out the details of a timed action
+};
+
+// Structure representing a hunt run by the lockstep engine: the decisions of the current tick and who is still acting
+struct Lockstep {
+    HouseType *house;             // The house of the hunt
+    GhostType *ghost;             // The ghost, which acts until it leaves
+    int ghostActive;              // C_TRUE while the ghost is in the house
+    IntentType ghostIntent;       // The ghost's decision this tick
+    IntentType *hunterIntents;    // Each hunter's decision this tick, indexed by id
+    char *huntersActive;          // C_TRUE for each hunter still in the house, indexed by id
+    int tick;                     // Ticks resolved so far
+    int done;                     // C_TRUE once the hunt is over, read by every thread after the second barrier
+    int numThreads;               // Threads deciding in parallel
+    pthread_barrier_t barrier;    // Separates the decide phase from the resolve phase of each tick
+};
+
+// Structure representing one thread of the lockstep engine
+struct LockstepWorker {
+    LockstepType *lockstep;  // The hunt being run
+    int index;               // Position of the thread, which picks the agents it decides for
+};
+
+// Structure representing an agent of the tasks engine, everything it needs between two of its actions
+struct AgentTask {
+    HuntTasksType *hunt;     // The hunt the agent acts in
+    HunterType *hunter;      // The hunter acting, NULL for the ghost
+    unsigned int random;     // The agent's random stream, carried from one pool thread to the next
+    long long wakeNanos;     // Monotonic time before which the agent does not act again, 0 to act as soon as possible
+    unsigned long long order; // When the task was queued, so tasks due at the same time are resumed first come, first served
+};
+
+// Structure representing a hunt running on the task pool
+struct HuntTasks {
+    HouseType *house;        // The house of the hunt
+    AgentTaskType *tasks;    // One task per hunter, by id, then the ghost's
+    int live;                // Tasks still acting, under the pool's lock
+    long long startNanos;    // When the hunt's tasks were queued
+};
+
+// Structure representing the pool of threads shared by every hunt of the tasks engine in a process
+struct TaskPool {
+    pthread_mutex_t lock;    // Guards the queue and every hunt's count of live tasks
+    pthread_cond_t ready;    // Signalled when a task is queued or the pool stops
+    pthread_cond_t finished; // Broadcast when the last task of a hunt finishes
+    AgentTaskType **queue;   // Tasks waiting to be resumed, a binary min-heap on wake time then order, so the root is due first
+    int queued;              // Tasks in the queue
+    int capacity;            // Tasks the queue can hold before it grows
+    unsigned long long queuedTotal; // Tasks ever queued, the order of the next one
+    pthread_t *threads;      // The pool's threads, NULL until the first hunt starts them
+    int numThreads;          // Threads in the pool
+    int stopping;            // C_TRUE once the pool is asked to stop
+};
+
+// Structure representing a room-owner thread of the actor engine and the rooms it acts in
+struct RoomOwner {
+    HouseType *house;  // Pointer to the house
+    RoomType **rooms;  // The rooms the owner acts in, no other thread touches them
+    int numRooms;      // Number of rooms the owner acts in
+    int index;         // Position of the owner, which picks its random stream
+};
+
+// Structure representing the runtime parameters of a hunt
+struct Config {
+    int hunters;      // Number of hunters placed in the van
+    int fearMax;      // Fear at which a hunter leaves
+    int boredomMax;   // Boredom at which a hunter or the ghost leaves
+    int actionDelay;  // Microseconds agents sleep between actions, 0 to run flat out
+    int engine;       // ENGINE_THREADS, ENGINE_ACTOR, ENGINE_LOCKSTEP or ENGINE_TASKS
+    int roomOwners;   // Room-owner threads in the actor engine
+    int stepThreads;  // Threads deciding in parallel in the lockstep engine, which never changes the outcome
+    int taskThreads;  // Threads of the pool running the tasks engine, set by the first hunt that starts the pool
+    int wake;         // WAKE_DELAY or WAKE_EVENT, how the threads engine paces its agents
+    int radio;        // C_TRUE to exchange evidence over modeled radios instead of a shared list
+    int radioLatency; // Actions of the receiver before a report that reached its radio can be used
+    int radioLoss;    // Percentage of reports lost on the air
+    int radioBandwidth; // Reports a hunter can take in per action
+    int radioInterval;  // Actions between a hunter's status reports, 0 to only report new evidence
+    int policy;       // POLICY_RANDOM or POLICY_DIRECTED
+    int gridWidth;    // Columns of a generated grid map, 0 for the original house
+    int gridHeight;   // Rows of a generated grid map, 0 for the original house
+    int evidenceCap;    // Most pieces of evidence a room holds, in all or of each type depending on the policy
+    int evidencePolicy; // EVIDENCE_OLDEST or EVIDENCE_COALESCE
+    int samplePeriod;   // Ghost ticks between samples of the hunt's state, 0 to not sample
+    int sampleStream;   // C_TRUE to write a full sample ring out during the hunt, C_FALSE to keep its latest samples until the end
+};
+
+// Structure representing the compact outcome of one hunt, as sent back by sweep workers
+struct HuntResult {
+    uint32_t seed;              // Seed the hunt was simulated with
+    uint32_t ticks;             // Ghost ticks until the outcome was decided
+    uint16_t exitedFear;        // Hunters that left because of fear
+    uint16_t exitedBoredom;     // Hunters that left because of boredom
+    uint16_t evidenceCollected; // Pieces of evidence the hunters shared
+    uint8_t outcome;            // enum HuntState when the hunt ended
+    uint8_t ghostClass;         // Real class of the ghost
+    uint8_t identifiedClass;    // Class matched from the evidence, GH_UNKNOWN if insufficient
+    uint8_t cached;             // C_TRUE if the result came from the result cache
+    uint32_t micros;            // Wall-clock microseconds the hunt took to simulate
+    uint32_t radioSent;         // Radio reports put on the air
+    uint32_t radioLost;         // Radio reports lost on the air
+    uint32_t radioDelivered;    // Radio reports taken in by their receiver
+    uint32_t radioLatency;      // Actions the delivered reports waited in total
+    uint32_t radioWaitMicros;   // Microseconds the delivered reports took to be taken in, in total
+};
+
+// Structure representing the merged outcomes of a sweep
+struct SweepSummary {
+    long long runs;         // Hunts simulated
+    long long hunterWins;   // Hunts the hunters won
+    long long ghostWins;    // Hunts the ghost won
+    long long cancelled;    // Hunts cancelled before they were decided
+    long long identified;   // Hunts with enough evidence to match a ghost
+    long long correct;      // Hunts where the matched ghost was the real one
+    long long ticks;        // Ghost ticks over every hunt
+    long long failed;       // Seeds given up on after their shard crashed SHARD_ATTEMPTS times
+    long long cached;       // Hunts answered from the result cache instead of simulated
+    long long micros;       // Wall-clock microseconds spent simulating
+    long long radioSent;    // Radio reports put on the air
+    long long radioLost;    // Radio reports lost on the air
+    long long radioDelivered;  // Radio reports taken in by their receiver
+    long long radioLatency;    // Actions the delivered reports waited in total
+    long long radioWaitMicros; // Microseconds the delivered reports took to be taken in, in total
+};
+
+// Structure representing the header at the start of a result cache file
+struct CacheHeader {
+    uint32_t magic;      // CACHE_MAGIC
+    uint32_t version;    // CACHE_VERSION of the file layout
+    uint32_t recordSize; // Size of each record, as a guard against layout changes
+    uint32_t reserved;   // Unused, keeps the records 16-byte aligned
+};
+
+// Structure representing one finished hunt in a result cache file
+struct CacheRecord {
+    uint64_t key;          // Hash of the simulator version, map, runtime parameters and seed
+    HuntResultType result; // Outcome of the hunt
+    uint32_t check;        // Checksum of the key and result, so torn appends are skipped
+};
+
+// Structure representing an open result cache: the mapped file and an in-memory index over it
+struct Cache {
+    int fd;                          // The cache file, opened for appending
+    void *map;                       // The file mapped read-only, NULL before anything is mapped
+    size_t mapped;                   // Bytes mapped
+    const CacheRecordType *records;  // The records, following the header in the mapping
+    long long scanned;               // Records checked and indexed so far
+    uint32_t *index;                 // Open-addressing table of record numbers plus one, 0 when empty
+    long long capacity;              // Slots in the index, a power of two
+    long long indexed;               // Records in the index
+    uint64_t mapHash;                // Hash of the map the hunts are simulated on
+    long long hits;                  // Lookups answered from the cache
+    long long misses;                // Lookups that had to be simulated
+};
+
+// Structure representing the header at the start of a columnar results file
+struct ResultsHeader {
+    uint32_t magic;      // RESULTS_MAGIC
+    uint32_t version;    // RESULTS_VERSION of the file layout
+    uint32_t simVersion; // SIM_VERSION of the simulator that created the file
+    uint32_t reserved;   // Unused, keeps the chunks 8-byte aligned
+};
+
+// Structure representing the header of one chunk of a results file, followed by its columns:
+// seed and ticks (uint32_t), exits by fear, exits by boredom and evidence (uint16_t), outcome, ghost class and identified class (uint8_t)
+struct ChunkHeader {
+    uint32_t magic;  // CHUNK_MAGIC
+    uint32_t count;  // Hunts in the chunk, the length of every column
+    uint32_t size;   // Bytes of the whole chunk, header and padding included
+    uint32_t writer; // Process id of the writer that appended the chunk
+};
+
+// Structure representing one process's writer of a results file, buffering a chunk column by column
+struct ResultsWriter {
+    int fd;                                  // The results file, opened for appending
+    int count;                               // Hunts buffered
+    uint32_t seed[RESULTS_CHUNK];            // Seed of each hunt
+    uint32_t ticks[RESULTS_CHUNK];           // Ghost ticks until each outcome was decided
+    uint16_t exitedFear[RESULTS_CHUNK];      // Hunters that left because of fear
+    uint16_t exitedBoredom[RESULTS_CHUNK];   // Hunters that left because of boredom
+    uint16_t evidence[RESULTS_CHUNK];        // Pieces of evidence the hunters shared
+    uint8_t outcome[RESULTS_CHUNK];          // enum HuntState when each hunt ended
+    uint8_t ghostClass[RESULTS_CHUNK];       // Real class of each ghost
+    uint8_t identifiedClass[RESULTS_CHUNK];  // Class matched from the evidence, GH_UNKNOWN if insufficient
+};
+
+// Structure representing the columns of one chunk, pointing into a mapped results file
+struct ResultsColumns {
+    size_t count;                     // Hunts in the chunk
+    uint32_t writer;                  // Process id of the writer that appended the chunk
+    const uint32_t *seed;             // Seed of each hunt
+    const uint32_t *ticks;            // Ghost ticks until each outcome was decided
+    const uint16_t *exitedFear;       // Hunters that left because of fear
+    const uint16_t *exitedBoredom;    // Hunters that left because of boredom
+    const uint16_t *evidence;         // Pieces of evidence the hunters shared
+    const uint8_t *outcome;           // enum HuntState when each hunt ended
+    const uint8_t *ghostClass;        // Real class of each ghost
+    const uint8_t *identifiedClass;   // Class matched from the evidence, GH_UNKNOWN if insufficient
+};
+
+// Structure representing the totals over every hunt of a results file, each gathered from its own columns
+struct ResultsSummary {
+    long long hunts;                     // Hunts in the file
+    long long chunks;                    // Chunks the hunts were appended in
+    long long hunterWins;                // Hunts the hunters won
+    long long ghostWins;                 // Hunts the ghost won
+    long long identified;                // Hunts with enough evidence to match a ghost
+    long long correct;                   // Hunts where the matched ghost was the real one
+    long long ticks;                     // Ghost ticks over every hunt
+    unsigned int minTicks;               // Shortest hunt in ticks
+    unsigned int maxTicks;               // Longest hunt in ticks
+    long long exitedFear;                // Hunters that left because of fear, over every hunt
+    long long exitedBoredom;             // Hunters that left because of boredom, over every hunt
+    long long evidence;                  // Pieces of evidence shared, over every hunt
+    long long classHunts[GHOST_COUNT];   // Hunts against each ghost class
+    long long classWins[GHOST_COUNT];    // Hunts the hunters won against each ghost class
+    long long classCorrect[GHOST_COUNT]; // Hunts each ghost class was matched correctly
+};
+
+// Structure representing a fixed-size histogram of non-negative values, with log-linear buckets in the manner of an HDR histogram
+struct Histogram {
+    long long count;                    // Values counted
+    long long sum;                      // Sum of the values counted
+    uint32_t min;                       // Smallest value counted, only meaningful once count is above 0
+    uint32_t max;                       // Largest value counted
+    long long counts[HIST_BUCKETS];     // Values counted in each bucket
+};
+
+// Structure representing the distributions of a batch or of one sweep worker, the same size whatever the number of hunts
+struct Distributions {
+    long long hunts;                          // Simulated hunts counted, cached and cancelled hunts are left out
+    HistogramType histograms[DIST_COUNT];     // One histogram per enum Distribution
+};
+
+// Structure representing the activity counters of one room in one house, alone on its cache line
+struct RoomHeat {
+    _Alignas(CACHE_LINE) atomic_int counts[HEAT_COUNT]; // One counter per enum HeatCounter
+};
+
+// Structure representing the per-room activity of a batch or of one sweep worker, added up hunt by hunt
+struct Heatmap {
+    long long hunts;                                // Hunts added, cached and cancelled hunts are left out
+    int numRooms;                                   // Rooms of the map, 0 until a hunt is added
+    long long counts[ROUTE_MAX_ROOMS][HEAT_COUNT];  // Counters of each room, indexed by room id then enum HeatCounter
+    int peak[ROUTE_MAX_ROOMS];                      // Most pieces of evidence each room held at once in any hunt
+};
+
+// Structure representing the sampled durations of one phase of the agents' actions
+struct PhaseProfile {
+    long long count;                     // Samples taken
+    long long ticks;                     // Clock ticks over every sample
+    long long buckets[PROFILE_BUCKETS];  // Samples by duration, bucket b holding 2^b to 2^(b+1) - 1 ticks
+};
+
+// Structure representing the profile of a process or of one sweep worker slot
+struct Profile {
+    int period;                          // One phase in this many is timed
+    long long startNanos;                // Monotonic nanoseconds when profiling started, to convert ticks to time
+    uint64_t startClock;                 // Profiler clock when profiling started
+    PhaseProfileType phases[PROF_COUNT]; // One per enum ProfilePhase, merged from every thread
+};
+
+// Structure representing a contiguous range of seeds handed to one sweep worker
+struct Shard {
+    unsigned int firstSeed; // First seed of the range
+    int count;              // Number of seeds in the range
+    int attempts;           // Times the range has been handed out, including this one
+    int merged;             // Leading seeds already counted from an earlier attempt, simulated again but not counted twice
+    ConfigType config;      // Runtime parameters to simulate every seed with
+};
+
+// Structure representing a sweep worker process, as seen by the coordinator
+struct Worker {
+    pid_t pid;                              // Process id of the worker
+    int fd;                                 // Coordinator end of the socket to the worker
+    int busy;                               // C_TRUE while the worker holds a shard
+    ShardType shard;                        // Shard the worker is simulating
+    int received;                           // Results received so far for the shard
+    char buffer[sizeof(HuntResultType)];    // Partially received result
+    int buffered;                           // Bytes in the buffer
+    int node;                               // NUMA node the worker is placed on, -1 if unplaced
+    int cpu;                                // CPU the worker is pinned to, -1 if pinned to its whole node or unplaced
+    DistributionsType *distributions;       // The slot's distributions of its current shard, in memory shared with the coordinator
+    HeatmapType *heatmap;                   // The slot's room activity of its current shard, shared the same way, NULL unless asked for
+    ProfileType *profile;                   // The slot's phase timings, shared the same way, NULL unless profiling
+};
+
+// Structure representing the CPUs and NUMA nodes the process may run on
+struct Topology {
+    int numNodes;                          // Nodes with at least one usable CPU, 1 on machines without NUMA
+    int nodeIds[TOPOLOGY_MAX_NODES];       // Kernel id of each node
+    int firstCpu[TOPOLOGY_MAX_NODES];      // Position of each node's first CPU in cpus
+    int numCpus[TOPOLOGY_MAX_NODES];       // Usable CPUs of each node
+    int cpus[TOPOLOGY_MAX_CPUS];           // Every usable CPU, grouped by node
+    int totalCpus;                         // Usable CPUs in all
+};
+
+// Structure representing the shared-memory metrics file, mapped by the simulator and by fp-top
+struct Metrics {
+    unsigned int magic;                // METRICS_MAGIC once the file is initialized
+    unsigned int version;              // METRICS_VERSION of the writer
+    int pid;                           // Process id of the writing simulator
+    int counterCount;                  // Number of counters, MET_COUNT of the writer
+    long long startTime;               // Time the simulator started publishing
+    atomic_llong counters[MET_COUNT];  // Counters, indexed by enum MetricCounter
+};
+
+// Structure representing one timed repetition of a microbenchmark in fp-bench
+struct BenchSample {
+    long long nanos;   // Wall-clock nanoseconds the repetition took
+    long long cycles;  // Time stamp counter ticks it took, 0 where there is no counter
+};
+
+// Structure representing a microbenchmark in fp-bench: one primitive, run over several sizes of its input
+struct BenchCase {
+    const char *name;                                     // Primitive measured
+    const char *sizeName;                                 // What the size is, e.g. the list length or the room degree
+    int sizes[4];                                         // Sizes to run, 0 ending the list early
+    void (*run)(int size, int ops, BenchSampleType *sample); // Builds an input of the size, then times ops operations on it
+};
+
+// Structure representing a fixed-seed hunt scenario of fp-bench, timed whole to track regressions between commits
+struct BenchScenario {
+    const char *name;  // Name of the scenario in the baselines file
+    int engine;        // ENGINE_LOCKSTEP or ENGINE_ACTOR, with one thread so each seed always plays the same hunt
+    int gridWidth;     // Columns of the grid map, 0 for the original house
+    int gridHeight;    // Rows of the grid map, 0 for the original house
+    int policy;        // POLICY_RANDOM or POLICY_DIRECTED
+    int radio;         // C_TRUE to exchange evidence over radios
+};
+
+// Structure representing the measures of a scenario, one sample per timed repetition
+struct ScenarioRun {
+    int reps;                                   // Repetitions timed
+    double samples[SCENARIO_METRICS][BASELINE_MAX_REPS]; // Samples, indexed by enum ScenarioMetric then repetition
+};
+
+// Structure representing a hunt of the embeddable library, see spectrahunter.h
+struct SpectraHunt {
+    ConfigType next;                // Runtime parameters the next reset builds the house with
+    ConfigType config;              // Runtime parameters of the current house, which points to them
+    char hunterNames[MAX_ARR][MAX_STR]; // Names of the hunters added, in id order
+    int numHunters;                 // Hunters added
+    HouseType house;                // The house of the current hunt
+    LockstepType lockstep;          // The current hunt, stepped one tick at a time on the caller's thread
+    int built;                      // C_TRUE once a reset built the house
+};
+
+// Structure representing a job submitted to fp-daemon: a hunt, or a sweep of consecutive seeds
+struct DaemonJob {
+    ConfigType config;      // Runtime parameters of every hunt, the daemon's own with the job's options applied
+    unsigned int seed;      // Seed of the first hunt
+    int runs;               // Hunts to simulate, 1 for a single hunt
+    long long submitNanos;  // Monotonic time the job line was read, its latencies count from
+};
+
+// Structure representing fp-daemon: its socket, its warm worker threads, and the connections waiting for one of them
+struct Daemon {
+    int listenFd;                    // The listening Unix domain socket
+    const ConfigType *defaults;      // Runtime parameters jobs start from
+    MetricsType *metrics;            // Metrics every hunt publishes into, may be NULL
+    volatile sig_atomic_t *stop;     // Set by a signal to stop serving
+    int stopping;                    // C_TRUE once the worker threads should return
+    int numThreads;                  // Worker threads
+    pthread_t *threads;              // The worker threads
+    int *serving;                    // Connection each worker thread serves, -1 if idle, to be shut down on stopping
+    pthread_mutex_t lock;            // Protects everything below, stopping and serving
+    pthread_cond_t ready;            // Signaled when a connection is queued or the daemon stops
+    int pending[DAEMON_BACKLOG];     // Accepted connections waiting for a worker thread, a ring
+    int head;                        // Oldest waiting connection in the ring
+    int count;                       // Waiting connections
+    long long jobs;                  // Jobs finished
+    long long hunts;                 // Hunts simulated for them
+    HistogramType firstLatency;      // Microseconds from a job's submission to its first result
+    HistogramType latency;           // Microseconds from a job's submission to its last result
+};
+
+// Structure representing the command line options
+struct Options {
+    int runs;            // Number of hunts to simulate, more than one runs unattended in batch mode
+    char *metricsPath;   // File to publish live metrics into, NULL if disabled
+    unsigned int seed;   // Seed of the first hunt, each further hunt uses the next seed
+    int workers;         // Worker processes to shard the runs over, 0 to simulate in this process
+    int shardSize;       // Seeds handed to a worker at a time
+    double ciWidth;      // Stop once every metric's confidence interval is narrower than this, 0 to run every hunt
+    int ciMetrics;       // Metrics that must converge, a mask of CI_GHOST_WIN and CI_ACCURACY
+    char *cachePath;     // Result cache to reuse and extend, NULL if disabled
+    char *resultsPath;   // Columnar results file every finished hunt is appended to, NULL if disabled
+    int affinity;        // How worker processes are placed: AFFINITY_NONE, AFFINITY_NODE or AFFINITY_CORE
+    int heatmap;         // C_TRUE to add up and print the activity of every room
+    int profile;         // Time one in this many phases of the agents' actions, 0 to not profile
+    char *samplesPath;   // File every hunt's samples are appended to as CSV, NULL if disabled
+    ConfigType config;   // Runtime parameters of every hunt
+};
+
+// Runtime log filters: categories enabled, one bit per LogCategory, and how many events of each category make one logged
+extern unsigned int logMask;
+extern unsigned int logSample[LOG_CATEGORY_COUNT];
+// Events of each category seen by the calling thread, for sampling
+extern __thread unsigned int logSeen[LOG_CATEGORY_COUNT];
+
+/*
+    Checks whether an event of a category should be logged: enabled, and the 1 in N picked by sampling.
+    Inlined at every call site through LOG, so filtered events cost a mask test and no argument work.
+        in: category - the category of the event
+        return: C_TRUE if the event should be logged, C_FALSE otherwise
+*/
+static inline int logEnabled(enum LogCategory category) {
+    if (!LOGGING || (logMask & (1u << category)) == 0) {
+        return C_FALSE;
+    }
+    return logSample[category] <= 1 || ++logSeen[category] % logSample[category] == 0;
+}
+
+// Logs an event by making the call, only once its category passes the filters
+#define LOG(category, call) do { if (logEnabled(category)) { call; } } while (0)
+
+/*
+    Adds to a metrics counter with a single relaxed atomic, doing nothing when metrics are disabled.
+        in: metrics - the metrics to update, may be NULL
+        in: counter - the counter to update
+        in: amount - the amount to add, negative for gauges going down
+*/
+static inline void metricsAdd(MetricsType *metrics, enum MetricCounter counter, long long amount) {
+    if (metrics != NULL) {
+        atomic_fetch_add_explicit(&metrics->counters[counter], amount, memory_order_relaxed);
+    }
+}
+
+/*
+    Counts one event in a room of a house with a single relaxed atomic, doing nothing unless the house tracks room activity.
+    Each room's counters fill a cache line of their own, so agents in different rooms never contend.
+        in: house - the house of the room
+        in: room - the room the event happened in
+        in: counter - the counter to update
+*/
+static inline void heatAdd(HouseType *house, const RoomType *room, enum HeatCounter counter) {
+    if (house->heat != NULL) {
+        atomic_fetch_add_explicit(&house->heat[room->id].counts[counter], 1, memory_order_relaxed);
+    }
+}
+
+void takeSample(HouseType *house, int tick);
+
+/*
+    Counts a tick of the ghost, and samples the hunt's state every config->samplePeriod ticks when sampling. Called by
+    whichever thread acts for the ghost, before it acts, so the ghost's own state is never read from another thread.
+        in: house - the house of the hunt
+*/
+static inline void countTick(HouseType *house) {
+    int tick = atomic_fetch_add_explicit(&house->ticks, 1, memory_order_relaxed) + 1;
+    metricsAdd(house->metrics, MET_TICKS, 1);
+    if (house->samples != NULL && tick % house->config->samplePeriod == 0) {
+        takeSample(house, tick);
+    }
+}
+
+// Profile the agents' actions are timed into, NULL when not profiling
+extern ProfileType *profile;
+// Phases the calling thread has come to since it last took a sample
+extern __thread unsigned int profileGap;
+unsigned int nextProfileGap();
+
+/*
+    Reads the profiler's clock: the time stamp counter on x86, which costs a few nanoseconds, and the monotonic clock elsewhere.
+        return: the clock, in ticks
+*/
+static inline uint64_t profileClock() {
+#if defined(__x86_64__) || defined(__i386__)
+    return __rdtsc();
+#else
+    struct timespec now;
+    clock_gettime(CLOCK_MONOTONIC, &now);
+    return (uint64_t)now.tv_sec * 1000000000ULL + now.tv_nsec;
+#endif
+}
+
+/*
+    Starts timing a phase, when profiling and when sampling picks it, one phase in profile->period on average.
+        return: the clock at the start of the phase, 0 when it is not timed
+*/
+static inline uint64_t profileStart() {
+    if (profile == NULL) {
+        return 0;
+    }
+    if (profileGap > 1) {
+        profileGap--;
+        return 0;
+    }
+    profileGap = nextProfileGap();
+    return profileClock();
+}
+
+void recordPhase(enum ProfilePhase phase, uint64_t ticks);
+
+/*
+    Stops timing a phase, recording its duration in the calling thread's profile.
+        in: phase - the phase timed
+        in: start - what profileStart returned, 0 when the phase is not timed
+*/
+static inline void profileStop(enum ProfilePhase phase, uint64_t start) {
+    if (start != 0) {
+        recordPhase(phase, profileClock() - start);
+    }
+}
+
 int randInt(int, int);                            // Pseudo-random number generator function
+void seedRandom(unsigned int seed);               // Seed the calling thread's random stream
+unsigned int randomState();                       // The calling thread's random stream, to carry it to another thread
+unsigned int deriveSeed(unsigned int seed, int stream); // Derive an independent stream seed from a hunt seed
+uint64_t hashBytes(uint64_t hash, const void *data, size_t size); // Continue an FNV-1a hash over some bytes
+long long monotonicNanos();                       // Nanoseconds on the monotonic clock
 float randFloat(float, float);                    // Pseudo-random float generator function
 enum GhostClass randomGhost();                    // Return a randomly selected a ghost type
 void ghostToString(enum GhostClass, char *);      // Convert a ghost type to a string, stored in output paremeter
@@ -203,43 +1068,189 @@ void l_ghostInit(enum GhostClass type, char *room);
 void l_ghostMove(char *room);
 void l_ghostEvidence(enum EvidenceType evidence, char *room);
 void l_ghostExit(enum LoggerDetails reason);
+int parseLogSpec(const char *spec);
 
 // House Initialization and Management Functions
 void initHouse(HouseType *house);
+size_t houseFootprint(const HouseType *house);
 RoomType *createRoom(char *name);
 void connectRooms(RoomType *room1, RoomType *room2);
-void initHunterAndPlaceInVan(RoomType *vanRoom, char *name);
+HunterType *initHunterAndPlaceInVan(HouseType *house, char *name);
 void initAndPlaceGhostRandomly(HouseType *house);
 void populateRooms(HouseType *house);
+void populateGrid(HouseType *house, int width, int height);
 void addRoom(RoomListType *list, RoomType *r);
 GhostType *createGhost(GhostType **ghost, int id, GhostClass ghostType, RoomType *room);
-HunterType *createHunter(char *name, RoomType *room);
-void createThreads(HouseType *house, char hunterNames[][MAX_STR], int numHunters);
-void performHunterAction(HouseType *house, HunterType *hunter);
-void performGhostAction(HouseType *house);
+HunterType *createHunter(HunterRegistryType *registry, char *name, RoomType *room);
+void createThreads(HouseType *house);
+int performHunterAction(HouseType *house, HunterType *hunter);
+int performGhostAction(HouseType *house);
+int stepHunter(HouseType *house, HunterType *hunter, RoomType **moveTo);
+int stepGhost(HouseType *house, GhostType *ghost, RoomType *currentRoom, RoomType **moveTo);
+void decideHunter(HouseType *house, HunterType *hunter, IntentType *intent);
+int applyHunter(HouseType *house, HunterType *hunter, const IntentType *intent, RoomType **moveTo);
+void decideGhost(HouseType *house, GhostType *ghost, RoomType *currentRoom, IntentType *intent);
+int applyGhost(HouseType *house, GhostType *ghost, RoomType *currentRoom, const IntentType *intent, RoomType **moveTo);
+void initLockstep(LockstepType *lockstep, HouseType *house, int numThreads);
+int stepLockstep(LockstepType *lockstep);
+void cleanLockstep(LockstepType *lockstep);
+void runLockstep(HouseType *house);
+void simulateHunt(HouseType *house);
+void runRoomActors(HouseType *house);
+void startHuntTasks(HouseType *house, HuntTasksType *hunt);
+void waitHuntTasks(HuntTasksType *hunt);
+void runTasks(HouseType *house);
+void stopTasks();
+void pauseAgent(HouseType *house);
+void parkHunter(HouseType *house, HunterType *hunter);
+int endHunt(HouseType *house, enum HuntState outcome);
+int isHuntOver(HouseType *house);
+void cancelHunt(HouseType *house);
+void hunterExited(HouseType *house, int withEvidence);
+void huntersStopped(HouseType *house);
 
 // Hunter and Ghost Manipulation Functions
 void insertAtHeadHunter(HunterListType *list, HunterType *newHunter);
 void insertAtHeadEvidence(EvidenceListType *list, enum EvidenceType newEvidence);
 void removeHunterFromRoom(RoomType *room, HunterType *hunter);
 void moveHunterToRandomRoom(HunterType *hunter, RoomType *currentRoom);
+void moveHunterToRoom(HunterType *hunter, RoomType *currentRoom, RoomType *newRoom);
+void moveGhostToRoom(GhostType *ghost, RoomType *currentRoom, RoomType *newRoom);
+RoomType *pickConnectedRoom(RoomType *room);
 void removeEvidence(EvidenceListType *list, enum EvidenceType targetEvidence);
+int leaveEvidence(RoomEvidenceType *evidence, enum EvidenceType type, const ConfigType *config);
+int takeEvidence(RoomEvidenceType *evidence, enum EvidenceType type);
 void moveGhostToRandomRoom(GhostType *ghost, RoomType *currentRoom);
-void removeHunterFromHouse(HouseType *house, HunterType *hunter);
 void collectEvidence(HouseType *house, HunterType *hunter, RoomType *currentRoom);
+void lockRoom(RoomType *room, MetricsType *metrics);
+void signalRoom(RoomType *room);
+void signalHouse(HouseType *house);
+
+// Hunter registry
+void initRegistry(HunterRegistryType *registry, int capacity);
+HunterType *registerHunter(HunterRegistryType *registry, const char *name);
+HunterType *findHunterByName(const HouseType *house, const char *name);
+void cleanRegistry(HunterRegistryType *registry);
+
+// Mailboxes for the actor engine
+void initMailbox(MailboxType *mailbox);
+void postMail(MailboxType *mailbox, MailNodeType *node);
+MailNodeType *takeMail(MailboxType *mailbox);
+
+// Next-hop tables and movement policies
+void buildRoutes(HouseType *house);
+void cleanRouteCache();
+RoomType *nextHop(HouseType *house, RoomType *from, int to);
+RoomType *fleeFrom(HouseType *house, RoomType *from, int threat);
+RoomType *chooseHunterMove(HouseType *house, HunterType *hunter);
+RoomType *chooseGhostMove(HouseType *house, RoomType *room);
+
+// Radio network between hunters
+void setupRadios(HouseType *house);
+void cleanRadios(HouseType *house);
+void broadcastReport(HouseType *house, RadioType *radio);
+void runRadio(HouseType *house, RadioType *radio);
+void printRadio(long long sent, long long lost, long long delivered, long long latency, long long waitMicros, long long micros);
 
 // Evidence and Investigation Functions
 int reviewEvidence(HouseType *house);
+int reviewHunterEvidence(HouseType *house, HunterType *hunter);
 int isHunterPresent(RoomType *room);
 GhostClass getGhostMatch(HouseType *house);
 GhostType *getGhostInHouse(HouseType *house);
-HunterType *findHunterByName(const HouseType *house, const char *name);
+uint64_t hashHouseMap(HouseType *house);
+uint64_t defaultMapHash();
 EvidenceType randomEvidence(enum GhostClass ghostType);
 void printHouse(HouseType *house);
+int parseOptions(int argc, char *argv[], OptionsType *options);
+void readHunterNames(char hunterNames[][MAX_STR], int numHunters);
+void handleInterrupt(int signal);
+
+// Batch and sweep functions
+void initConfig(ConfigType *config);
+int parseConfigOption(ConfigType *config, const char *option, const char *value);
+int validConfig(const ConfigType *config);
+void nameHunters(char hunterNames[][MAX_STR], int numHunters);
+void setupHunt(HouseType *house, const ConfigType *config, unsigned int seed, char hunterNames[][MAX_STR], MetricsType *metrics);
+void summarizeHunt(HouseType *house, HuntResultType *result);
+int prepareHunt(const ConfigType *config, unsigned int seed, MetricsType *metrics, CacheType *cache, HeatmapType *heatmap,
+                HouseType *house, uint64_t *key, HuntResultType *result);
+void concludeHunt(HouseType *house, MetricsType *metrics, CacheType *cache, uint64_t key, DistributionsType *distributions,
+                  HeatmapType *heatmap, HuntResultType *result);
+void runHunt(const ConfigType *config, unsigned int seed, MetricsType *metrics, CacheType *cache, DistributionsType *distributions,
+             HeatmapType *heatmap, HuntResultType *result);
+void initSweepSummary(SweepSummaryType *summary);
+void addHuntResult(SweepSummaryType *summary, const HuntResultType *result);
+void printSweepSummary(const SweepSummaryType *summary);
+void wilsonInterval(long long successes, long long trials, double *low, double *high);
+void estimateMetric(const SweepSummaryType *summary, int metric, long long *successes, long long *trials);
+int sweepConverged(const SweepSummaryType *summary, double width, int metrics);
+void printEstimates(const SweepSummaryType *summary);
+int runCoordinator(const OptionsType *options, MetricsType *metrics, volatile sig_atomic_t *stop, SweepSummaryType *summary,
+                   DistributionsType *distributions, HeatmapType *heatmap);
+int spawnWorker(WorkerType *worker, WorkerType workers[], int numWorkers, MetricsType *metrics, const char *cachePath,
+                const char *resultsPath, const TopologyType *topology);
+void workerLoop(int fd, MetricsType *metrics, CacheType *cache, ResultsWriterType *results, DistributionsType *distributions,
+                HeatmapType *heatmap);
+
+// Streaming histograms of hunt metrics
+void recordValue(HistogramType *histogram, uint32_t value);
+uint32_t valueAtPercentile(const HistogramType *histogram, double percentile);
+void mergeHistogram(HistogramType *into, const HistogramType *from);
+void recordHunt(DistributionsType *distributions, HouseType *house);
+void mergeDistributions(DistributionsType *into, const DistributionsType *from);
+void printDistributions(const DistributionsType *distributions);
+
+// Profiling of the agents' actions
+void startProfile(ProfileType *target, int period);
+void flushProfile();
+void mergeProfile(ProfileType *into, const ProfileType *from);
+void printProfile(const ProfileType *target);
+
+// Time series of a hunt's state
+int openSamples(const char *path);
+void closeSamples();
+void startSamples(HouseType *house);
+void writeSamples(HouseType *house);
+
+// Per-room activity
+void trackHeat(HouseType *house);
+void addHeat(HeatmapType *heatmap, HouseType *house);
+void mergeHeatmap(HeatmapType *into, const HeatmapType *from);
+void printHeatmap(const HeatmapType *heatmap, const ConfigType *config);
+
+// CPU and NUMA placement of worker processes
+void readTopology(TopologyType *topology);
+void planPlacement(const TopologyType *topology, int affinity, WorkerType workers[], int numWorkers);
+void applyPlacement(const TopologyType *topology, const WorkerType *worker);
+void printTopology(const TopologyType *topology, int affinity, const WorkerType workers[], int numWorkers);
+
+// Result cache
+CacheType *openCache(const char *path);
+void closeCache(CacheType *cache);
+uint64_t cacheKey(const ConfigType *config, uint64_t mapHash, unsigned int seed);
+int lookupCache(CacheType *cache, uint64_t key, HuntResultType *result);
+void storeCache(CacheType *cache, uint64_t key, const HuntResultType *result);
+ResultsWriterType *openResults(const char *path);
+void addResult(ResultsWriterType *writer, const HuntResultType *result);
+int flushResults(ResultsWriterType *writer);
+void closeResults(ResultsWriterType *writer);
+int readChunk(const void *map, size_t size, size_t *offset, ResultsColumnsType *columns);
 
 // Functions for cleanup
 void cleanHunterList(HunterListType *list);
 void cleanRoom(RoomType *room);
 void cleanRoomList(RoomListType *list);
 void cleanEvidenceList(EvidenceListType *list);
-void cleanHouse(HouseType *house);
\ No newline at end of file
+void cleanRoomEvidence(RoomEvidenceType *evidence);
+void cleanHouse(HouseType *house);
+
+// Live metrics
+MetricsType *openMetrics(const char *path);
+MetricsType *attachMetrics(const char *path);
+void closeMetrics(MetricsType *metrics);
+const char *metricName(enum MetricCounter counter);
+// Regression scenarios of fp-bench
+void runScenario(const BenchScenarioType *scenario, int reps, ScenarioRunType *run);
+int recordBaseline(const char *path, const char *commit, const char *scenario, const ScenarioRunType *run);
+int compareBaseline(const char *path, const char *against, const char *scenario, const ScenarioRunType *run, double threshold);
@@ -134,6 +134,89 @@ void removeEvidence(EvidenceListType *list, enum EvidenceType targetEvidence)
 }
 
 
+/*
+    Function: leaveEvidence
+    Purpose: Leaves a piece of evidence in a room, which never holds more than the hunt's cap. When the room is full, the
+        oldest piece is forgotten to make space (EVIDENCE_OLDEST), or the new piece is merged into the capped count of its
+        type (EVIDENCE_COALESCE).
+    Params:
+        Input:
+            RoomEvidenceType *evidence (in/out) - the evidence of the room
+            enum EvidenceType type (in) - the evidence to leave
+            const ConfigType *config (in) - the hunt's parameters, with the cap and the policy
+        Output: int - C_TRUE if the room holds one more piece, C_FALSE if a piece was forgotten or merged instead
+*/
+int leaveEvidence(RoomEvidenceType *evidence, enum EvidenceType type, const ConfigType *config) {
+    int cap = config->evidenceCap;
+    if (config->evidencePolicy == EVIDENCE_COALESCE) {
+        // A type at the cap takes no more, the piece is only merged into the count
+        if (evidence->counts[type] >= cap) {
+            evidence->discarded++;
+            return C_FALSE;
+        }
+        evidence->counts[type]++;
+        evidence->count++;
+        evidence->peak = evidence->count > evidence->peak ? evidence->count : evidence->peak;
+        return C_TRUE;
+    }
+
+    // The ring is only allocated in rooms the ghost actually leaves evidence in
+    if (evidence->ring == NULL) {
+        evidence->ring = malloc(cap);
+        evidence->capacity = cap;
+    }
+    int kept = C_TRUE;
+    if (evidence->count == cap) {
+        // Forget the oldest piece
+        evidence->counts[evidence->ring[evidence->start]]--;
+        evidence->start = (evidence->start + 1) % cap;
+        evidence->count--;
+        evidence->discarded++;
+        kept = C_FALSE;
+    }
+    evidence->ring[(evidence->start + evidence->count) % cap] = type;
+    evidence->counts[type]++;
+    evidence->count++;
+    evidence->peak = evidence->count > evidence->peak ? evidence->count : evidence->peak;
+    return kept;
+}
+
+
+/*
+    Function: takeEvidence
+    Purpose: Takes the newest piece of a type out of a room, as a hunter collecting it does.
+    Params:
+        Input:
+            RoomEvidenceType *evidence (in/out) - the evidence of the room
+            enum EvidenceType type (in) - the evidence to take
+        Output: int - C_TRUE if a piece was taken, C_FALSE if the room has none of that type
+*/
+int takeEvidence(RoomEvidenceType *evidence, enum EvidenceType type) {
+    if (evidence->counts[type] == 0) {
+        return C_FALSE;
+    }
+    evidence->counts[type]--;
+    evidence->count--;
+    if (evidence->ring == NULL) {
+        return C_TRUE;
+    }
+
+    // Find the newest piece of the type, and close the gap with the pieces left after it
+    int cap = evidence->capacity;
+    int newest = (evidence->start + evidence->count) % cap;
+    int slot = newest;
+    while (evidence->ring[slot] != type) {
+        slot = slot == 0 ? cap - 1 : slot - 1;
+    }
+    while (slot != newest) {
+        int next = slot + 1 == cap ? 0 : slot + 1;
+        evidence->ring[slot] = evidence->ring[next];
+        slot = next;
+    }
+    return C_TRUE;
+}
+
+
 /*
     Function: reviewEvidence
     Purpose: Reviews the shared evidence in the house and counts the unique evidences.
@@ -146,10 +229,12 @@ int reviewEvidence(HouseType *house) {
     // Initialize the count of unique evidences
     int uniqueEvidenceCount = 0;
     // Initialize an array to store the checked evidences
-    EvidenceType checkedEvidence[3];
+    EvidenceType checkedEvidence[EV_COUNT];
+    // Entries below the count never change, and the count is published after its entry, so no lock is needed
+    int evidenceCount = __atomic_load_n(&house->sharedEvidenceCount, __ATOMIC_ACQUIRE);
 
     // Loop for each piece of shared evidence
-    for (int i = 0; i < house->sharedEvidenceCount; i++) {
+    for (int i = 0; i < evidenceCount; i++) {
         // Get the current evidence
         EvidenceType currentEvidence = house->sharedEvidence[i];
 
@@ -174,4 +259,23 @@ int reviewEvidence(HouseType *house) {
 
     // Return the count of unique evidences
     return uniqueEvidenceCount;
+}
+
+
+/*
+    Function: reviewHunterEvidence
+    Purpose: Reviews the evidence a hunter knows of: what it collected and heard over the radio, or the shared evidence without a radio.
+    Params:
+        Input: 
+            HouseType *house (in) - the house where the hunter is
+            HunterType *hunter (in) - the hunter reviewing
+        Output: int - the count of unique evidences
+*/
+int reviewHunterEvidence(HouseType *house, HunterType *hunter) {
+    // Without a radio every hunter sees the shared evidence
+    if (hunter->radio == NULL) {
+        return reviewEvidence(house);
+    }
+    // Count the evidence types the hunter knows of
+    return __builtin_popcount(hunter->radio->knowledge);
 }
\ No newline at end of file
@@ -36,8 +36,9 @@ void initAndPlaceGhostRandomly(HouseType *house)
     createGhost(&newGhost, 1, randomGhost(), randomRoom);
     // Place the new ghost in the random room
     randomRoom->ghost = newGhost;
+    house->ghost = newGhost;
     // Log the ghost's initialization
-    l_ghostInit(newGhost->ghostType, randomRoom->name);
+    LOG(LOG_GHOST_INIT, l_ghostInit(newGhost->ghostType, randomRoom->name));
 }
 
 
@@ -80,6 +81,7 @@ GhostType *createGhost(GhostType **ghost, int id, GhostClass ghostType, RoomType
     (*ghost)->ghostType = ghostType;
     (*ghost)->room = room;
     (*ghost)->boredomTimer = 0;
+    (*ghost)->evidenceDropped = 0;
     // Return the created ghost
     return *ghost;
 }
@@ -97,38 +99,37 @@ GhostType *createGhost(GhostType **ghost, int id, GhostClass ghostType, RoomType
 void moveGhostToRandomRoom(GhostType *ghost, RoomType *currentRoom) {
     // If the ghost and the current room are not NULL
     if (ghost != NULL && currentRoom != NULL) {
-        // Get the list of rooms connected to the current room
-        RoomListType *connectedRooms = currentRoom->connectedRooms;
-        // Get the number of rooms connected to the current room
-        int numConnectedRooms = connectedRooms->count;
-        
-        // If there are rooms connected to the current room
-        if (numConnectedRooms > 0) {
-            // Generate a random index
-            int randomIndex = randInt(0, numConnectedRooms);
-            // Get the first room in the list of connected rooms
-            RoomNodeType *tempNode = connectedRooms->head;
-            
-            // Move to the room at the random index
-            for (int i = 0; i < randomIndex; i++) {
-                tempNode = tempNode->next;
-            }
-
-            // Get the room at the random index
-            RoomType *newRoom = tempNode->room;
-            // Remove the ghost from the current room
-            ghost->room->ghost = NULL;
-            // Move the ghost to the new room
-            ghost->room = newRoom;
-            // Place the ghost in the new room
-            newRoom->ghost = ghost;
-            // Log the ghost's move
-            l_ghostMove(newRoom->name);
+        // Pick a connected room, if there are any
+        RoomType *newRoom = pickConnectedRoom(currentRoom);
+        if (newRoom != NULL) {
+            moveGhostToRoom(ghost, currentRoom, newRoom);
         }
     }
 }
 
 
+/*
+    Function: moveGhostToRoom
+    Purpose: Moves the given ghost from the given room to another room.
+    Params:
+        Input: 
+            GhostType *ghost (in) - the ghost to move
+            RoomType *currentRoom (in) - the room the ghost is currently in
+            RoomType *newRoom (in) - the room to move the ghost to
+        Output: void
+*/
+void moveGhostToRoom(GhostType *ghost, RoomType *currentRoom, RoomType *newRoom) {
+    // Remove the ghost from the current room
+    currentRoom->ghost = NULL;
+    // Move the ghost to the new room
+    ghost->room = newRoom;
+    // Place the ghost in the new room
+    newRoom->ghost = ghost;
+    // Log the ghost's move
+    LOG(LOG_GHOST_MOVE, l_ghostMove(newRoom->name));
+}
+
+
 /*
     Function: getGhostMatch
     Purpose: Returns the ghost class that matches the given evidence.
@@ -0,0 +1,103 @@
+#include "defs.h"
+
+
+/*
+    Function: trackHeat
+    Purpose: Starts counting the activity of every room of a house, giving each room a zeroed cache line of counters.
+    Params:
+        Input: HouseType *house (in/out) - the house, with its rooms numbered by buildRoutes
+        Output: void
+*/
+void trackHeat(HouseType *house) {
+    size_t size = sizeof(RoomHeatType) * house->rooms.count;
+    house->heat = aligned_alloc(CACHE_LINE, size);
+    memset(house->heat, 0, size);
+}
+
+
+/*
+    Function: addHeat
+    Purpose: Adds the room activity of a finished hunt to a heatmap. Runs once per hunt on the thread that owns the heatmap,
+        so the heatmap itself is never shared between threads.
+    Params:
+        Input:
+            HeatmapType *heatmap (in/out) - the heatmap to add to, may be NULL
+            HouseType *house (in) - the house of the finished hunt, whose room activity was tracked
+        Output: void
+*/
+void addHeat(HeatmapType *heatmap, HouseType *house) {
+    if (heatmap == NULL || house->heat == NULL || atomic_load(&house->state) == HUNT_CANCELLED) {
+        return;
+    }
+    heatmap->hunts++;
+    heatmap->numRooms = house->rooms.count < ROUTE_MAX_ROOMS ? house->rooms.count : ROUTE_MAX_ROOMS;
+    for (int room = 0; room < heatmap->numRooms; room++) {
+        for (int counter = 0; counter < HEAT_COUNT; counter++) {
+            heatmap->counts[room][counter] += atomic_load_explicit(&house->heat[room].counts[counter], memory_order_relaxed);
+        }
+        int peak = house->roomTable[room]->evidence.peak;
+        heatmap->peak[room] = peak > heatmap->peak[room] ? peak : heatmap->peak[room];
+    }
+}
+
+
+/*
+    Function: mergeHeatmap
+    Purpose: Adds every hunt of one heatmap to another, such as a worker's into the sweep's.
+    Params:
+        Input:
+            HeatmapType *into (in/out) - the heatmap to add to
+            const HeatmapType *from (in) - the heatmap to add
+        Output: void
+*/
+void mergeHeatmap(HeatmapType *into, const HeatmapType *from) {
+    into->hunts += from->hunts;
+    into->numRooms = from->numRooms > into->numRooms ? from->numRooms : into->numRooms;
+    for (int room = 0; room < from->numRooms; room++) {
+        for (int counter = 0; counter < HEAT_COUNT; counter++) {
+            into->counts[room][counter] += from->counts[room][counter];
+        }
+        into->peak[room] = from->peak[room] > into->peak[room] ? from->peak[room] : into->peak[room];
+    }
+}
+
+
+/*
+    Function: printHeatmap
+    Purpose: Prints the activity of every room, by room id, with the share of the ghost's ticks spent there and the most
+        evidence the room held at once in any hunt. The room names come from building the map of the hunts once more.
+    Params:
+        Input:
+            const HeatmapType *heatmap (in) - the heatmap to print
+            const ConfigType *config (in) - the runtime parameters of the hunts, which pick the map
+        Output: void
+*/
+void printHeatmap(const HeatmapType *heatmap, const ConfigType *config) {
+    // Build an empty house on the same map, only for its room names
+    HouseType house;
+    initHouse(&house);
+    house.config = config;
+    if (config->gridWidth > 0) {
+        populateGrid(&house, config->gridWidth, config->gridHeight);
+    } else {
+        populateRooms(&house);
+    }
+    buildRoutes(&house);
+
+    long long ghostTicks = 0;
+    for (int room = 0; room < heatmap->numRooms; room++) {
+        ghostTicks += heatmap->counts[room][HEAT_GHOST_TICKS];
+    }
+
+    printf("\n=== Room Activity over %lld simulated hunts ===\n", heatmap->hunts);
+    printf("%-5s %-20s %12s %12s %7s %12s %12s %10s %6s %12s\n", "id", "room", "visits", "ghost ticks", "share", "dropped", "collected",
+           "forgotten", "peak", "fear");
+    for (int room = 0; room < heatmap->numRooms && room < house.rooms.count; room++) {
+        const long long *counts = heatmap->counts[room];
+        printf("%-5d %-20s %12lld %12lld %6.1f%% %12lld %12lld %10lld %6d %12lld\n", room, house.roomTable[room]->name,
+               counts[HEAT_HUNTER_VISITS], counts[HEAT_GHOST_TICKS], ghostTicks > 0 ? 100.0 * counts[HEAT_GHOST_TICKS] / ghostTicks : 0.0,
+               counts[HEAT_EVIDENCE_DROPPED], counts[HEAT_EVIDENCE_COLLECTED], counts[HEAT_EVIDENCE_FORGOTTEN], heatmap->peak[room],
+               counts[HEAT_FEAR]);
+    }
+    cleanHouse(&house);
+}
@@ -0,0 +1,192 @@
+#include "defs.h"
+
+
+/*
+    Function: bucketOf
+    Purpose: Finds the bucket of a value. Values below HIST_SUB_BUCKETS each have their own bucket; above that, every power
+        of two is split into HIST_SUB_BUCKETS / 2 buckets, so a bucket is never wider than 1/64 of the values it holds.
+    Params:
+        Input: uint32_t value (in) - the value to place
+        Output: int - the bucket of the value
+*/
+static int bucketOf(uint32_t value) {
+    if (value < HIST_SUB_BUCKETS) {
+        return value;
+    }
+    int magnitude = 31 - __builtin_clz(value);
+    int shift = magnitude - HIST_SUB_BITS + 1;
+    return HIST_SUB_BUCKETS + (magnitude - HIST_SUB_BITS) * (HIST_SUB_BUCKETS / 2) + (int)(value >> shift) - HIST_SUB_BUCKETS / 2;
+}
+
+
+/*
+    Function: bucketHighest
+    Purpose: Finds the largest value that falls in a bucket.
+    Params:
+        Input: int bucket (in) - the bucket
+        Output: uint32_t - the largest value of the bucket
+*/
+static uint32_t bucketHighest(int bucket) {
+    if (bucket < HIST_SUB_BUCKETS) {
+        return bucket;
+    }
+    int above = bucket - HIST_SUB_BUCKETS;
+    int shift = above / (HIST_SUB_BUCKETS / 2) + 1;
+    uint64_t lowest = (uint64_t)(HIST_SUB_BUCKETS / 2 + above % (HIST_SUB_BUCKETS / 2)) << shift;
+    return (uint32_t)(lowest + (1ULL << shift) - 1);
+}
+
+
+/*
+    Function: recordValue
+    Purpose: Counts one value in a histogram. The histogram never grows, whatever the number of values.
+    Params:
+        Input:
+            HistogramType *histogram (in/out) - the histogram to count in
+            uint32_t value (in) - the value to count
+        Output: void
+*/
+void recordValue(HistogramType *histogram, uint32_t value) {
+    // A zeroed histogram is empty, so the minimum is only trusted once something was counted
+    if (histogram->count == 0 || value < histogram->min) {
+        histogram->min = value;
+    }
+    if (value > histogram->max) {
+        histogram->max = value;
+    }
+    histogram->count++;
+    histogram->sum += value;
+    histogram->counts[bucketOf(value)]++;
+}
+
+
+/*
+    Function: valueAtPercentile
+    Purpose: Finds the value at or below which a percentage of the counted values fall, to within the width of its bucket.
+    Params:
+        Input:
+            const HistogramType *histogram (in) - the histogram to look in
+            double percentile (in) - the percentage, from 0 to 100
+        Output: uint32_t - the largest value of the bucket holding the percentile, capped at the largest value counted
+*/
+uint32_t valueAtPercentile(const HistogramType *histogram, double percentile) {
+    if (histogram->count == 0) {
+        return 0;
+    }
+    // The rank of the value wanted, counting from 1
+    long long rank = (long long)(percentile / 100.0 * histogram->count + 0.5);
+    rank = rank < 1 ? 1 : rank;
+    long long seen = 0;
+    for (int bucket = 0; bucket < HIST_BUCKETS; bucket++) {
+        seen += histogram->counts[bucket];
+        if (seen >= rank) {
+            uint32_t highest = bucketHighest(bucket);
+            return highest < histogram->max ? highest : histogram->max;
+        }
+    }
+    return histogram->max;
+}
+
+
+/*
+    Function: mergeHistogram
+    Purpose: Adds every value counted in one histogram to another, as if they had been counted there.
+    Params:
+        Input:
+            HistogramType *into (in/out) - the histogram to add to
+            const HistogramType *from (in) - the histogram to add
+        Output: void
+*/
+void mergeHistogram(HistogramType *into, const HistogramType *from) {
+    if (from->count == 0) {
+        return;
+    }
+    if (into->count == 0 || from->min < into->min) {
+        into->min = from->min;
+    }
+    if (from->max > into->max) {
+        into->max = from->max;
+    }
+    into->count += from->count;
+    into->sum += from->sum;
+    for (int bucket = 0; bucket < HIST_BUCKETS; bucket++) {
+        into->counts[bucket] += from->counts[bucket];
+    }
+}
+
+
+/*
+    Function: recordHunt
+    Purpose: Counts a finished hunt in the distributions: the ticks until the ghost was identified if the hunters won, the
+        evidence the ghost dropped, and for every hunter its final fear, its moves, and its boredom if it left the house.
+    Params:
+        Input:
+            DistributionsType *distributions (in/out) - the distributions to count in, may be NULL
+            HouseType *house (in) - the house of the finished hunt
+        Output: void
+*/
+void recordHunt(DistributionsType *distributions, HouseType *house) {
+    if (distributions == NULL || atomic_load(&house->state) == HUNT_CANCELLED) {
+        return;
+    }
+    distributions->hunts++;
+    if (atomic_load(&house->state) == HUNT_HUNTERS_WON) {
+        recordValue(&distributions->histograms[DIST_TICKS_TO_IDENTIFY], atomic_load(&house->ticks));
+    }
+    GhostType *ghost = getGhostInHouse(house);
+    recordValue(&distributions->histograms[DIST_EVIDENCE_DROPPED], ghost->evidenceDropped);
+    for (int i = 0; i < house->registry.count; i++) {
+        HunterType *hunter = &house->registry.table[i];
+        recordValue(&distributions->histograms[DIST_FINAL_FEAR], atomic_load(&hunter->fear));
+        recordValue(&distributions->histograms[DIST_HUNTER_MOVES], hunter->moves);
+        if (atomic_load(&hunter->exited)) {
+            recordValue(&distributions->histograms[DIST_EXIT_BOREDOM], atomic_load(&hunter->boredomTimer));
+        }
+    }
+}
+
+
+/*
+    Function: mergeDistributions
+    Purpose: Adds every hunt counted in one set of distributions to another, such as a worker's into the sweep's.
+    Params:
+        Input:
+            DistributionsType *into (in/out) - the distributions to add to
+            const DistributionsType *from (in) - the distributions to add
+        Output: void
+*/
+void mergeDistributions(DistributionsType *into, const DistributionsType *from) {
+    into->hunts += from->hunts;
+    for (int i = 0; i < DIST_COUNT; i++) {
+        mergeHistogram(&into->histograms[i], &from->histograms[i]);
+    }
+}
+
+
+/*
+    Function: printDistributions
+    Purpose: Prints the count, mean, percentiles and extremes of every distribution.
+    Params:
+        Input: const DistributionsType *distributions (in) - the distributions to print
+        Output: void
+*/
+void printDistributions(const DistributionsType *distributions) {
+    // Names in the same order as enum Distribution
+    static const char *names[DIST_COUNT] = {
+        "ticks to identification",
+        "final fear per hunter",
+        "boredom at exit",
+        "evidence dropped per hunt",
+        "moves per hunter"
+    };
+
+    printf("\n=== Distributions over %lld simulated hunts ===\n", distributions->hunts);
+    printf("%-26s %9s %8s %6s %6s %6s %6s %6s %6s\n", "", "count", "mean", "min", "p50", "p90", "p99", "p99.9", "max");
+    for (int i = 0; i < DIST_COUNT; i++) {
+        const HistogramType *histogram = &distributions->histograms[i];
+        printf("%-26s %9lld %8.1f %6u %6u %6u %6u %6u %6u\n", names[i], histogram->count,
+               histogram->count > 0 ? (double)histogram->sum / histogram->count : 0.0, histogram->count > 0 ? histogram->min : 0,
+               valueAtPercentile(histogram, 50.0), valueAtPercentile(histogram, 90.0), valueAtPercentile(histogram, 99.0),
+               valueAtPercentile(histogram, 99.9), histogram->max);
+    }
+}
@@ -58,6 +58,51 @@ void populateRooms(HouseType *house)
 }
 
 
+/*
+    Function: populateGrid
+    Purpose: Builds a generated map: a grid of rooms, each connected to the rooms beside, above and below it, with the Van in a corner.
+    Params:
+        Input: 
+            HouseType *house (in/out) - the house to build the rooms of
+            int width (in) - the number of columns
+            int height (in) - the number of rows
+        Output: void
+*/
+void populateGrid(HouseType *house, int width, int height)
+{
+    RoomType *rooms[width * height];
+    // Create each room in row order, the first one being the Van
+    for (int y = 0; y < height; y++) {
+        for (int x = 0; x < width; x++) {
+            char name[MAX_STR];
+            if (x == 0 && y == 0) {
+                strcpy(name, "Van");
+            } else {
+                sprintf(name, "Room %d,%d", x, y);
+            }
+            rooms[y * width + x] = createRoom(name);
+        }
+    }
+
+    // Connect each room to the one after it and the one below it
+    for (int y = 0; y < height; y++) {
+        for (int x = 0; x < width; x++) {
+            if (x + 1 < width) {
+                connectRooms(rooms[y * width + x], rooms[y * width + x + 1]);
+            }
+            if (y + 1 < height) {
+                connectRooms(rooms[y * width + x], rooms[(y + 1) * width + x]);
+            }
+        }
+    }
+
+    // Add each room to the house's room list, the Van first
+    for (int i = 0; i < width * height; i++) {
+        addRoom(&house->rooms, rooms[i]);
+    }
+}
+
+
 /*
     Function: initHouse
     Purpose: Initializes the house with empty rooms and no shared evidence.
@@ -72,11 +117,161 @@ void initHouse(HouseType *house)
     house->rooms.tail = NULL;
     house->rooms.count = 0; // Initialize the count of rooms to 0
     house->sharedEvidenceCount = 0; // Initialize the count of shared evidence to 0
-    // Initialize the size of the lists of hunters who exited due to fear and boredom to 0
-    house->huntersExitedFear->size = 0; 
-    house->huntersExitedBoredom->size = 0;
+    // The lists of hunters who exited due to fear and boredom are sized once the number of hunters is known
+    house->huntersExitedFear.hunters = NULL;
+    house->huntersExitedFear.size = 0;
+    house->huntersExitedBoredom.hunters = NULL;
+    house->huntersExitedBoredom.size = 0;
     // Initialize the semaphore for evidence with an initial value of 1
     sem_init(&(house->evidenceSem), 0, 1);
+    // Metrics are disabled until the caller attaches a metrics file
+    house->metrics = NULL;
+    // The hunt is running with nobody inside until the hunters are placed
+    atomic_init(&house->state, HUNT_RUNNING);
+    atomic_init(&house->huntersInHouse, 0);
+    atomic_init(&house->ticks, 0);
+    // The caller picks the parameters and seed of the hunt
+    house->config = NULL;
+    house->seed = 0;
+    // The radio network is off until the hunt sets it up
+    house->radios = NULL;
+    house->micros = 0;
+    // Hunters are registered once the rooms are populated
+    house->registry.table = NULL;
+    house->registry.index = NULL;
+    house->registry.count = 0;
+    house->registry.capacity = 0;
+    house->registry.indexMask = 0;
+    // Rooms are numbered and routed once they are populated
+    house->roomTable = NULL;
+    house->routes = NULL;
+    // Nothing has been left, collected, or moved yet
+    for (int i = 0; i < EV_COUNT; i++) {
+        atomic_init(&house->evidenceHint[i], -1);
+    }
+    atomic_init(&house->hunterHint, -1);
+    atomic_init(&house->evidenceMask, 0);
+    // Room activity is only counted when asked for
+    house->heat = NULL;
+    // The ghost is placed with the rooms, and the hunt's state is only sampled when asked for
+    house->ghost = NULL;
+    atomic_init(&house->roomEvidence, 0);
+    house->samples = NULL;
+}
+
+
+/*
+    Function: houseFootprint
+    Purpose: Adds up the bytes a house has allocated: the house itself, its rooms with their links, hunter nodes and evidence
+        rings, its hunters, lists of exits, ghost, radios, room index and activity counters. Radio reports and the next-hop
+        table shared by every house on the map are left out, as is the allocator's own overhead.
+    Params:
+        Input: const HouseType *house (in) - the house to measure
+        Output: size_t - the bytes the house holds
+*/
+size_t houseFootprint(const HouseType *house) {
+    size_t bytes = sizeof(HouseType);
+    for (RoomNodeType *node = house->rooms.head; node != NULL; node = node->next) {
+        RoomType *room = node->room;
+        // The room, its node in the house, its list of connections and its nodes in it
+        bytes += sizeof(RoomNodeType) + sizeof(RoomType) + sizeof(RoomListType);
+        bytes += sizeof(RoomNodeType) * room->connectedRooms->count;
+        bytes += sizeof(HunterNodeType) * room->hunters.count;
+        bytes += room->evidence.ring != NULL ? room->evidence.capacity : 0;
+    }
+    // The hunters and their index, the lists of exits, and the ghost
+    bytes += sizeof(HunterType) * house->registry.capacity + sizeof(int) * (house->registry.indexMask + 1);
+    bytes += house->huntersExitedFear.hunters != NULL ? 2 * sizeof(HunterType *) * house->registry.capacity : 0;
+    bytes += sizeof(GhostType);
+    // What only some hunts allocate
+    bytes += house->radios != NULL ? sizeof(RadioType) * house->registry.capacity : 0;
+    bytes += house->roomTable != NULL ? sizeof(RoomType *) * house->rooms.count : 0;
+    bytes += house->heat != NULL ? sizeof(RoomHeatType) * house->rooms.count : 0;
+    bytes += house->samples != NULL ? sizeof(SampleRingType) : 0;
+    return bytes;
+}
+
+
+/*
+    Function: endHunt
+    Purpose: Decides the outcome of the hunt, unless it has already been decided.
+    Params:
+        Input: 
+            HouseType *house (in) - the house where the hunt takes place
+            enum HuntState outcome (in) - the outcome to record
+        Output: int - C_TRUE if this call decided the outcome, C_FALSE if it was already decided
+*/
+int endHunt(HouseType *house, enum HuntState outcome) {
+    // Only the first outcome counts, later ones lose the exchange
+    int expected = HUNT_RUNNING;
+    return atomic_compare_exchange_strong(&house->state, &expected, outcome) ? C_TRUE : C_FALSE;
+}
+
+
+/*
+    Function: isHuntOver
+    Purpose: Checks whether the outcome of the hunt has been decided, so agents can stop acting.
+    Params:
+        Input: HouseType *house (in) - the house where the hunt takes place
+        Output: int - C_TRUE if the hunt is over, C_FALSE otherwise
+*/
+int isHuntOver(HouseType *house) {
+    return atomic_load_explicit(&house->state, memory_order_acquire) != HUNT_RUNNING;
+}
+
+
+/*
+    Function: cancelHunt
+    Purpose: Stops a running hunt; every agent returns after its current action. Safe to call from a signal handler.
+    Params:
+        Input: HouseType *house (in) - the house where the hunt takes place
+        Output: void
+*/
+void cancelHunt(HouseType *house) {
+    // Wake the hunters parked anywhere in the house too, rather than have them sleep out their idle periods
+    if (endHunt(house, HUNT_CANCELLED) && house->config->wake == WAKE_EVENT) {
+        signalHouse(house);
+    }
+}
+
+
+/*
+    Function: hunterExited
+    Purpose: Records a hunter leaving the house and ends the hunt once its outcome is decided.
+    Params:
+        Input: 
+            HouseType *house (in) - the house the hunter left
+            int withEvidence (in) - C_TRUE if the hunter left with sufficient evidence
+        Output: void
+*/
+void hunterExited(HouseType *house, int withEvidence) {
+    // Count the hunter out of the house
+    int remaining = atomic_fetch_sub(&house->huntersInHouse, 1) - 1;
+    int decided = C_FALSE;
+    if (withEvidence == C_TRUE) {
+        // A hunter leaving with evidence means the hunters have won
+        decided = endHunt(house, HUNT_HUNTERS_WON);
+    } else if (remaining == 0) {
+        // Nobody is left to find evidence, so the ghost has won
+        decided = endHunt(house, HUNT_GHOST_WON);
+    }
+    // Wake the hunters parked anywhere in the house, rather than have them sleep out their idle periods in a finished hunt
+    if (decided && house->config->wake == WAKE_EVENT) {
+        signalHouse(house);
+    }
+}
+
+
+/*
+    Function: huntersStopped
+    Purpose: Takes the hunters still in the house off the alive gauge. A hunt ends as soon as its outcome is decided or it is
+        cancelled, leaving the hunters that never exited inside, so each engine calls this once every agent has stopped.
+    Params:
+        Input: HouseType *house (in) - the house of the finished hunt
+        Output: void
+*/
+void huntersStopped(HouseType *house) {
+    metricsAdd(house->metrics, MET_HUNTERS_ALIVE, -atomic_load(&house->huntersInHouse));
 }
 
 
@@ -106,4 +301,45 @@ GhostType *getGhostInHouse(HouseType* house) {
     }
     // Return the found ghost, or NULL if no ghost was found
     return ghost;
+}
+
+
+/*
+    Function: hashHouseMap
+    Purpose: Hashes the map of a house, every room name in order with the names of its connected rooms, so results can be keyed by map.
+    Params:
+        Input: HouseType *house (in) - the house whose map to hash
+        Output: uint64_t - the hash of the map
+*/
+uint64_t hashHouseMap(HouseType *house) {
+    uint64_t hash = FNV_OFFSET;
+    // Loop through all rooms in the house
+    for (RoomNodeType *roomNode = house->rooms.head; roomNode != NULL; roomNode = roomNode->next) {
+        // Hash the room name, including its terminator so names cannot run together
+        hash = hashBytes(hash, roomNode->room->name, strlen(roomNode->room->name) + 1);
+        // Hash the names of the connected rooms, in connection order
+        for (RoomNodeType *connected = roomNode->room->connectedRooms->head; connected != NULL; connected = connected->next) {
+            hash = hashBytes(hash, connected->room->name, strlen(connected->room->name) + 1);
+        }
+        // Mark the end of the room's connections
+        hash = hashBytes(hash, "", 1);
+    }
+    return hash;
+}
+
+
+/*
+    Function: defaultMapHash
+    Purpose: Returns the hash of the map built by populateRooms, building it once to find out.
+    Params:
+        Output: uint64_t - the hash of the default map
+*/
+uint64_t defaultMapHash() {
+    // Build a throwaway house with just the rooms
+    HouseType house;
+    initHouse(&house);
+    populateRooms(&house);
+    uint64_t hash = hashHouseMap(&house);
+    cleanHouse(&house);
+    return hash;
 }
\ No newline at end of file
@@ -3,42 +3,54 @@
 
 /*
     Function: initHunterAndPlaceInVan
-    Purpose: Initializes the hunters and places them in the van room.
+    Purpose: Registers a hunter with the house and places them in the van room, the first room of the house.
     Params:
         Input: 
-            RoomType *vanRoom (in) - the van room to place the hunters in
-            char hunterNames[][MAX_STR] (in) - the names of the hunters
-            int numHunters (in) - the number of hunters
-        Output: void
+            HouseType *house (in/out) - the house, with its rooms populated and its registry initialized
+            char *name (in) - the name of the hunter
+        Output: HunterType* - the new hunter, or NULL if the name is taken or the registry is full
 */
-void initHunterAndPlaceInVan(RoomType *vanRoom, char *name)
+HunterType *initHunterAndPlaceInVan(HouseType *house, char *name)
 {
-    // For each hunter, we create a new HunterType object, add it to the van room's list of hunters,
+    // Create the hunter in the house's registry, add it to the van room's list of hunters,
     // and initialize the hunter's log with their name and equipment type.
-    HunterType *newHunter = createHunter(name, vanRoom);
+    RoomType *vanRoom = house->rooms.head->room;
+    HunterType *newHunter = createHunter(&house->registry, name, vanRoom);
+    if (newHunter == NULL) {
+        return NULL;
+    }
     insertAtHeadHunter(&(vanRoom->hunters), newHunter);
-    l_hunterInit(newHunter->name, newHunter->equipmentType);
+    LOG(LOG_HUNTER_INIT, l_hunterInit(newHunter->name, newHunter->equipmentType));
+    return newHunter;
 }
 
 
 /*
     Function: createHunter
-    Purpose: Creates a new hunter with a given name and places them in a room.
+    Purpose: Creates a new hunter with a given name in a registry and places them in a room.
     Params:
         Input: 
+            HunterRegistryType *registry (in/out) - the registry that owns the hunter
             char *name (in) - the name of the hunter
             RoomType *room (in) - the room to place the hunter in
-        Output: HunterType* - the newly created hunter
+        Output: HunterType* - the newly created hunter, or NULL if the name is taken or the registry is full
 */
-HunterType *createHunter(char *name, RoomType *room)
+HunterType *createHunter(HunterRegistryType *registry, char *name, RoomType *room)
 {
-    HunterType *newHunter = (HunterType *)malloc(sizeof(HunterType)); // Allocate memory for a new HunterType
-    newHunter->id = randInt(1, 100); // Assign a random ID to the new hunter
-    strcpy(newHunter->name, name); // Set the hunter's name
+    HunterType *newHunter = registerHunter(registry, name); // Take the next id and entry, which sets the hunter's name
+    if (newHunter == NULL) {
+        return NULL;
+    }
     newHunter->equipmentType = randInt(0, EV_COUNT); // Assign random equipment type to the hunter
-    newHunter->fear = 0; // Initialize fear level to 0
-    newHunter->boredomTimer = 0; // Initialize boredom timer to 0
+    atomic_init(&newHunter->fear, 0); // Initialize fear level to 0
+    atomic_init(&newHunter->boredomTimer, 0); // Initialize boredom timer to 0
     newHunter->currentRoom = room; // Set the current room of the new hunter
+    newHunter->radio = NULL; // The hunter has no radio unless the hunt turns the radio network on
+    newHunter->ghostSeen = -1; // The hunter has not met the ghost yet
+    newHunter->moves = 0; // The hunter has not moved yet
+    atomic_init(&newHunter->exited, C_FALSE); // The hunter starts in the house
+    newHunter->plannedCount = 0; // No action is drawn ahead yet
+    newHunter->idlePeriods = 0;
     return newHunter; // Return the newly created hunter
 }
 
@@ -83,27 +95,41 @@ void insertAtHeadHunter(HunterListType *list, HunterType *newHunter)
         Output: void
 */
 void collectEvidence(HouseType *house, HunterType *hunter, RoomType *currentRoom) {
-    // Get the first evidence in the room
-    Evidence *currentEvidence = currentRoom->evidences.head;
     // Get the type of equipment the hunter has
     enum EvidenceType hunterEquipment = hunter->equipmentType;
 
-    // Loop through all evidence in the room
-    while (currentEvidence != NULL) {
-        // If the evidence type matches the hunter's equipment type
-        if (currentEvidence->etype == hunterEquipment) {
-            // Add the evidence to the house's shared evidence
-            house->sharedEvidence[house->sharedEvidenceCount++] = currentEvidence->etype;
-            // Log the collection of the evidence
-            l_hunterCollect(hunter->name, currentEvidence->etype, currentRoom->name);
-            // Remove the evidence from the room
-            removeEvidence(&(currentRoom->evidences), currentEvidence->etype);
-            // Stop looking for more evidence
-            break;
-        }
-        // Move to the next evidence in the room
-        currentEvidence = currentEvidence->next;
+    // Take a piece the hunter's equipment detects out of the room, if there is one
+    if (takeEvidence(&(currentRoom->evidence), hunterEquipment) == C_FALSE) {
+        return;
+    }
+    if (house->samples != NULL) {
+        atomic_fetch_sub_explicit(&house->roomEvidence, 1, memory_order_relaxed);
     }
+    // Add the evidence to the house's shared evidence, which hunters in other rooms share at the same time
+    sem_wait(&(house->evidenceSem));
+    if (house->sharedEvidenceCount < MAX_ARR) {
+        // Publish the count only once the entry is written, for reviews that read it without the lock
+        house->sharedEvidence[house->sharedEvidenceCount] = hunterEquipment;
+        __atomic_store_n(&house->sharedEvidenceCount, house->sharedEvidenceCount + 1, __ATOMIC_RELEASE);
+    }
+    sem_post(&(house->evidenceSem));
+    // Tell the other hunters over the radio when this is news to the hunter
+    if (hunter->radio != NULL && (hunter->radio->knowledge & (1 << hunterEquipment)) == 0) {
+        hunter->radio->knowledge |= 1 << hunterEquipment;
+        broadcastReport(house, hunter->radio);
+    }
+    // Mark the type as collected, for hunters deciding where to go
+    int known = atomic_fetch_or(&house->evidenceMask, 1 << hunterEquipment);
+    // The third type known lets a review end the hunt, so hunters parked through their reviews must wake for it. The mask is
+    // set before the rooms are signalled, and read after a parking hunter reads its room's events
+    if (house->config->wake == WAKE_EVENT && __builtin_popcount(known) < 3 && __builtin_popcount(known | (1 << hunterEquipment)) >= 3) {
+        signalHouse(house);
+    }
+    // Count the collection by evidence type
+    metricsAdd(house->metrics, MET_EVIDENCE_EMF + hunterEquipment, 1);
+    heatAdd(house, currentRoom, HEAT_EVIDENCE_COLLECTED);
+    // Log the collection of the evidence
+    LOG(LOG_HUNTER_COLLECT, l_hunterCollect(hunter->name, hunterEquipment, currentRoom->name));
 }
 
 
@@ -166,90 +192,31 @@ void removeHunterFromRoom(RoomType *room, HunterType *hunter) {
         Output: void
 */
 void moveHunterToRandomRoom(HunterType *hunter, RoomType *currentRoom) {
-    // Get the list of rooms connected to the current room
-    RoomListType *connectedRooms = currentRoom->connectedRooms;
-    // Get the number of rooms connected to the current room
-    int numConnectedRooms = connectedRooms->count;
-    
-    // If there are any connected rooms
-    if (numConnectedRooms > 0) {
-        // Generate a random index
-        int randomIndex = randInt(0, numConnectedRooms);
-
-        // Get the room at the random index
-        RoomNodeType *tempNode = connectedRooms->head;
-        for (int i = 0; i < randomIndex; i++) {
-            tempNode = tempNode->next;
-        }
-
-        // Get the new room for the hunter
-        RoomType *newRoom = tempNode->room;
-        // Set the current room of the hunter to the new room
-        hunter->currentRoom = newRoom;
-        
-        // Add the hunter to the new room
-        insertAtHeadHunter(&(newRoom->hunters), hunter);        
-        // Remove the hunter from the current room
-        removeHunterFromRoom(currentRoom, hunter);
-        // Log the movement of the hunter
-        l_hunterMove(hunter->name, newRoom->name);
+    // Pick a connected room, if there are any
+    RoomType *newRoom = pickConnectedRoom(currentRoom);
+    if (newRoom != NULL) {
+        moveHunterToRoom(hunter, currentRoom, newRoom);
     }
 }
 
 
 /*
-    Function: findHunterByName
-    Purpose: Finds a hunter in the house by their name.
+    Function: moveHunterToRoom
+    Purpose: Moves a hunter from its current room to a given room.
     Params:
         Input: 
-            const HouseType *house (in) - the house to search for the hunter
-            const char *name (in) - the name of the hunter to find
-        Output: HunterType* - the found hunter, or NULL if no hunter is found
+            HunterType *hunter (in) - the hunter to move
+            RoomType *currentRoom (in) - the current room of the hunter
+            RoomType *newRoom (in) - the room to move the hunter to
+        Output: void
 */
-HunterType *findHunterByName(const HouseType *house, const char *name) {
-    // Get the first room in the house
-    RoomNodeType *currentRoomNode = house->rooms.head;
-    // Loop through all rooms in the house
-    while (currentRoomNode != NULL) {
-        // Get the first hunter in the current room
-        HunterNodeType *currentHunterNode = currentRoomNode->room->hunters.head;
-        // Loop through all hunters in the current room
-        while (currentHunterNode != NULL) {
-            // If the name of the current hunter matches the provided name
-            if (strcmp(currentHunterNode->hunter->name, name) == 0) {
-                // Hunter found, return the pointer to the hunter struct
-                return currentHunterNode->hunter;
-            }
-            // Move to the next hunter in the room
-            currentHunterNode = currentHunterNode->next;
-        }
-        // Move to the next room in the house
-        currentRoomNode = currentRoomNode->next;
-    }
-    // If hunter not found, return null
-    return NULL;
+void moveHunterToRoom(HunterType *hunter, RoomType *currentRoom, RoomType *newRoom) {
+    // Set the current room of the hunter to the new room
+    hunter->currentRoom = newRoom;
+    // Add the hunter to the new room
+    insertAtHeadHunter(&(newRoom->hunters), hunter);        
+    // Remove the hunter from the current room
+    removeHunterFromRoom(currentRoom, hunter);
+    // Log the movement of the hunter
+    LOG(LOG_HUNTER_MOVE, l_hunterMove(hunter->name, newRoom->name));
 }
-
-
-/*
-    Function: findHunterByName
-    Purpose: Finds a hunter in the house by their name.
-    Params:
-        Input: 
-            const HouseType *house (in) - the house to search for the hunter
-            const char *name (in) - the name of the hunter to find
-        Output: HunterType* - the found hunter, or NULL if no hunter is found
-*/
-void removeHunterFromHouse(HouseType *house, HunterType *hunter) {
-    // Get the first room in the house
-    RoomNodeType *currentRoomNode = house->rooms.head;
-    // Loop through all rooms in the house
-    while (currentRoomNode != NULL) {
-        // Get the current room
-        RoomType *currentRoom = currentRoomNode->room;
-        // Remove the hunter from the current room
-        removeHunterFromRoom(currentRoom, hunter);
-        // Move to the next room in the house
-        currentRoomNode = currentRoomNode->next;
-    }
-}
\ No newline at end of file
@@ -0,0 +1,229 @@
+#include "defs.h"
+
+
+/*
+    Function: seedStep
+    Purpose: Seeds the calling thread's random stream for one agent at one tick, so the numbers an agent draws depend only on
+        the hunt's seed, the agent and the tick, never on which thread decides for it.
+    Params:
+        Input:
+            HouseType *house (in) - the house of the hunt
+            int stream (in) - the agent's stream: 0 for resolving, 1 for the ghost, 2 and up for the hunters
+            int tick (in) - the tick being decided or resolved
+        Output: void
+*/
+static void seedStep(HouseType *house, int stream, int tick) {
+    seedRandom(deriveSeed(deriveSeed(house->seed, stream), tick));
+}
+
+
+/*
+    Function: decideAgents
+    Purpose: Decides the actions of one thread's share of the agents for the current tick. Agent 0 is the ghost and agent
+        i + 1 the hunter with id i; a thread takes every agent whose number is its index modulo the number of threads.
+    Params:
+        Input:
+            LockstepType *lockstep (in/out) - the hunt, whose intents for this tick are written
+            int index (in) - the position of the calling thread
+        Output: void
+*/
+static void decideAgents(LockstepType *lockstep, int index) {
+    HouseType *house = lockstep->house;
+    int numHunters = house->registry.count;
+    for (int agent = index; agent <= numHunters; agent += lockstep->numThreads) {
+        if (agent == 0) {
+            if (lockstep->ghostActive) {
+                seedStep(house, 1, lockstep->tick);
+                decideGhost(house, lockstep->ghost, lockstep->ghost->room, &lockstep->ghostIntent);
+            }
+        } else if (lockstep->huntersActive[agent - 1]) {
+            seedStep(house, agent + 1, lockstep->tick);
+            decideHunter(house, &house->registry.table[agent - 1], &lockstep->hunterIntents[agent - 1]);
+        }
+    }
+}
+
+
+/*
+    Function: resolveTick
+    Purpose: Applies every decision of the tick in a fixed order, the ghost first and then the hunters by id, so two hunters
+        collecting the same evidence or moving at once always resolve the same way. Runs on one thread while the others wait.
+    Params:
+        Input: LockstepType *lockstep (in/out) - the hunt, moved on to the next tick
+        Output: void
+*/
+static void resolveTick(LockstepType *lockstep) {
+    HouseType *house = lockstep->house;
+    // Radio losses drawn while resolving come from their own stream
+    seedStep(house, 0, lockstep->tick);
+    countTick(house);
+
+    // The ghost acts first
+    if (lockstep->ghostActive) {
+        GhostType *ghost = lockstep->ghost;
+        RoomType *moveTo = NULL;
+        int outcome = applyGhost(house, ghost, ghost->room, &lockstep->ghostIntent, &moveTo);
+        if (outcome == STEP_MOVING) {
+            moveGhostToRoom(ghost, ghost->room, moveTo);
+        } else if (outcome == STEP_EXITED) {
+            lockstep->ghostActive = C_FALSE;
+        }
+    }
+
+    // Then each hunter by id, stopping as soon as the outcome is decided
+    for (int id = 0; id < house->registry.count && !isHuntOver(house); id++) {
+        if (!lockstep->huntersActive[id]) {
+            continue;
+        }
+        HunterType *hunter = &house->registry.table[id];
+        RoomType *currentRoom = hunter->currentRoom;
+        // Take in radio reports, which only reach a hunter between ticks
+        if (hunter->radio != NULL) {
+            runRadio(house, hunter->radio);
+        }
+        RoomType *moveTo = NULL;
+        int outcome = applyHunter(house, hunter, &lockstep->hunterIntents[id], &moveTo);
+        if (outcome == STEP_MOVING) {
+            moveHunterToRoom(hunter, currentRoom, moveTo);
+        } else if (outcome == STEP_EXITED) {
+            lockstep->huntersActive[id] = C_FALSE;
+        }
+    }
+
+    lockstep->tick++;
+    lockstep->done = isHuntOver(house);
+}
+
+
+/*
+    Function: lockstepThread
+    Purpose: Represents a thread of the lockstep engine. Every tick, each thread decides for its share of the agents without
+        taking any lock, then the first thread resolves the tick while the others wait at the barrier.
+    Params:
+        Input: void *arg (in) - the thread's LockstepWorkerType
+        Output: void
+*/
+void *lockstepThread(void *arg) {
+    LockstepWorkerType *worker = (LockstepWorkerType *)arg;
+    LockstepType *lockstep = worker->lockstep;
+
+    while (C_TRUE) {
+        // Decide from the state every agent sees at this tick
+        decideAgents(lockstep, worker->index);
+        pthread_barrier_wait(&lockstep->barrier);
+
+        // Resolve the tick on one thread
+        if (worker->index == 0) {
+            resolveTick(lockstep);
+            if (!lockstep->done) {
+                pauseAgent(lockstep->house);
+            }
+        }
+        pthread_barrier_wait(&lockstep->barrier);
+        if (lockstep->done) {
+            break;
+        }
+    }
+    // Add the phases this thread timed to the profile
+    flushProfile();
+    return NULL;
+}
+
+
+/*
+    Function: initLockstep
+    Purpose: Starts a hunt in the lockstep engine at its first tick, with every hunter in the house.
+    Params:
+        Input:
+            LockstepType *lockstep (out) - the hunt to start
+            HouseType *house (in/out) - the house where the hunters and the ghost are
+            int numThreads (in) - threads that will decide in parallel, 1 to step on the calling thread alone
+        Output: void
+*/
+void initLockstep(LockstepType *lockstep, HouseType *house, int numThreads) {
+    int numHunters = house->registry.count;
+    lockstep->house = house;
+    lockstep->ghost = getGhostInHouse(house);
+    lockstep->ghostActive = lockstep->ghost != NULL;
+    lockstep->hunterIntents = calloc(numHunters, sizeof(IntentType));
+    lockstep->huntersActive = malloc(numHunters);
+    memset(lockstep->huntersActive, C_TRUE, numHunters);
+    lockstep->tick = 0;
+    lockstep->done = C_FALSE;
+    lockstep->numThreads = numThreads;
+
+    // Every hunter is in the house before the first tick
+    atomic_store(&house->huntersInHouse, numHunters);
+    metricsAdd(house->metrics, MET_HUNTERS_ALIVE, numHunters);
+}
+
+
+/*
+    Function: stepLockstep
+    Purpose: Runs one tick of a lockstep hunt on the calling thread alone, deciding for every agent then resolving. Gives the
+        same hunt as any number of threads.
+    Params:
+        Input: LockstepType *lockstep (in/out) - the hunt, started by initLockstep with one thread
+        Output: int - C_TRUE if the hunt goes on, C_FALSE once it is over
+*/
+int stepLockstep(LockstepType *lockstep) {
+    if (lockstep->done) {
+        return C_FALSE;
+    }
+    decideAgents(lockstep, 0);
+    resolveTick(lockstep);
+    return !lockstep->done;
+}
+
+
+/*
+    Function: cleanLockstep
+    Purpose: Frees what a lockstep hunt kept between ticks, and takes the hunters still in the house off the alive gauge.
+        The house itself is left to the caller.
+    Params:
+        Input: LockstepType *lockstep (in/out) - the hunt started by initLockstep
+        Output: void
+*/
+void cleanLockstep(LockstepType *lockstep) {
+    huntersStopped(lockstep->house);
+    free(lockstep->hunterIntents);
+    free(lockstep->huntersActive);
+    lockstep->hunterIntents = NULL;
+    lockstep->huntersActive = NULL;
+}
+
+
+/*
+    Function: runLockstep
+    Purpose: Simulates a hunt with the lockstep engine. Ticks alternate between a decide phase, where every agent picks its action
+        from the same state in parallel, and a resolve phase, where the decisions are applied in a fixed order. The outcome of a
+        seed is the same whatever the number of threads.
+    Params:
+        Input: HouseType *house (in) - the house where the hunters and the ghost are
+        Output: void
+*/
+void runLockstep(HouseType *house) {
+    int numHunters = house->registry.count;
+    LockstepType lockstep;
+    // More threads than agents would have nothing to decide
+    initLockstep(&lockstep, house, house->config->stepThreads < numHunters + 1 ? house->config->stepThreads : numHunters + 1);
+    pthread_barrier_init(&lockstep.barrier, NULL, lockstep.numThreads);
+
+    // Run the first thread here, alongside the others
+    pthread_t threads[lockstep.numThreads];
+    LockstepWorkerType workers[lockstep.numThreads];
+    for (int i = 0; i < lockstep.numThreads; i++) {
+        workers[i].lockstep = &lockstep;
+        workers[i].index = i;
+        if (i > 0) {
+            pthread_create(&threads[i], NULL, lockstepThread, (void *)&workers[i]);
+        }
+    }
+    lockstepThread(&workers[0]);
+    for (int i = 1; i < lockstep.numThreads; i++) {
+        pthread_join(threads[i], NULL);
+    }
+
+    pthread_barrier_destroy(&lockstep.barrier);
+    cleanLockstep(&lockstep);
+}
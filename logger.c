@@ -1,12 +1,22 @@
 #include "defs.h"
 
+// Every category but hunter reviews is logged by default, each event of it
+unsigned int logMask = ((1u << LOG_CATEGORY_COUNT) - 1) & ~(1u << LOG_HUNTER_REVIEW);
+unsigned int logSample[LOG_CATEGORY_COUNT] = {0};
+__thread unsigned int logSeen[LOG_CATEGORY_COUNT] = {0};
+
+// Names of the log categories, in enum LogCategory order, as given to --log
+static const char *logNames[LOG_CATEGORY_COUNT] = {
+    "hunter-init", "hunter-move", "hunter-review", "hunter-collect", "hunter-exit",
+    "ghost-init", "ghost-move", "ghost-evidence", "ghost-exit"
+};
+
 /* 
     Logs the hunter being created.
     in: hunter - the hunter name to log
     in: equipment - the hunter's equipment
 */
 void l_hunterInit(char* hunter, enum EvidenceType equipment) {
-    if (!LOGGING) return;
     char ev_str[MAX_STR];
     evidenceToString(equipment, ev_str);
     printf("[HUNTER INIT] [%s] is a [%s] hunter\n", hunter, ev_str);    
@@ -18,7 +28,6 @@ void l_hunterInit(char* hunter, enum EvidenceType equipment) {
     in: room - the room name to log
 */
 void l_hunterMove(char* hunter, char* room) {
-    if (!LOGGING) return;
     printf("[HUNTER MOVE] [%s] has moved into [%s]\n", hunter, room);
 }
 
@@ -28,7 +37,6 @@ void l_hunterMove(char* hunter, char* room) {
     in: reason - the reason for exiting, either LOG_FEAR, LOG_BORED, or LOG_EVIDENCE
 */
 void l_hunterExit(char* hunter, enum LoggerDetails reason) {
-    if (!LOGGING) return;
     printf("[HUNTER EXIT] [%s] exited because ", hunter);
     switch (reason) {
         case LOG_FEAR:
@@ -51,7 +59,6 @@ void l_hunterExit(char* hunter, enum LoggerDetails reason) {
     in: result - the result of the review, either LOG_SUFFICIENT or LOG_INSUFFICIENT
 */
 void l_hunterReview(char* hunter, enum LoggerDetails result) {
-    if (!LOGGING) return;
     printf("[HUNTER REVIEW] [%s] reviewed evidence and found ", hunter);
     switch (result) {
         case LOG_SUFFICIENT:
@@ -72,7 +79,6 @@ void l_hunterReview(char* hunter, enum LoggerDetails result) {
     in: room - the room name to log
 */
 void l_hunterCollect(char* hunter, enum EvidenceType evidence, char* room) {
-    if (!LOGGING) return;
     char ev_str[MAX_STR];
     evidenceToString(evidence, ev_str);
     printf("[HUNTER EVIDENCE] [%s] found [%s] in [%s] and [COLLECTED]\n", hunter, ev_str, room);
@@ -83,7 +89,6 @@ void l_hunterCollect(char* hunter, enum EvidenceType evidence, char* room) {
     in: room - the room name to log
 */
 void l_ghostMove(char* room) {
-    if (!LOGGING) return;
     printf("[GHOST MOVE] Ghost has moved into [%s]\n", room);
 }
 
@@ -92,7 +97,6 @@ void l_ghostMove(char* room) {
     in: reason - the reason for exiting, either LOG_FEAR, LOG_BORED, or LOG_EVIDENCE
 */
 void l_ghostExit(enum LoggerDetails reason) {
-    if (!LOGGING) return;
     printf("[GHOST EXIT] Exited because ");
     switch (reason) {
         case LOG_FEAR:
@@ -115,7 +119,6 @@ void l_ghostExit(enum LoggerDetails reason) {
     in: room - the room name to log
 */
 void l_ghostEvidence(enum EvidenceType evidence, char* room) {
-    if (!LOGGING) return;
     char ev_str[MAX_STR];
     evidenceToString(evidence, ev_str);
     printf("[GHOST EVIDENCE] Ghost left [%s] in [%s]\n", ev_str, room);
@@ -127,8 +130,53 @@ void l_ghostEvidence(enum EvidenceType evidence, char* room) {
     in: room - the room name that the ghost is starting in
 */
 void l_ghostInit(enum GhostClass ghost, char* room) {
-    if (!LOGGING) return;
     char ghost_str[MAX_STR];
     ghostToString(ghost, ghost_str);
     printf("[GHOST INIT] Ghost is a [%s] in room [%s]\n", ghost_str, room);
-}
\ No newline at end of file
+}
+/*
+    Sets the runtime log filters from a specification: "all", "none", or a comma separated list of categories,
+    each optionally followed by /N to log only 1 in N of its events, e.g. "hunter-exit,ghost-move/100".
+    in: spec - the specification
+    return: C_TRUE if the specification is valid, C_FALSE otherwise, leaving the filters unchanged
+*/
+int parseLogSpec(const char *spec) {
+    unsigned int mask = 0;
+    unsigned int sample[LOG_CATEGORY_COUNT] = {0};
+    if (strcmp(spec, "all") == 0) {
+        mask = (1u << LOG_CATEGORY_COUNT) - 1;
+    } else if (strcmp(spec, "none") != 0) {
+        // Parse each comma separated category
+        char copy[MAX_STR * 4];
+        if (strlen(spec) >= sizeof(copy)) {
+            return C_FALSE;
+        }
+        strcpy(copy, spec);
+        for (char *item = strtok(copy, ","); item != NULL; item = strtok(NULL, ",")) {
+            // Split off the sampling rate
+            int rate = 1;
+            char *slash = strchr(item, '/');
+            if (slash != NULL) {
+                *slash = '\0';
+                rate = atoi(slash + 1);
+                if (rate < 1) {
+                    return C_FALSE;
+                }
+            }
+            int category = 0;
+            while (category < LOG_CATEGORY_COUNT && strcmp(item, logNames[category]) != 0) {
+                category++;
+            }
+            if (category == LOG_CATEGORY_COUNT) {
+                return C_FALSE;
+            }
+            mask |= 1u << category;
+            sample[category] = rate;
+        }
+    }
+
+    // Only change the filters once the whole specification is valid
+    logMask = mask;
+    memcpy(logSample, sample, sizeof(logSample));
+    return C_TRUE;
+}
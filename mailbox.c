@@ -0,0 +1,80 @@
+#include "defs.h"
+
+
+/*
+    Function: initMailbox
+    Purpose: Initializes an empty mailbox, whose only link is its stub node.
+    Params:
+        Input: MailboxType *mailbox (out) - the mailbox to initialize
+        Output: void
+*/
+void initMailbox(MailboxType *mailbox) {
+    atomic_init(&mailbox->stub.next, NULL);
+    atomic_init(&mailbox->head, &mailbox->stub);
+    mailbox->tail = &mailbox->stub;
+    atomic_init(&mailbox->count, 0);
+}
+
+
+/*
+    Function: postMail
+    Purpose: Posts a node to a mailbox. Any number of threads may post at once, and none of them ever waits.
+    Params:
+        Input:
+            MailboxType *mailbox (in/out) - the mailbox to post to
+            MailNodeType *node (in) - the node to post, which must not be in any mailbox
+        Output: void
+*/
+void postMail(MailboxType *mailbox, MailNodeType *node) {
+    atomic_store_explicit(&node->next, NULL, memory_order_relaxed);
+    // Claim the last place with one exchange, then link the previous node to it
+    MailNodeType *previous = atomic_exchange_explicit(&mailbox->head, node, memory_order_acq_rel);
+    atomic_store_explicit(&previous->next, node, memory_order_release);
+    atomic_fetch_add_explicit(&mailbox->count, 1, memory_order_relaxed);
+}
+
+
+/*
+    Function: takeMail
+    Purpose: Takes the oldest node from a mailbox. Only the thread that owns the mailbox may call this.
+    Params:
+        Input: MailboxType *mailbox (in/out) - the mailbox to take from
+        Output: MailNodeType* - the oldest node, or NULL if the mailbox is empty or a sender is still linking its node
+*/
+MailNodeType *takeMail(MailboxType *mailbox) {
+    MailNodeType *tail = mailbox->tail;
+    MailNodeType *next = atomic_load_explicit(&tail->next, memory_order_acquire);
+
+    // Step over the stub, which is never handed out
+    if (tail == &mailbox->stub) {
+        if (next == NULL) {
+            return NULL;
+        }
+        mailbox->tail = next;
+        tail = next;
+        next = atomic_load_explicit(&tail->next, memory_order_acquire);
+    }
+
+    // Another node follows, so the tail can be handed out
+    if (next != NULL) {
+        mailbox->tail = next;
+        atomic_fetch_sub_explicit(&mailbox->count, 1, memory_order_relaxed);
+        return tail;
+    }
+
+    // A sender has claimed a later place but not linked it yet, try again later
+    if (tail != atomic_load_explicit(&mailbox->head, memory_order_acquire)) {
+        return NULL;
+    }
+
+    // The tail is the last node, so put the stub behind it before handing it out
+    postMail(mailbox, &mailbox->stub);
+    atomic_fetch_sub_explicit(&mailbox->count, 1, memory_order_relaxed);
+    next = atomic_load_explicit(&tail->next, memory_order_acquire);
+    if (next != NULL) {
+        mailbox->tail = next;
+        atomic_fetch_sub_explicit(&mailbox->count, 1, memory_order_relaxed);
+        return tail;
+    }
+    return NULL;
+}
@@ -1,4 +1,10 @@
 #include "defs.h"
+#include <signal.h> // for sigaction
+
+// The hunt currently being simulated, so an interrupt can cancel it
+static HouseType *volatile activeHouse = NULL;
+// Set by an interrupt, so batches and sweeps stop starting new hunts
+static volatile sig_atomic_t interrupted = 0;
 
 
 /*
@@ -15,35 +21,37 @@ void printHouse(HouseType *house) {
     // Print a header for the list of hunters who exited due to high fear
     printf("\nHunters with fear >= FEAR_MAX:\n");
     // If there are no hunters who exited due to high fear, print "None"
-    if (house->huntersExitedFear->size == 0) {
+    if (house->huntersExitedFear.size == 0) {
         printf("None\n");
     } else {
         // Otherwise, iterate over the list of hunters who exited due to high fear
-        for (int i = 0; i < house->huntersExitedFear->size; i++) {
+        for (int i = 0; i < house->huntersExitedFear.size; i++) {
             // Print the name of each hunter who exited due to high fear
-            printf("[%s]\n", house->huntersExitedFear->hunters[i]->name);
+            printf("[%s]\n", house->huntersExitedFear.hunters[i]->name);
         }
     }
 
     // Print a header for the list of hunters who exited due to high boredom
     printf("\nHunters with boredom >= BOREDOM_MAX:\n");
     // If there are no hunters who exited due to high boredom, print "None"
-    if (house->huntersExitedBoredom->size == 0) {
+    if (house->huntersExitedBoredom.size == 0) {
         printf("None\n");
     } else {
         // Otherwise, iterate over the list of hunters who exited due to high boredom
-        for (int i = 0; i < house->huntersExitedBoredom->size; i++) {
+        for (int i = 0; i < house->huntersExitedBoredom.size; i++) {
             // Print the name of each hunter who exited due to high boredom
-            printf("[%s]\n", house->huntersExitedBoredom->hunters[i]->name);
+            printf("[%s]\n", house->huntersExitedBoredom.hunters[i]->name);
         }
     }
 
-    // If the total number of hunters who exited due to high fear or boredom is less than the total number of hunters
-    if (house->huntersExitedBoredom->size + house->huntersExitedFear->size < NUM_HUNTERS) {
+    // If the hunt was interrupted before its outcome was decided
+    if (atomic_load(&house->state) == HUNT_CANCELLED) {
+        printf("\nThe hunt was cancelled before it was decided.\n");
+    } else if (atomic_load(&house->state) == HUNT_HUNTERS_WON) {
         // Print a message indicating that the hunters have won
         printf("\nThe hunters have won! The ghost has been correctly identified!\n");
     } else {
-        // Otherwise, print a message indicating that the ghost has won
+        // Otherwise every hunter exited because of fear or boredom, so print a message indicating that the ghost has won
         printf("\nThe ghost has won! All hunters have exited because high of fear or boredom.\n");
     }
 
@@ -58,6 +66,28 @@ void printHouse(HouseType *house) {
         printf("[%s]\n", evidenceStr);
     }
 
+    // Print the memory the house took, which bounds how many houses fit in memory at once
+    printf("\nHouse Footprint: %zu bytes, %zu of them the house itself\n", houseFootprint(house), sizeof(HouseType));
+
+    // Print the most evidence each room held at once, and what it forgot when full
+    printf("\nPeak Evidence per Room (at most %d %s):\n", house->config->evidenceCap,
+           house->config->evidencePolicy == EVIDENCE_OLDEST ? "per room, oldest forgotten first" : "of each type per room");
+    int held = 0;
+    for (int i = 0; i < house->rooms.count; i++) {
+        RoomType *room = house->roomTable[i];
+        if (room->evidence.peak > 0) {
+            printf("[%s] %d", room->name, room->evidence.peak);
+            if (room->evidence.discarded > 0) {
+                printf(", %lld forgotten", room->evidence.discarded);
+            }
+            printf("\n");
+            held++;
+        }
+    }
+    if (held == 0) {
+        printf("None\n");
+    }
+
     // Initialize a string to hold the matching ghost type
     char ghostMatchStr[16] = "Unknown"; 
     // If there are at least three different pieces of evidence
@@ -72,6 +102,14 @@ void printHouse(HouseType *house) {
         printf("\nInsufficient evidence to match the ghost. Need at least three different pieces.\n");
     }
 
+    // Print the radio traffic when the hunters used radios
+    if (house->radios != NULL) {
+        printf("\n");
+        HuntResultType result;
+        summarizeHunt(house, &result);
+        printRadio(result.radioSent, result.radioLost, result.radioDelivered, result.radioLatency, result.radioWaitMicros, result.micros);
+    }
+
     // Get the real ghost type in the house
     GhostType *ghost = getGhostInHouse(house);
     // Convert the real ghost type to a string representation
@@ -86,30 +124,127 @@ void printHouse(HouseType *house) {
 
 
 /*
-    Function: main
-    Purpose: Entry point of the program. Initializes the house, places hunters and the ghost, creates threads for each hunter, and prints the results of the ghost hunt.
-    Params: None
-    Returns: int - status code of the program execution (C_OK)
+    Function: parseOptions
+    Purpose: Parses the command line options into an options structure.
+    Params:
+        Input: 
+            int argc (in) - the number of command line arguments
+            char *argv[] (in) - the command line arguments
+            OptionsType *options (out) - the parsed options
+        Output: int - C_TRUE if the options are valid, C_FALSE otherwise
 */
-int main()
-{
-    // Initialize the random number generator with the current time
-    srand(time(NULL));
+int parseOptions(int argc, char *argv[], OptionsType *options) {
+    // Default to a single interactive hunt, seeded from the clock, with metrics disabled
+    options->runs = 1;
+    options->metricsPath = NULL;
+    options->seed = (unsigned int)time(NULL);
+    options->workers = 0;
+    options->shardSize = SHARD_SIZE;
+    options->ciWidth = 0.0;
+    options->ciMetrics = CI_GHOST_WIN | CI_ACCURACY;
+    options->cachePath = NULL;
+    options->resultsPath = NULL;
+    options->affinity = AFFINITY_NONE;
+    options->heatmap = C_FALSE;
+    options->profile = 0;
+    options->samplesPath = NULL;
+    initConfig(&options->config);
 
-    // Declare a house of type HouseType
-    HouseType house;
-    // Initialize the house
-    initHouse(&house);
-    // Populate the rooms in the house
-    populateRooms(&house);
+    // Loop over the arguments, every option takes a value
+    for (int i = 1; i < argc; i++) {
+        // Every option needs a value after it
+        if (i + 1 >= argc) {
+            return C_FALSE;
+        }
+        char *option = argv[i];
+        char *value = argv[++i];
+        if (strcmp(option, "--runs") == 0) {
+            // Number of hunts to simulate
+            options->runs = atoi(value);
+        } else if (strcmp(option, "--metrics") == 0) {
+            // Path of the metrics file to publish into
+            options->metricsPath = value;
+        } else if (strcmp(option, "--seed") == 0) {
+            // Seed of the first hunt
+            options->seed = (unsigned int)strtoul(value, NULL, 10);
+        } else if (strcmp(option, "--workers") == 0) {
+            // Worker processes to shard the runs over
+            options->workers = atoi(value);
+        } else if (strcmp(option, "--shard") == 0) {
+            // Seeds handed to a worker at a time
+            options->shardSize = atoi(value);
+        } else if (strcmp(option, "--affinity") == 0) {
+            // How worker processes are placed on the machine's CPUs and NUMA nodes
+            options->affinity = strcmp(value, "none") == 0 ? AFFINITY_NONE : strcmp(value, "node") == 0 ? AFFINITY_NODE :
+                                strcmp(value, "core") == 0 ? AFFINITY_CORE : -1;
+        } else if (strcmp(option, "--cache") == 0) {
+            // Result cache to reuse and extend
+            options->cachePath = value;
+        } else if (strcmp(option, "--heatmap") == 0) {
+            // Whether to add up and print the activity of every room
+            options->heatmap = strcmp(value, "on") == 0 ? C_TRUE : strcmp(value, "off") == 0 ? C_FALSE : -1;
+        } else if (strcmp(option, "--profile") == 0) {
+            // Time one in this many phases of the agents' actions, 0 for none
+            options->profile = atoi(value);
+        } else if (strcmp(option, "--results") == 0) {
+            // Columnar results file to append every finished hunt to
+            options->resultsPath = value;
+        } else if (strcmp(option, "--samples") == 0) {
+            // File every hunt's samples are appended to
+            options->samplesPath = value;
+        } else if (strcmp(option, "--sample-every") == 0) {
+            // Ghost ticks between samples
+            options->config.samplePeriod = atoi(value);
+        } else if (strcmp(option, "--sample-stream") == 0) {
+            // Whether a full sample ring is written out during the hunt, or only its latest samples at the end
+            options->config.sampleStream = strcmp(value, "on") == 0 ? C_TRUE : strcmp(value, "off") == 0 ? C_FALSE : -1;
+        } else if (strcmp(option, "--ci-width") == 0) {
+            // Target width of the confidence intervals, --runs becomes the most hunts to run
+            options->ciWidth = atof(value);
+        } else if (strcmp(option, "--ci-metrics") == 0) {
+            // Metrics that must converge: ghost-win, accuracy, or both separated by a comma
+            options->ciMetrics = (strstr(value, "ghost-win") != NULL ? CI_GHOST_WIN : 0) |
+                                 (strstr(value, "accuracy") != NULL ? CI_ACCURACY : 0);
+        } else if (strcmp(option, "--log") == 0) {
+            // Log categories to print, each optionally sampled, e.g. hunter-exit,ghost-move/100
+            if (!parseLogSpec(value)) {
+                return C_FALSE;
+            }
+        } else if (parseConfigOption(&options->config, option, value) == C_FALSE) {
+            // Unknown option
+            return C_FALSE;
+        }
+    }
 
-    // Initialize the ghost and place it randomly in the house
-    initAndPlaceGhostRandomly(&house);
+    // Sampling needs a file to write to, and samples every SAMPLE_PERIOD ticks unless told otherwise
+    if (options->samplesPath != NULL && options->config.samplePeriod == 0) {
+        options->config.samplePeriod = SAMPLE_PERIOD;
+    }
+    if (options->config.samplePeriod != 0 && options->samplesPath == NULL) {
+        return C_FALSE;
+    }
 
-    // Declare an array to hold the names of the hunters
-    char hunterNames[NUM_HUNTERS][MAX_STR];
+    // Reject values the simulation cannot run with
+    if (options->runs < 1 || options->workers < 0 || options->affinity < 0 || options->heatmap < 0 || options->profile < 0 || options->shardSize < 1 || options->ciWidth < 0.0 ||
+        options->config.samplePeriod < 0 || options->config.sampleStream < 0 || options->ciMetrics == 0 || validConfig(&options->config) == C_FALSE) {
+        return C_FALSE;
+    }
+    return C_TRUE;
+}
+
+
+/*
+    Function: readHunterNames
+    Purpose: Prompts the user for a unique name for each hunter.
+    Params:
+        Input: 
+            char hunterNames[][MAX_STR] (out) - the names entered for the hunters
+            int numHunters (in) - the number of hunters
+        Output: void
+*/
+void readHunterNames(char hunterNames[][MAX_STR], int numHunters) {
     // Loop over the number of hunters
-    for (int i = 0; i < NUM_HUNTERS; i++) {
+    for (int i = 0; i < numHunters; i++) {
         while (C_TRUE) {
             // Prompt the user to enter a name for each hunter
             printf("Enter name for hunter %d: ", i + 1);
@@ -128,19 +263,248 @@ int main()
             // If we've gone through all the names and haven't found a duplicate, break the loop
             if (j == i) break;
         }
-        // Initialize the hunters and place them in the van
-        initHunterAndPlaceInVan(house.rooms.head->room, hunterNames[i]);
+    }
+}
+
+
+/*
+    Function: handleInterrupt
+    Purpose: Cancels the running hunt on Ctrl-C, so every agent unwinds and the results so far are printed.
+    Params:
+        Input: int signal (in) - the signal number, unused
+        Output: void
+*/
+void handleInterrupt(int signal) {
+    (void)signal;
+    interrupted = 1;
+    HouseType *house = activeHouse;
+    // Cancelling is a single atomic exchange, which is safe inside a signal handler
+    if (house != NULL) {
+        cancelHunt(house);
+    }
+}
+
+
+/*
+    Function: main
+    Purpose: Entry point of the program. Initializes the house, places hunters and the ghost, creates threads for each hunter, and prints the results of the ghost hunt.
+        With --runs N, simulates N hunts back to back in batch mode, naming the hunters automatically.
+        With --workers N as well, shards the hunts over N worker processes and prints only the merged summary.
+    Params:
+        Input: 
+            int argc (in) - the number of command line arguments
+            char *argv[] (in) - the command line arguments
+    Returns: int - status code of the program execution (C_OK)
+*/
+int main(int argc, char *argv[])
+{
+    // Parse the command line options
+    OptionsType options;
+    if (parseOptions(argc, argv, &options) != C_TRUE) {
+        printf("Usage: %s [--runs N] [--seed S] [--workers N] [--shard N] [--affinity none|node|core] [--metrics FILE] [--cache FILE]\n"
+               "          [--results FILE] [--samples FILE] [--sample-every N] [--sample-stream on|off] [--heatmap on|off] [--profile N] [--ci-width W] [--ci-metrics ghost-win,accuracy] [--log all|none|CATEGORY[/N],...]\n"
+               "          [--hunters N] [--fear-max N] [--boredom-max N] [--delay USEC] [--wake delay|event]\n"
+               "          [--engine threads|actor|lockstep|tasks] [--room-owners N] [--step-threads N] [--task-threads N]\n"
+               "          [--policy random|directed] [--map house|grid:WxH]\n"
+               "          [--evidence-cap N] [--evidence-policy oldest|coalesce]\n"
+               "          [--radio on|off] [--radio-latency N] [--radio-loss PERCENT] [--radio-bandwidth N] [--radio-interval N]\n", argv[0]);
+        return EXIT_FAILURE;
+    }
+
+    // Initialize the random number generator with the current time
+    srand(time(NULL));
+
+    // Cancel the running hunt rather than killing the program on Ctrl-C
+    struct sigaction interrupt;
+    memset(&interrupt, 0, sizeof(interrupt));
+    interrupt.sa_handler = handleInterrupt;
+    sigaction(SIGINT, &interrupt, NULL);
+
+    // Map the metrics file if one was requested
+    MetricsType *metrics = NULL;
+    if (options.metricsPath != NULL) {
+        metrics = openMetrics(options.metricsPath);
+        if (metrics == NULL) {
+            return EXIT_FAILURE;
+        }
+    }
+
+    // Check the result cache can be used before simulating anything
+    CacheType *cache = NULL;
+    if (options.cachePath != NULL) {
+        cache = openCache(options.cachePath);
+        if (cache == NULL) {
+            closeMetrics(metrics);
+            return EXIT_FAILURE;
+        }
+    }
+
+    // Create or check the results file before simulating anything, too
+    ResultsWriterType *results = NULL;
+    if (options.resultsPath != NULL) {
+        results = openResults(options.resultsPath);
+        if (results == NULL) {
+            closeCache(cache);
+            closeMetrics(metrics);
+            return EXIT_FAILURE;
+        }
+    }
+
+    // Open the samples file as well, worker processes inherit it and append to it
+    if (options.samplesPath != NULL && openSamples(options.samplesPath) == C_FALSE) {
+        closeResults(results);
+        closeCache(cache);
+        closeMetrics(metrics);
+        return EXIT_FAILURE;
     }
 
-    // Create threads for the hunters and the ghost
-    createThreads(&house, hunterNames, NUM_HUNTERS);
-    // Print the results of the ghost hunt
-    printHouse(&house);
+    // Distributions of the batch, too large for the stack and the same size whatever the number of hunts
+    DistributionsType *distributions = calloc(1, sizeof(DistributionsType));
+    // Room activity, when asked for
+    HeatmapType *heatmap = options.heatmap ? calloc(1, sizeof(HeatmapType)) : NULL;
+    // Timing of the agents' actions, when asked for
+    ProfileType *timing = options.profile > 0 ? calloc(1, sizeof(ProfileType)) : NULL;
+    if (timing != NULL) {
+        startProfile(timing, options.profile);
+    }
 
-    // Clean the allocated house memory
-    cleanHouse(&house);
-    // cleanHunterList(&house.hunters);
+    // Shard the runs over worker processes when asked to, each opening the cache and the results file for itself
+    if (options.workers > 0) {
+        closeCache(cache);
+        closeResults(results);
+        SweepSummaryType summary;
+        if (runCoordinator(&options, metrics, &interrupted, &summary, distributions, heatmap) == C_FALSE) {
+            free(distributions);
+            free(heatmap);
+            free(timing);
+            closeSamples();
+            closeMetrics(metrics);
+            return EXIT_FAILURE;
+        }
+        printSweepSummary(&summary);
+        printDistributions(distributions);
+        if (heatmap != NULL) {
+            printHeatmap(heatmap, &options.config);
+        }
+        if (timing != NULL) {
+            printProfile(timing);
+        }
+        free(distributions);
+        free(heatmap);
+        free(timing);
+        closeSamples();
+        closeMetrics(metrics);
+        return C_OK;
+    }
+
+    // Declare an array to hold the names of the hunters
+    char hunterNames[options.config.hunters][MAX_STR];
+    if (options.runs == 1) {
+        // A single hunt asks the user for the names
+        readHunterNames(hunterNames, options.config.hunters);
+    } else {
+        // Batch mode runs unattended, so number the hunters instead
+        nameHunters(hunterNames, options.config.hunters);
+    }
+
+    // Simulate each hunt in turn, summarizing them when there are several
+    SweepSummaryType summary;
+    initSweepSummary(&summary);
+    // Memory of the houses simulated, to tell how many could be held at once
+    long long footprintTotal = 0;
+    size_t footprintLargest = 0;
+    int houses = 0;
+    for (int run = 0; run < options.runs && !interrupted; run++) {
+        // Stop early once the estimates are good enough
+        if (sweepConverged(&summary, options.ciWidth, options.ciMetrics)) {
+            break;
+        }
+        if (options.runs > 1) {
+            printf("\n=== Run %d of %d (seed %u) ===\n", run + 1, options.runs, options.seed + run);
+        }
+
+        // Reuse the outcome of a hunt simulated before, there is no house left to print
+        HuntResultType result;
+        uint64_t key = 0;
+        if (cache != NULL) {
+            key = cacheKey(&options.config, cache->mapHash, options.seed + run);
+            // A sampled hunt is always played, as a cached outcome has no samples, but its outcome is still stored
+            if (options.config.samplePeriod <= 0 && lookupCache(cache, key, &result) == C_TRUE) {
+                result.cached = C_TRUE;
+                printf("Cached result: the %s won\n", result.outcome == HUNT_HUNTERS_WON ? "hunters" : "ghost");
+                addHuntResult(&summary, &result);
+                addResult(results, &result);
+                metricsAdd(metrics, MET_RUNS_COMPLETED, 1);
+                continue;
+            }
+        }
+
+        // Build the house, with the ghost and the hunters in the van, from the hunt's seed
+        HouseType house;
+        setupHunt(&house, &options.config, options.seed + run, hunterNames, metrics);
+        if (heatmap != NULL) {
+            trackHeat(&house);
+        }
+
+        // Simulate the hunt with the chosen engine, which returns once the outcome is decided
+        activeHouse = &house;
+        simulateHunt(&house);
+        activeHouse = NULL;
+        // Print the results of the ghost hunt
+        printHouse(&house);
+
+        // Record the outcome, an interrupted hunt is not counted
+        summarizeHunt(&house, &result);
+        recordHunt(distributions, &house);
+        addHeat(heatmap, &house);
+        writeSamples(&house);
+        size_t footprint = houseFootprint(&house);
+        footprintTotal += footprint;
+        footprintLargest = footprint > footprintLargest ? footprint : footprintLargest;
+        houses++;
+        // Clean the allocated house memory
+        cleanHouse(&house);
+        if (result.outcome == HUNT_CANCELLED) {
+            break;
+        }
+        addHuntResult(&summary, &result);
+        addResult(results, &result);
+        // Keep the outcome for the next batch over the same seeds
+        if (cache != NULL) {
+            storeCache(cache, key, &result);
+        }
+        // Count the finished hunt
+        metricsAdd(metrics, MET_RUNS_COMPLETED, 1);
+    }
+    // Stop the task pool, if a hunt started it, so its threads add what they timed to the profile
+    stopTasks();
+    if (options.runs > 1) {
+        printSweepSummary(&summary);
+        if (houses > 0) {
+            printf("Bytes per house:   mean %lld, largest %zu\n", footprintTotal / houses, footprintLargest);
+        }
+        printDistributions(distributions);
+    }
+    // A single hunt has its room activity printed too
+    if (heatmap != NULL) {
+        printHeatmap(heatmap, &options.config);
+    }
+    if (timing != NULL) {
+        printProfile(timing);
+    }
+    free(distributions);
+    free(heatmap);
+    free(timing);
+
+    // Unmap the metrics file, leaving the final values for readers
+    closeMetrics(metrics);
+    closeCache(cache);
+    // Append the hunts still buffered
+    closeResults(results);
+    closeSamples();
+    // Free the next-hop tables built for directed movement
+    cleanRouteCache();
 
     // Return C_OK to indicate successful execution
     return C_OK;
-}
\ No newline at end of file
+}
@@ -0,0 +1,142 @@
+#include "defs.h"
+#include <fcntl.h>    // for open
+#include <sys/mman.h> // for mmap and munmap
+#include <sys/stat.h> // for fstat
+#include <time.h>     // for time
+
+
+/*
+    Function: openMetrics
+    Purpose: Creates (or resets) a metrics file and maps it so the simulator can publish counters into it. The file is never
+        truncated to less than a metrics structure, so a reader still attached from a previous run never maps past its end.
+    Params:
+        Input: const char *path (in) - the path of the metrics file
+        Output: MetricsType* - the mapped metrics with every counter at zero, or NULL if the file could not be mapped
+*/
+MetricsType *openMetrics(const char *path) {
+    // Create the file, readable by anyone so fp-top can run as another user
+    int fd = open(path, O_RDWR | O_CREAT, 0644);
+    if (fd < 0) {
+        perror(path);
+        return NULL;
+    }
+
+    // Size the file to hold exactly one metrics structure
+    if (ftruncate(fd, sizeof(MetricsType)) != 0) {
+        perror(path);
+        close(fd);
+        return NULL;
+    }
+
+    // Map the file shared so every update is visible to readers without any extra work
+    MetricsType *metrics = mmap(NULL, sizeof(MetricsType), PROT_READ | PROT_WRITE, MAP_SHARED, fd, 0);
+    // The mapping stays valid after the descriptor is closed
+    close(fd);
+    if (metrics == MAP_FAILED) {
+        perror(path);
+        return NULL;
+    }
+
+    // Reset the counters of a previous run through the mapping, hiding the file from new readers until the header is back
+    metrics->magic = 0;
+    atomic_thread_fence(memory_order_release);
+    memset(metrics, 0, sizeof(MetricsType));
+    metrics->version = METRICS_VERSION;
+    metrics->pid = getpid();
+    metrics->counterCount = MET_COUNT;
+    metrics->startTime = time(NULL);
+    // Publish the magic last, so a reader never sees a half-written header as valid
+    atomic_thread_fence(memory_order_release);
+    metrics->magic = METRICS_MAGIC;
+
+    return metrics;
+}
+
+
+/*
+    Function: attachMetrics
+    Purpose: Maps an existing metrics file read-only, for readers such as fp-top.
+    Params:
+        Input: const char *path (in) - the path of the metrics file
+        Output: MetricsType* - the mapped metrics, or NULL if the file is missing or not a metrics file
+*/
+MetricsType *attachMetrics(const char *path) {
+    // Open the file read-only, readers never modify the counters
+    int fd = open(path, O_RDONLY);
+    if (fd < 0) {
+        return NULL;
+    }
+
+    // Map the file only if it holds a whole metrics structure, as mapping past its end would fault on the first read
+    struct stat info;
+    if (fstat(fd, &info) != 0 || info.st_size < (off_t)sizeof(MetricsType)) {
+        close(fd);
+        return NULL;
+    }
+    MetricsType *metrics = mmap(NULL, sizeof(MetricsType), PROT_READ, MAP_SHARED, fd, 0);
+    close(fd);
+    if (metrics == MAP_FAILED) {
+        return NULL;
+    }
+
+    // Reject files from another program or another layout
+    if (metrics->magic != METRICS_MAGIC || metrics->version != METRICS_VERSION || metrics->counterCount != MET_COUNT) {
+        munmap(metrics, sizeof(MetricsType));
+        return NULL;
+    }
+
+    return metrics;
+}
+
+
+/*
+    Function: closeMetrics
+    Purpose: Unmaps a metrics file, leaving its final values on disk.
+    Params:
+        Input: MetricsType *metrics (in) - the metrics to unmap, may be NULL
+        Output: void
+*/
+void closeMetrics(MetricsType *metrics) {
+    if (metrics != NULL) {
+        munmap(metrics, sizeof(MetricsType));
+    }
+}
+
+
+/*
+    Function: metricName
+    Purpose: Returns the display name of a metrics counter.
+    Params:
+        Input: enum MetricCounter counter (in) - the counter to name
+        Output: const char* - the name of the counter
+*/
+const char *metricName(enum MetricCounter counter) {
+    // Names in the same order as enum MetricCounter
+    static const char *names[MET_COUNT] = {
+        "ticks",
+        "hunter collect",
+        "hunter move",
+        "hunter review",
+        "ghost evidence",
+        "ghost move",
+        "ghost idle",
+        "hunters alive",
+        "collected EMF",
+        "collected TEMPERATURE",
+        "collected FINGERPRINTS",
+        "collected SOUND",
+        "room lock waits",
+        "radio sent",
+        "radio lost",
+        "radio delivered",
+        "event wakeups",
+        "idle periods skipped",
+        "runs completed"
+    };
+
+    // Guard against counters from a newer writer
+    if (counter < 0 || counter >= MET_COUNT) {
+        return "unknown";
+    }
+    return names[counter];
+}
@@ -0,0 +1,181 @@
+#include "defs.h"
+
+ProfileType *profile = NULL;
+__thread unsigned int profileGap = 0;
+
+// State of the calling thread's draws of the gaps between samples, apart from the hunt's own random numbers
+static __thread uint64_t gapState = 0;
+// Phases timed by the calling thread since it last flushed them into the profile
+static __thread PhaseProfileType threadPhases[PROF_COUNT];
+// Serializes threads flushing into the profile, which each do once when they finish
+static pthread_mutex_t profileLock = PTHREAD_MUTEX_INITIALIZER;
+
+
+/*
+    Function: startProfile
+    Purpose: Starts timing the agents' actions into a zeroed profile, sampling one phase in a given number per thread.
+    Params:
+        Input:
+            ProfileType *target (in/out) - the profile to time into, zeroed
+            int period (in) - one phase in this many is timed, 1 to time every phase
+        Output: void
+*/
+void startProfile(ProfileType *target, int period) {
+    target->period = period;
+    target->startNanos = monotonicNanos();
+    target->startClock = profileClock();
+    profile = target;
+}
+
+
+/*
+    Function: nextProfileGap
+    Purpose: Draws the number of phases until the calling thread times the next one, from 1 to 2 * period - 1 so the gaps
+        average the period. A fixed gap would keep landing on the same phase of an agent's loop, and never time the others.
+    Params:
+        Output: unsigned int - the phases until the next sample, counting it
+*/
+unsigned int nextProfileGap() {
+    if (profile->period <= 1) {
+        return 1;
+    }
+    // xorshift64, seeded from the thread's own address so every thread draws differently
+    if (gapState == 0) {
+        gapState = (uint64_t)(uintptr_t)&gapState | 1;
+    }
+    gapState ^= gapState << 13;
+    gapState ^= gapState >> 7;
+    gapState ^= gapState << 17;
+    return 1 + (unsigned int)(gapState % (2 * (uint64_t)profile->period - 1));
+}
+
+
+/*
+    Function: recordPhase
+    Purpose: Counts one timed phase in the calling thread's own profile, so taking a sample never touches shared memory.
+    Params:
+        Input:
+            enum ProfilePhase phase (in) - the phase timed
+            uint64_t ticks (in) - the clock ticks it took
+        Output: void
+*/
+void recordPhase(enum ProfilePhase phase, uint64_t ticks) {
+    PhaseProfileType *timed = &threadPhases[phase];
+    int bucket = 63 - __builtin_clzll(ticks | 1);
+    timed->count++;
+    timed->ticks += ticks;
+    timed->buckets[bucket < PROFILE_BUCKETS ? bucket : PROFILE_BUCKETS - 1]++;
+}
+
+
+/*
+    Function: flushProfile
+    Purpose: Adds the phases the calling thread timed to the profile, and starts the thread's own counts over. Every thread
+        that acts for agents calls it once as it finishes.
+    Params:
+        Output: void
+*/
+void flushProfile() {
+    if (profile == NULL) {
+        return;
+    }
+    pthread_mutex_lock(&profileLock);
+    for (int phase = 0; phase < PROF_COUNT; phase++) {
+        PhaseProfileType *into = &profile->phases[phase];
+        into->count += threadPhases[phase].count;
+        into->ticks += threadPhases[phase].ticks;
+        for (int bucket = 0; bucket < PROFILE_BUCKETS; bucket++) {
+            into->buckets[bucket] += threadPhases[phase].buckets[bucket];
+        }
+    }
+    pthread_mutex_unlock(&profileLock);
+    memset(threadPhases, 0, sizeof(threadPhases));
+}
+
+
+/*
+    Function: mergeProfile
+    Purpose: Adds every phase timed in one profile to another, such as a worker's into the sweep's.
+    Params:
+        Input:
+            ProfileType *into (in/out) - the profile to add to
+            const ProfileType *from (in) - the profile to add
+        Output: void
+*/
+void mergeProfile(ProfileType *into, const ProfileType *from) {
+    for (int phase = 0; phase < PROF_COUNT; phase++) {
+        into->phases[phase].count += from->phases[phase].count;
+        into->phases[phase].ticks += from->phases[phase].ticks;
+        for (int bucket = 0; bucket < PROFILE_BUCKETS; bucket++) {
+            into->phases[phase].buckets[bucket] += from->phases[phase].buckets[bucket];
+        }
+    }
+}
+
+
+/*
+    Function: phasePercentile
+    Purpose: Finds the upper bound of the bucket holding a percentile of a phase's samples.
+    Params:
+        Input:
+            const PhaseProfileType *timed (in) - the phase
+            double percentile (in) - the percentage, from 0 to 100
+        Output: double - the upper bound, in clock ticks
+*/
+static double phasePercentile(const PhaseProfileType *timed, double percentile) {
+    long long rank = (long long)(percentile / 100.0 * timed->count + 0.5);
+    rank = rank < 1 ? 1 : rank;
+    long long seen = 0;
+    for (int bucket = 0; bucket < PROFILE_BUCKETS; bucket++) {
+        seen += timed->buckets[bucket];
+        if (seen >= rank) {
+            return (double)(2ULL << bucket) - 1;
+        }
+    }
+    return 0.0;
+}
+
+
+/*
+    Function: printProfile
+    Purpose: Prints the breakdown of the agents' actions by phase: samples, estimated calls, mean and percentile durations, and
+        each phase's share of the sampled time. Ticks are turned into nanoseconds by the clock's rate over the profiled run.
+    Params:
+        Input: const ProfileType *target (in) - the profile to print
+        Output: void
+*/
+void printProfile(const ProfileType *target) {
+    // Phase names in the same order as enum ProfilePhase
+    static const char *names[PROF_COUNT] = {
+        "hunter lock wait",
+        "hunter fear/boredom",
+        "hunter collect",
+        "hunter move",
+        "hunter review",
+        "ghost room scan",
+        "ghost decide",
+        "ghost evidence drop",
+        "ghost move"
+    };
+
+    long long nanos = monotonicNanos() - target->startNanos;
+    double ticksPerNano = nanos > 0 ? (double)(profileClock() - target->startClock) / nanos : 1.0;
+    ticksPerNano = ticksPerNano > 0.0 ? ticksPerNano : 1.0;
+    long long totalTicks = 0;
+    for (int phase = 0; phase < PROF_COUNT; phase++) {
+        totalTicks += target->phases[phase].ticks;
+    }
+
+    printf("\n=== Profile, 1 in %d phases timed, %.2f clock ticks per ns ===\n", target->period, ticksPerNano);
+    printf("%-22s %10s %12s %10s %10s %10s %7s\n", "phase", "samples", "est. calls", "mean ns", "p50 ns <=", "p99 ns <=", "share");
+    for (int phase = 0; phase < PROF_COUNT; phase++) {
+        const PhaseProfileType *timed = &target->phases[phase];
+        if (timed->count == 0) {
+            printf("%-22s %10d\n", names[phase], 0);
+            continue;
+        }
+        printf("%-22s %10lld %12lld %10.1f %10.0f %10.0f %6.1f%%\n", names[phase], timed->count, timed->count * target->period,
+               timed->ticks / ticksPerNano / timed->count, phasePercentile(timed, 50.0) / ticksPerNano,
+               phasePercentile(timed, 99.0) / ticksPerNano, totalTicks > 0 ? 100.0 * timed->ticks / totalTicks : 0.0);
+    }
+}
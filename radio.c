@@ -0,0 +1,179 @@
+#include "defs.h"
+
+
+/*
+    Function: setupRadios
+    Purpose: Gives every hunter a radio when the hunt's config turns the radio network on. The house owns the radios, so
+        reports can still be sent to and returned by hunters that have left.
+    Params:
+        Input: HouseType *house (in/out) - the house where the hunters are
+        Output: void
+*/
+void setupRadios(HouseType *house) {
+    if (!house->config->radio) {
+        return;
+    }
+
+    house->radios = calloc(house->config->hunters, sizeof(RadioType));
+    for (int i = 0; i < house->config->hunters; i++) {
+        RadioType *radio = &house->radios[i];
+        initMailbox(&radio->inbox);
+        initMailbox(&radio->spares);
+        atomic_init(&radio->listening, C_TRUE);
+        radio->index = i;
+        // Tune in the hunter with the same id
+        house->registry.table[i].radio = radio;
+    }
+}
+
+
+/*
+    Function: cleanRadios
+    Purpose: Frees every radio of a house along with every report ever sent, wherever it ended up.
+    Params:
+        Input: HouseType *house (in/out) - the house whose radios to free
+        Output: void
+*/
+void cleanRadios(HouseType *house) {
+    if (house->radios == NULL) {
+        return;
+    }
+
+    // Every report is on its sender's allocated list, whichever mailbox it is in
+    for (int i = 0; i < house->config->hunters; i++) {
+        RadioReportType *report = house->radios[i].allocated;
+        while (report != NULL) {
+            RadioReportType *next = report->next;
+            free(report);
+            report = next;
+        }
+    }
+    free(house->radios);
+    house->radios = NULL;
+}
+
+
+/*
+    Function: broadcastReport
+    Purpose: Sends what a hunter knows to every other hunter still in the house. Each report may be lost on the air.
+    Params:
+        Input:
+            HouseType *house (in) - the house where the hunters are
+            RadioType *radio (in/out) - the sender's radio
+        Output: void
+*/
+void broadcastReport(HouseType *house, RadioType *radio) {
+    for (int i = 0; i < house->config->hunters; i++) {
+        RadioType *receiver = &house->radios[i];
+        if (receiver == radio || !atomic_load_explicit(&receiver->listening, memory_order_relaxed)) {
+            continue;
+        }
+
+        radio->sent++;
+        metricsAdd(house->metrics, MET_RADIO_SENT, 1);
+        // Drop the report on the air with the configured probability
+        if (randInt(0, 100) < house->config->radioLoss) {
+            radio->lost++;
+            metricsAdd(house->metrics, MET_RADIO_LOST, 1);
+            continue;
+        }
+
+        // Reuse a report a receiver has handed back, or allocate a new one
+        RadioReportType *report = (RadioReportType *)takeMail(&radio->spares);
+        if (report == NULL) {
+            report = malloc(sizeof(RadioReportType));
+            report->next = radio->allocated;
+            radio->allocated = report;
+        }
+        report->sender = radio->index;
+        report->knowledge = radio->knowledge;
+        report->sentAt = monotonicNanos();
+        postMail(&receiver->inbox, &report->node);
+    }
+}
+
+
+/*
+    Function: runRadio
+    Purpose: Advances a hunter's radio by one action: takes in the reports that have waited out their latency, up to the bandwidth,
+        and sends a status report when one is due.
+    Params:
+        Input:
+            HouseType *house (in) - the house where the hunter is
+            RadioType *radio (in/out) - the hunter's radio
+        Output: void
+*/
+void runRadio(HouseType *house, RadioType *radio) {
+    const ConfigType *config = house->config;
+    radio->actions++;
+
+    // Queue up what has reached the radio since the last action, only taking what is there now
+    int waiting = atomic_load_explicit(&radio->inbox.count, memory_order_relaxed);
+    for (int i = 0; i < waiting; i++) {
+        RadioReportType *report = (RadioReportType *)takeMail(&radio->inbox);
+        if (report == NULL) {
+            break;
+        }
+        report->arrivedAt = radio->actions;
+        report->pending = NULL;
+        if (radio->pendingTail == NULL) {
+            radio->pendingHead = report;
+        } else {
+            radio->pendingTail->pending = report;
+        }
+        radio->pendingTail = report;
+    }
+
+    // Take in the oldest reports whose latency has passed, no more than the bandwidth allows
+    long long now = 0;
+    for (int i = 0; i < config->radioBandwidth && radio->pendingHead != NULL; i++) {
+        RadioReportType *report = radio->pendingHead;
+        if (radio->actions - report->arrivedAt < config->radioLatency) {
+            break;
+        }
+        radio->pendingHead = report->pending;
+        if (radio->pendingHead == NULL) {
+            radio->pendingTail = NULL;
+        }
+
+        // Learn what the sender knew, and time the report
+        radio->knowledge |= report->knowledge;
+        if (now == 0) {
+            now = monotonicNanos();
+        }
+        radio->delivered++;
+        radio->latency += radio->actions - report->arrivedAt;
+        radio->waitNanos += now - report->sentAt;
+        metricsAdd(house->metrics, MET_RADIO_DELIVERED, 1);
+        // Hand the report back to its sender for reuse
+        postMail(&house->radios[report->sender].spares, &report->node);
+    }
+
+    // Send a status report every few actions, once there is something to say
+    if (config->radioInterval > 0 && radio->knowledge != 0 && radio->actions % config->radioInterval == 0) {
+        broadcastReport(house, radio);
+    }
+}
+
+
+/*
+    Function: printRadio
+    Purpose: Prints the traffic of the radio network: reports sent and lost, throughput, and delivery latency.
+    Params:
+        Input:
+            long long sent (in) - reports put on the air
+            long long lost (in) - reports lost on the air
+            long long delivered (in) - reports taken in by their receiver
+            long long latency (in) - actions the delivered reports waited in total
+            long long waitMicros (in) - microseconds the delivered reports took to be taken in, in total
+            long long micros (in) - wall-clock microseconds spent simulating
+        Output: void
+*/
+void printRadio(long long sent, long long lost, long long delivered, long long latency, long long waitMicros, long long micros) {
+    // Avoid dividing by zero when nothing was delivered
+    double count = delivered > 0 ? (double)delivered : 1.0;
+    double seconds = micros > 0 ? micros / 1e6 : 1.0;
+    printf("Radio reports:     %lld sent, %lld lost (%.1f%%), %lld delivered\n", sent, lost, 100.0 * lost / (sent > 0 ? sent : 1), delivered);
+    printf("Radio throughput:  %.0f reports/s\n", delivered / seconds);
+    printf("Radio latency:     %.2f actions, %.1f us\n", latency / count, waitMicros / count);
+}
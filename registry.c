@@ -0,0 +1,117 @@
+#include "defs.h"
+
+
+/*
+    Function: hashName
+    Purpose: Hashes a hunter's name with 32-bit FNV-1a.
+    Params:
+        Input: const char *name (in) - the name to hash
+        Output: unsigned int - the hash of the name
+*/
+static unsigned int hashName(const char *name) {
+    unsigned int hash = 2166136261u;
+    for (const unsigned char *c = (const unsigned char *)name; *c != '\0'; c++) {
+        hash = (hash ^ *c) * 16777619u;
+    }
+    return hash;
+}
+
+
+/*
+    Function: initRegistry
+    Purpose: Initializes an empty hunter registry with room for a fixed number of hunters. The table is allocated once, so
+        a registered hunter never moves and pointers to it stay valid until the registry is cleaned.
+    Params:
+        Input:
+            HunterRegistryType *registry (out) - the registry to initialize
+            int capacity (in) - the most hunters the registry will hold
+        Output: void
+*/
+void initRegistry(HunterRegistryType *registry, int capacity) {
+    registry->table = calloc(capacity > 0 ? capacity : 1, sizeof(HunterType));
+    registry->count = 0;
+    registry->capacity = capacity;
+
+    // Keep the index at most half full, so probe sequences stay short
+    int slots = 2;
+    while (slots < capacity * 2) {
+        slots *= 2;
+    }
+    registry->index = malloc(sizeof(int) * slots);
+    memset(registry->index, 0xff, sizeof(int) * slots);
+    registry->indexMask = slots - 1;
+}
+
+
+/*
+    Function: registerHunter
+    Purpose: Gives a new hunter the next id and indexes it by name.
+    Params:
+        Input:
+            HunterRegistryType *registry (in/out) - the registry to add the hunter to
+            const char *name (in) - the name of the hunter, which must be unique
+        Output: HunterType* - the hunter's entry with its id and name set, NULL if the name is taken or the registry is full
+*/
+HunterType *registerHunter(HunterRegistryType *registry, const char *name) {
+    if (registry->count >= registry->capacity) {
+        return NULL;
+    }
+
+    // Probe for the name, stopping at the first empty slot
+    unsigned int slot = hashName(name) & registry->indexMask;
+    while (registry->index[slot] >= 0) {
+        if (strcmp(registry->table[registry->index[slot]].name, name) == 0) {
+            return NULL;
+        }
+        slot = (slot + 1) & registry->indexMask;
+    }
+
+    HunterType *hunter = &registry->table[registry->count];
+    hunter->id = registry->count++;
+    strcpy(hunter->name, name);
+    registry->index[slot] = hunter->id;
+    return hunter;
+}
+
+
+/*
+    Function: findHunterByName
+    Purpose: Finds a hunter in the house by their name.
+    Params:
+        Input:
+            const HouseType *house (in) - the house to search for the hunter
+            const char *name (in) - the name of the hunter to find
+        Output: HunterType* - the found hunter, or NULL if no hunter is found
+*/
+HunterType *findHunterByName(const HouseType *house, const char *name) {
+    const HunterRegistryType *registry = &house->registry;
+    if (registry->index == NULL) {
+        return NULL;
+    }
+    unsigned int slot = hashName(name) & registry->indexMask;
+    while (registry->index[slot] >= 0) {
+        HunterType *hunter = &registry->table[registry->index[slot]];
+        if (strcmp(hunter->name, name) == 0) {
+            return hunter;
+        }
+        slot = (slot + 1) & registry->indexMask;
+    }
+    return NULL;
+}
+
+
+/*
+    Function: cleanRegistry
+    Purpose: Frees every hunter of a registry along with its index.
+    Params:
+        Input: HunterRegistryType *registry (in/out) - the registry to clean
+        Output: void
+*/
+void cleanRegistry(HunterRegistryType *registry) {
+    free(registry->table);
+    free(registry->index);
+    registry->table = NULL;
+    registry->index = NULL;
+    registry->count = 0;
+    registry->capacity = 0;
+}
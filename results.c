@@ -0,0 +1,182 @@
+#include "defs.h"
+#include <fcntl.h>     // for open
+#include <sys/mman.h>  // for mmap and munmap
+#include <sys/stat.h>  // for fstat
+
+
+/*
+    Function: summarizeChunk
+    Purpose: Adds one chunk to the totals, one column at a time, so each pass only touches the bytes it needs.
+    Params:
+        Input:
+            const ResultsColumnsType *columns (in) - the columns of the chunk
+            ResultsSummaryType *summary (in/out) - the totals to add to
+        Output: void
+*/
+static void summarizeChunk(const ResultsColumnsType *columns, ResultsSummaryType *summary) {
+    size_t count = columns->count;
+    summary->hunts += count;
+    summary->chunks++;
+
+    for (size_t i = 0; i < count; i++) {
+        summary->ticks += columns->ticks[i];
+        summary->minTicks = columns->ticks[i] < summary->minTicks ? columns->ticks[i] : summary->minTicks;
+        summary->maxTicks = columns->ticks[i] > summary->maxTicks ? columns->ticks[i] : summary->maxTicks;
+    }
+    for (size_t i = 0; i < count; i++) {
+        summary->exitedFear += columns->exitedFear[i];
+    }
+    for (size_t i = 0; i < count; i++) {
+        summary->exitedBoredom += columns->exitedBoredom[i];
+    }
+    for (size_t i = 0; i < count; i++) {
+        summary->evidence += columns->evidence[i];
+    }
+
+    // Outcomes and matches need the ghost class alongside
+    for (size_t i = 0; i < count; i++) {
+        int ghost = columns->ghostClass[i];
+        int won = columns->outcome[i] == HUNT_HUNTERS_WON;
+        int identified = columns->identifiedClass[i] != GH_UNKNOWN;
+        int correct = identified && columns->identifiedClass[i] == ghost;
+        summary->hunterWins += won;
+        summary->ghostWins += columns->outcome[i] == HUNT_GHOST_WON;
+        summary->identified += identified;
+        summary->correct += correct;
+        if (ghost < GHOST_COUNT) {
+            summary->classHunts[ghost]++;
+            summary->classWins[ghost] += won;
+            summary->classCorrect[ghost] += correct;
+        }
+    }
+}
+
+
+/*
+    Function: printChunkCsv
+    Purpose: Prints every hunt of a chunk as a line of comma-separated values.
+    Params:
+        Input: const ResultsColumnsType *columns (in) - the columns of the chunk
+        Output: void
+*/
+static void printChunkCsv(const ResultsColumnsType *columns) {
+    for (size_t i = 0; i < columns->count; i++) {
+        char ghost[16];
+        char identified[16];
+        ghostToString(columns->ghostClass[i], ghost);
+        ghostToString(columns->identifiedClass[i], identified);
+        printf("%u,%s,%s,%s,%u,%u,%u,%u\n", columns->seed[i],
+               columns->outcome[i] == HUNT_HUNTERS_WON ? "hunters" : columns->outcome[i] == HUNT_GHOST_WON ? "ghost" : "none",
+               ghost, identified, columns->exitedFear[i], columns->exitedBoredom[i], columns->ticks[i], columns->evidence[i]);
+    }
+}
+
+
+/*
+    Function: printResultsSummary
+    Purpose: Prints the totals of a results file: outcomes, identification accuracy, hunt lengths, exits and evidence, then
+        the same per ghost class.
+    Params:
+        Input: const ResultsSummaryType *summary (in) - the totals to print
+        Output: void
+*/
+static void printResultsSummary(const ResultsSummaryType *summary) {
+    double hunts = summary->hunts > 0 ? summary->hunts : 1;
+    printf("Hunts:             %lld in %lld chunk%s\n", summary->hunts, summary->chunks, summary->chunks == 1 ? "" : "s");
+    printf("Hunters won:       %lld (%.1f%%)\n", summary->hunterWins, 100.0 * summary->hunterWins / hunts);
+    printf("Ghost won:         %lld (%.1f%%)\n", summary->ghostWins, 100.0 * summary->ghostWins / hunts);
+    printf("Identified:        %lld, %lld correctly (%.1f%%)\n", summary->identified, summary->correct,
+           summary->identified > 0 ? 100.0 * summary->correct / summary->identified : 0.0);
+    printf("Ticks:             mean %.1f, min %u, max %u\n", summary->ticks / hunts, summary->hunts > 0 ? summary->minTicks : 0,
+           summary->maxTicks);
+    printf("Exits per hunt:    %.2f by fear, %.2f by boredom\n", summary->exitedFear / hunts, summary->exitedBoredom / hunts);
+    printf("Evidence per hunt: %.2f\n", summary->evidence / hunts);
+
+    printf("\n%-12s %10s %12s %12s\n", "ghost", "hunts", "hunters won", "identified");
+    for (int ghost = 0; ghost < GHOST_COUNT; ghost++) {
+        char name[16];
+        ghostToString(ghost, name);
+        double classHunts = summary->classHunts[ghost] > 0 ? summary->classHunts[ghost] : 1;
+        printf("%-12s %10lld %11.1f%% %11.1f%%\n", name, summary->classHunts[ghost], 100.0 * summary->classWins[ghost] / classHunts,
+               100.0 * summary->classCorrect[ghost] / classHunts);
+    }
+}
+
+
+/*
+    Function: main
+    Purpose: Entry point of fp-results. Maps a columnar results file written with --results and prints the summary of every
+        hunt in it, or with --csv every hunt as a line of comma-separated values.
+    Params:
+        Input:
+            int argc (in) - the number of command line arguments
+            char *argv[] (in) - the command line arguments, FILE [--csv]
+    Returns: int - status code of the program execution
+*/
+int main(int argc, char *argv[]) {
+    const char *path = NULL;
+    int csv = C_FALSE;
+
+    // Parse the arguments
+    for (int i = 1; i < argc; i++) {
+        if (strcmp(argv[i], "--csv") == 0) {
+            csv = C_TRUE;
+        } else {
+            path = argv[i];
+        }
+    }
+    if (path == NULL) {
+        printf("Usage: %s FILE [--csv]\n", argv[0]);
+        return EXIT_FAILURE;
+    }
+
+    // Map the whole file, a chunk still being appended is left out
+    int fd = open(path, O_RDONLY);
+    if (fd < 0) {
+        perror(path);
+        return EXIT_FAILURE;
+    }
+    struct stat info;
+    fstat(fd, &info);
+    size_t size = info.st_size;
+    const ResultsHeaderType *header = NULL;
+    void *map = size >= sizeof(ResultsHeaderType) ? mmap(NULL, size, PROT_READ, MAP_SHARED, fd, 0) : MAP_FAILED;
+    close(fd);
+    if (map != MAP_FAILED) {
+        header = (const ResultsHeaderType *)map;
+    }
+    if (header == NULL || header->magic != RESULTS_MAGIC || header->version != RESULTS_VERSION) {
+        fprintf(stderr, "%s: not a results file of this version, write one with --results %s first\n", path, path);
+        if (map != MAP_FAILED) {
+            munmap(map, size);
+        }
+        return EXIT_FAILURE;
+    }
+
+    // Walk the chunks, printing or summarizing each
+    ResultsSummaryType summary;
+    memset(&summary, 0, sizeof(summary));
+    summary.minTicks = UINT32_MAX;
+    size_t offset = sizeof(ResultsHeaderType);
+    ResultsColumnsType columns;
+    if (csv) {
+        printf("seed,winner,ghost,identified,exited_fear,exited_boredom,ticks,evidence\n");
+    }
+    while (readChunk(map, size, &offset, &columns) == C_TRUE) {
+        if (csv) {
+            printChunkCsv(&columns);
+        } else {
+            summarizeChunk(&columns, &summary);
+        }
+    }
+    if (!csv) {
+        printf("Results of simulator version %u\n", header->simVersion);
+        printResultsSummary(&summary);
+        if (offset < size) {
+            printf("\nIgnored the last %zu bytes, an incomplete chunk\n", size - offset);
+        }
+    }
+
+    munmap(map, size);
+    return EXIT_SUCCESS;
+}
@@ -1,4 +1,7 @@
 #include "defs.h"
+#include <limits.h>       // for INT_MAX
+#include <linux/futex.h>  // for FUTEX_WAKE_PRIVATE
+#include <sys/syscall.h>  // for SYS_futex
 
 
 /*
@@ -16,9 +19,8 @@ RoomType *createRoom(char *name)
     strcpy(newRoom->name, name);
     // Initialize the ghost in the room to NULL
     newRoom->ghost = NULL;
-    // Initialize the head and tail of the evidence list to NULL
-    newRoom->evidences.head = NULL;
-    newRoom->evidences.tail = NULL;
+    // Start with no evidence, the ring is allocated when the ghost first leaves some
+    memset(&(newRoom->evidence), 0, sizeof(RoomEvidenceType));
     // Initialize the head, tail, and count of the hunters list to NULL and 0 respectively
     newRoom->hunters.head = NULL;
     newRoom->hunters.tail = NULL;
@@ -33,6 +35,11 @@ RoomType *createRoom(char *name)
 
     // Initialize the semaphore for the room
     sem_init(&(newRoom->roomSem), 0, 1);
+    // Nothing has happened in the room, and no agent is parked in it
+    atomic_init(&newRoom->events, 0);
+    atomic_init(&newRoom->parked, 0);
+    // Initialize the mailbox the actor engine delivers agents to
+    initMailbox(&(newRoom->mailbox));
 
     // Return the newly created room
     return newRoom;
@@ -102,4 +109,80 @@ void addRoom(RoomListType *list, RoomType *r)
     }
     // Increment the count of rooms in the list
     list->count++;
-}
\ No newline at end of file
+}
+
+/*
+    Function: pickConnectedRoom
+    Purpose: Picks a random room connected to a room.
+    Params:
+        Input: RoomType *room (in) - the room to pick a neighbour of
+        Output: RoomType* - the picked room, or NULL if the room has no connected rooms
+*/
+RoomType *pickConnectedRoom(RoomType *room) {
+    // Get the list of rooms connected to the room
+    RoomListType *connectedRooms = room->connectedRooms;
+    // If there are no connected rooms there is nothing to pick
+    if (connectedRooms->count == 0) {
+        return NULL;
+    }
+
+    // Generate a random index and walk to the room at it
+    int randomIndex = randInt(0, connectedRooms->count);
+    RoomNodeType *tempNode = connectedRooms->head;
+    for (int i = 0; i < randomIndex; i++) {
+        tempNode = tempNode->next;
+    }
+    return tempNode->room;
+}
+
+
+/*
+    Function: lockRoom
+    Purpose: Locks a room, counting the lock as a wait in the metrics if another agent already holds it.
+    Params:
+        Input: 
+            RoomType *room (in) - the room to lock
+            MetricsType *metrics (in) - the metrics to count waits in, may be NULL
+        Output: void
+*/
+void lockRoom(RoomType *room, MetricsType *metrics) {
+    // Try the fast uncontended path first
+    if (sem_trywait(&(room->roomSem)) != 0) {
+        // Another agent holds the room, so count the wait and block until it is free
+        metricsAdd(metrics, MET_ROOM_LOCK_WAITS, 1);
+        sem_wait(&(room->roomSem));
+    }
+}
+
+
+/*
+    Function: signalRoom
+    Purpose: Counts an event in a room, and wakes every hunter parked in it. The event is counted before the parked hunters are
+        checked, and parkHunter does the reverse, so a hunter parking at the same time either sees the event or is woken.
+    Params:
+        Input: RoomType *room (in/out) - the room something happened in
+        Output: void
+*/
+void signalRoom(RoomType *room) {
+    atomic_fetch_add(&room->events, 1);
+    if (atomic_load(&room->parked) > 0) {
+        syscall(SYS_futex, &room->events, FUTEX_WAKE_PRIVATE, INT_MAX, NULL, NULL, 0);
+    }
+}
+
+
+/*
+    Function: signalHouse
+    Purpose: Counts an event in every room of the house, waking every parked hunter, for changes that matter wherever a hunter
+        is: the hunt ending, or a review becoming able to end it. Also wakes the agents resting on the hunt's state, which go
+        back to sleep unless the hunt is over. Safe to call from a signal handler.
+    Params:
+        Input: HouseType *house (in) - the house
+        Output: void
+*/
+void signalHouse(HouseType *house) {
+    for (RoomNodeType *node = house->rooms.head; node != NULL; node = node->next) {
+        signalRoom(node->room);
+    }
+    syscall(SYS_futex, &house->state, FUTEX_WAKE_PRIVATE, INT_MAX, NULL, NULL, 0);
+}
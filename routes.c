@@ -0,0 +1,291 @@
+#include "defs.h"
+
+// Next-hop tables already built, one per map, shared by every house and thread of the process
+static RouteTableType *routeCache = NULL;
+static pthread_mutex_t routeCacheLock = PTHREAD_MUTEX_INITIALIZER;
+
+
+/*
+    Function: getHop
+    Purpose: Reads the next-hop slot from one room towards another.
+    Params:
+        Input:
+            const RouteTableType *table (in) - the table to read
+            int from (in) - the id of the room to start from
+            int to (in) - the id of the room to reach
+        Output: int - the slot in the connected rooms of from, ROUTE_NONE if already there or unreachable
+*/
+static int getHop(const RouteTableType *table, int from, int to) {
+    long long entry = (long long)to * table->numRooms + from;
+    if (table->wide) {
+        return table->hops[entry];
+    }
+    // Two slots per byte, the even entry in the low nibble, with the all-ones nibble meaning none
+    int slot = (table->hops[entry >> 1] >> ((entry & 1) * 4)) & 0x0f;
+    return slot == 0x0f ? ROUTE_NONE : slot;
+}
+
+
+/*
+    Function: setHop
+    Purpose: Writes the next-hop slot from one room towards another.
+    Params:
+        Input:
+            RouteTableType *table (in/out) - the table to write
+            int from (in) - the id of the room to start from
+            int to (in) - the id of the room to reach
+            int slot (in) - the slot in the connected rooms of from
+        Output: void
+*/
+static void setHop(RouteTableType *table, int from, int to, int slot) {
+    long long entry = (long long)to * table->numRooms + from;
+    if (table->wide) {
+        table->hops[entry] = (uint8_t)slot;
+        return;
+    }
+    int shift = (entry & 1) * 4;
+    table->hops[entry >> 1] = (uint8_t)((table->hops[entry >> 1] & ~(0x0f << shift)) | (slot << shift));
+}
+
+
+/*
+    Function: findSlot
+    Purpose: Finds the position of a room among the connected rooms of another.
+    Params:
+        Input:
+            RoomType *room (in) - the room whose connections to search
+            RoomType *target (in) - the connected room to find
+        Output: int - the slot of target, ROUTE_NONE if it is not connected
+*/
+static int findSlot(RoomType *room, RoomType *target) {
+    int slot = 0;
+    for (RoomNodeType *node = room->connectedRooms->head; node != NULL; node = node->next, slot++) {
+        if (node->room == target) {
+            return slot;
+        }
+    }
+    return ROUTE_NONE;
+}
+
+
+/*
+    Function: createRouteTable
+    Purpose: Builds the next-hop table of a map with one breadth-first search per target room.
+    Params:
+        Input:
+            HouseType *house (in) - a house built from the map, with its rooms numbered
+            uint64_t mapHash (in) - the hash of the map
+        Output: RouteTableType* - the new table
+*/
+static RouteTableType *createRouteTable(HouseType *house, uint64_t mapHash) {
+    int numRooms = house->rooms.count;
+    RouteTableType *table = malloc(sizeof(RouteTableType));
+    table->mapHash = mapHash;
+    table->numRooms = numRooms;
+    table->next = NULL;
+
+    // Pack two slots per byte unless some room has too many connections for a nibble
+    table->wide = C_FALSE;
+    for (int i = 0; i < numRooms; i++) {
+        if (house->roomTable[i]->connectedRooms->count >= 0x0f) {
+            table->wide = C_TRUE;
+        }
+    }
+    long long entries = (long long)numRooms * numRooms;
+    long long size = table->wide ? entries : (entries + 1) / 2;
+    table->hops = malloc(size);
+    // Every slot starts as none, all ones in either encoding, so unreachable rooms stay that way
+    memset(table->hops, 0xff, size);
+
+    // Search outwards from each target; a room's first step is the room it was reached from
+    int *queue = malloc(sizeof(int) * numRooms);
+    char *seen = malloc(numRooms);
+    for (int target = 0; target < numRooms; target++) {
+        memset(seen, 0, numRooms);
+        int head = 0;
+        int tail = 0;
+        queue[tail++] = target;
+        seen[target] = C_TRUE;
+        while (head < tail) {
+            RoomType *room = house->roomTable[queue[head++]];
+            for (RoomNodeType *node = room->connectedRooms->head; node != NULL; node = node->next) {
+                RoomType *neighbour = node->room;
+                if (seen[neighbour->id]) {
+                    continue;
+                }
+                seen[neighbour->id] = C_TRUE;
+                setHop(table, neighbour->id, target, findSlot(neighbour, room));
+                queue[tail++] = neighbour->id;
+            }
+        }
+    }
+    free(queue);
+    free(seen);
+    return table;
+}
+
+
+/*
+    Function: buildRoutes
+    Purpose: Numbers the rooms of a house and indexes them by id. With directed movement, also attaches the next-hop table of
+        the map, building it only the first time the process sees the map.
+    Params:
+        Input: HouseType *house (in/out) - the house, with its rooms populated
+        Output: void
+*/
+void buildRoutes(HouseType *house) {
+    // Number the rooms in house order, so the Van is always room 0
+    house->roomTable = malloc(sizeof(RoomType *) * house->rooms.count);
+    int id = 0;
+    for (RoomNodeType *node = house->rooms.head; node != NULL; node = node->next, id++) {
+        node->room->id = id;
+        house->roomTable[id] = node->room;
+    }
+    if (house->config->policy != POLICY_DIRECTED) {
+        return;
+    }
+
+    // Reuse the table of an identical map, or build and keep one
+    uint64_t mapHash = hashHouseMap(house);
+    pthread_mutex_lock(&routeCacheLock);
+    RouteTableType *table = routeCache;
+    while (table != NULL && (table->mapHash != mapHash || table->numRooms != house->rooms.count)) {
+        table = table->next;
+    }
+    if (table == NULL) {
+        table = createRouteTable(house, mapHash);
+        table->next = routeCache;
+        routeCache = table;
+    }
+    pthread_mutex_unlock(&routeCacheLock);
+    house->routes = table;
+}
+
+
+/*
+    Function: cleanRouteCache
+    Purpose: Frees every next-hop table the process has built.
+    Params:
+        Output: void
+*/
+void cleanRouteCache() {
+    pthread_mutex_lock(&routeCacheLock);
+    while (routeCache != NULL) {
+        RouteTableType *next = routeCache->next;
+        free(routeCache->hops);
+        free(routeCache);
+        routeCache = next;
+    }
+    pthread_mutex_unlock(&routeCacheLock);
+}
+
+
+/*
+    Function: nextHop
+    Purpose: Returns the first room on a shortest path from one room to another.
+    Params:
+        Input:
+            HouseType *house (in) - the house, with its next-hop table
+            RoomType *from (in) - the room to start from
+            int to (in) - the id of the room to reach
+        Output: RoomType* - the connected room to move to, NULL if already there or unreachable
+*/
+RoomType *nextHop(HouseType *house, RoomType *from, int to) {
+    int slot = getHop(house->routes, from->id, to);
+    if (slot == ROUTE_NONE) {
+        return NULL;
+    }
+    RoomNodeType *node = from->connectedRooms->head;
+    for (int i = 0; i < slot; i++) {
+        node = node->next;
+    }
+    return node->room;
+}
+
+
+/*
+    Function: fleeFrom
+    Purpose: Picks a random connected room that is farther from a threat, which is any room whose first step towards the threat
+        is back through the current room.
+    Params:
+        Input:
+            HouseType *house (in) - the house, with its next-hop table
+            RoomType *from (in) - the room to flee from
+            int threat (in) - the id of the room to get away from
+        Output: RoomType* - the room to move to, or a random connected room if none is farther
+*/
+RoomType *fleeFrom(HouseType *house, RoomType *from, int threat) {
+    // Standing in the threat's room, every way out is farther
+    if (from->id == threat) {
+        return pickConnectedRoom(from);
+    }
+    RoomType *candidates[ROUTE_NONE];
+    int count = 0;
+    for (RoomNodeType *node = from->connectedRooms->head; node != NULL && count < ROUTE_NONE; node = node->next) {
+        if (nextHop(house, node->room, threat) == from) {
+            candidates[count++] = node->room;
+        }
+    }
+    return count > 0 ? candidates[randInt(0, count)] : pickConnectedRoom(from);
+}
+
+
+/*
+    Function: chooseHunterMove
+    Purpose: Picks the room a hunter moves to. Random movement walks at random. Directed movement heads back to the Van with enough
+        evidence, flees the ghost once half scared, chases the last evidence of the hunter's own type, and otherwise walks at random.
+    Params:
+        Input:
+            HouseType *house (in) - the house where the hunter is
+            HunterType *hunter (in) - the hunter moving
+        Output: RoomType* - the room to move to, NULL if there is none
+*/
+RoomType *chooseHunterMove(HouseType *house, HunterType *hunter) {
+    RoomType *room = hunter->currentRoom;
+    if (house->routes == NULL) {
+        return pickConnectedRoom(room);
+    }
+
+    // Enough evidence to leave, so head for the Van
+    int known = hunter->radio != NULL ? hunter->radio->knowledge : atomic_load_explicit(&house->evidenceMask, memory_order_relaxed);
+    if (__builtin_popcount(known) >= 3 && room->id != 0) {
+        return nextHop(house, room, 0);
+    }
+
+    // Scared, so get away from where the ghost was last met
+    if (hunter->ghostSeen >= 0 && atomic_load_explicit(&hunter->fear, memory_order_relaxed) * 2 >= house->config->fearMax) {
+        return fleeFrom(house, room, hunter->ghostSeen);
+    }
+
+    // Go where the ghost last left evidence the hunter can collect, the hint being forgotten once the hunter moves on from it
+    int hint = atomic_load_explicit(&house->evidenceHint[hunter->equipmentType], memory_order_relaxed);
+    if (hint >= 0 && hint != room->id) {
+        RoomType *step = nextHop(house, room, hint);
+        if (step != NULL) {
+            return step;
+        }
+    }
+    return pickConnectedRoom(room);
+}
+
+
+/*
+    Function: chooseGhostMove
+    Purpose: Picks the room the ghost moves to. Random movement walks at random. Directed movement heads for the room a hunter
+        last moved to, and otherwise walks at random.
+    Params:
+        Input:
+            HouseType *house (in) - the house where the ghost is
+            RoomType *room (in) - the room the ghost is in
+        Output: RoomType* - the room to move to, NULL if there is none
+*/
+RoomType *chooseGhostMove(HouseType *house, RoomType *room) {
+    if (house->routes != NULL) {
+        int hint = atomic_load_explicit(&house->hunterHint, memory_order_relaxed);
+        RoomType *step = hint >= 0 ? nextHop(house, room, hint) : NULL;
+        if (step != NULL) {
+            return step;
+        }
+    }
+    return pickConnectedRoom(room);
+}
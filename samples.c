@@ -0,0 +1,155 @@
+#include "defs.h"
+#include <fcntl.h>     // for open
+#include <sys/stat.h>  // for fstat
+
+// File every hunt's samples are appended to, -1 when not sampling
+static int samplesFd = -1;
+
+
+/*
+    Function: openSamples
+    Purpose: Opens the file every hunt's samples are appended to, writing the CSV header if the file is new. Every line is
+        appended whole by a single write, so worker processes and hunts on other threads append to the same file without a lock.
+    Params:
+        Input: const char *path (in) - the path of the file, created if missing
+        Output: int - C_TRUE if the file is ready, C_FALSE otherwise
+*/
+int openSamples(const char *path) {
+    samplesFd = open(path, O_WRONLY | O_CREAT | O_APPEND, 0644);
+    if (samplesFd < 0) {
+        perror(path);
+        return C_FALSE;
+    }
+    struct stat info;
+    if (fstat(samplesFd, &info) == 0 && info.st_size == 0) {
+        const char *header = "seed,tick,hunters,mean_fear,max_fear,mean_boredom,evidence_types,room_evidence,ghost_room\n";
+        if (write(samplesFd, header, strlen(header)) < 0) {
+            perror(path);
+            closeSamples();
+            return C_FALSE;
+        }
+    }
+    return C_TRUE;
+}
+
+
+/*
+    Function: closeSamples
+    Purpose: Closes the samples file, if one was opened.
+    Params:
+        Output: void
+*/
+void closeSamples() {
+    if (samplesFd >= 0) {
+        close(samplesFd);
+        samplesFd = -1;
+    }
+}
+
+
+/*
+    Function: startSamples
+    Purpose: Allocates the sample ring of a house about to be simulated, if its hunt is sampled and there is a file to write the
+        samples to. The ring never grows, so taking a sample never allocates.
+    Params:
+        Input: HouseType *house (in/out) - the house, with its parameters
+        Output: void
+*/
+void startSamples(HouseType *house) {
+    if (house->config->samplePeriod <= 0 || samplesFd < 0) {
+        return;
+    }
+    house->samples = malloc(sizeof(SampleRingType));
+    house->samples->start = 0;
+    house->samples->count = 0;
+}
+
+
+/*
+    Function: takeSample
+    Purpose: Records the state of a hunt in its sample ring. Runs on the thread acting for the ghost, so the ghost is read
+        as it is; the hunters are read with relaxed loads from the registry table, and the evidence from counters the agents
+        keep up to date, so no room's lock is taken and no agent waits for the sample. A full ring is written out when
+        streaming, and otherwise loses its oldest sample.
+    Params:
+        Input:
+            HouseType *house (in/out) - the house of the hunt
+            int tick (in) - the ghost tick about to be acted
+        Output: void
+*/
+void takeSample(HouseType *house, int tick) {
+    SampleRingType *ring = house->samples;
+    if (ring->count == SAMPLE_RING) {
+        if (house->config->sampleStream) {
+            writeSamples(house);
+        } else {
+            ring->start = (ring->start + 1) % SAMPLE_RING;
+            ring->count--;
+        }
+    }
+    SampleType *sample = &ring->slots[(ring->start + ring->count) % SAMPLE_RING];
+    ring->count++;
+
+    // The hunters still in the house, each read once
+    int hunters = 0;
+    int maxFear = 0;
+    uint32_t fear = 0;
+    uint32_t boredom = 0;
+    for (int i = 0; i < house->registry.count; i++) {
+        HunterType *hunter = &house->registry.table[i];
+        if (atomic_load_explicit(&hunter->exited, memory_order_relaxed)) {
+            continue;
+        }
+        int hunterFear = atomic_load_explicit(&hunter->fear, memory_order_relaxed);
+        hunters++;
+        fear += hunterFear;
+        boredom += atomic_load_explicit(&hunter->boredomTimer, memory_order_relaxed);
+        maxFear = hunterFear > maxFear ? hunterFear : maxFear;
+    }
+    sample->tick = tick;
+    sample->hunters = hunters;
+    sample->maxFear = maxFear;
+    sample->fear = fear;
+    sample->boredom = boredom;
+    sample->evidenceTypes = __builtin_popcount(atomic_load_explicit(&house->evidenceMask, memory_order_relaxed));
+    sample->roomEvidence = atomic_load_explicit(&house->roomEvidence, memory_order_relaxed);
+    // A ghost that left because of boredom is in no room, though the lockstep engine keeps counting ticks
+    GhostType *ghost = house->ghost;
+    sample->ghostRoom = ghost->boredomTimer >= house->config->boredomMax ? -1 : ghost->room->id;
+}
+
+
+/*
+    Function: writeSamples
+    Purpose: Appends the samples of a hunt held in its ring to the samples file, one CSV line each, and empties the ring.
+        Lines are formatted into a buffer and written SAMPLE_WRITE bytes at a time. Called as the hunt finishes, and by the
+        ghost's thread when a streamed ring fills.
+    Params:
+        Input: HouseType *house (in/out) - the house of the hunt, may not be sampled
+        Output: void
+*/
+void writeSamples(HouseType *house) {
+    SampleRingType *ring = house->samples;
+    if (ring == NULL || samplesFd < 0) {
+        return;
+    }
+    char buffer[SAMPLE_WRITE];
+    size_t used = 0;
+    for (int i = 0; i < ring->count; i++) {
+        const SampleType *sample = &ring->slots[(ring->start + i) % SAMPLE_RING];
+        double hunters = sample->hunters > 0 ? sample->hunters : 1;
+        used += snprintf(buffer + used, sizeof(buffer) - used, "%u,%u,%u,%.2f,%u,%.2f,%u,%u,%d\n", house->seed, sample->tick,
+                         sample->hunters, sample->fear / hunters, sample->maxFear, sample->boredom / hunters, sample->evidenceTypes,
+                         sample->roomEvidence, sample->ghostRoom);
+        // Write whole lines out before the buffer could cut one, the longest line being well under 128 bytes
+        if (sizeof(buffer) - used < 128 || i == ring->count - 1) {
+            if (write(samplesFd, buffer, used) < 0) {
+                perror("samples");
+                break;
+            }
+            used = 0;
+        }
+    }
+    ring->start = 0;
+    ring->count = 0;
+}
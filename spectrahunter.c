@@ -0,0 +1,378 @@
+#include "defs.h"
+#include "spectrahunter.h"
+
+// The library's constants are the simulator's own values
+_Static_assert(SPECTRA_HUNTERS_WON == HUNT_HUNTERS_WON && SPECTRA_GHOST_WON == HUNT_GHOST_WON, "outcomes");
+_Static_assert(SPECTRA_EMF == EMF && SPECTRA_TEMPERATURE == TEMPERATURE && SPECTRA_FINGERPRINTS == FINGERPRINTS &&
+               SPECTRA_SOUND == SOUND, "evidence types");
+_Static_assert(SPECTRA_POLTERGEIST == POLTERGEIST && SPECTRA_BANSHEE == BANSHEE && SPECTRA_BULLIES == BULLIES &&
+               SPECTRA_PHANTOM == PHANTOM, "ghost classes");
+
+
+/*
+    Function: spectraCreate
+    Purpose: Creates a hunt on a map, with the default runtime parameters and no hunters yet. Nothing is built until the
+        first spectraReset.
+    Params:
+        Input: const char *map (in) - "house" for the original house, or "grid:WxH", NULL for the original house
+        Output: SpectraHuntType* - the hunt, or NULL if the map is not valid
+*/
+SpectraHuntType *spectraCreate(const char *map) {
+    SpectraHuntType *hunt = calloc(1, sizeof(SpectraHuntType));
+    initConfig(&hunt->next);
+    // Stepped on the caller's thread, with no delay, so a seed always plays the same hunt
+    hunt->next.engine = ENGINE_LOCKSTEP;
+    hunt->next.stepThreads = 1;
+    hunt->next.actionDelay = 0;
+    if (map != NULL && (parseConfigOption(&hunt->next, "--map", map) == C_FALSE || validConfig(&hunt->next) == C_FALSE)) {
+        free(hunt);
+        return NULL;
+    }
+    // The library never prints
+    logMask = 0;
+    return hunt;
+}
+
+
+/*
+    Function: spectraSetOption
+    Purpose: Sets a runtime parameter for the hunts built from the next reset on, with the name and value of fp's option,
+        such as "--fear-max" and "5". How agents are run and how many hunters there are is up to the library, so --engine,
+        --delay, the thread counts, --wake and --hunters are refused.
+    Params:
+        Input:
+            SpectraHuntType *hunt (in/out) - the hunt
+            const char *option (in) - the option
+            const char *value (in) - its value
+        Output: int - C_TRUE if the parameter was set, C_FALSE if the option or its value is not valid
+*/
+int spectraSetOption(SpectraHuntType *hunt, const char *option, const char *value) {
+    static const char *refused[] = {"--engine", "--delay", "--step-threads", "--room-owners", "--task-threads", "--wake", "--hunters"};
+    for (size_t i = 0; i < sizeof(refused) / sizeof(refused[0]); i++) {
+        if (strcmp(option, refused[i]) == 0) {
+            return C_FALSE;
+        }
+    }
+    // Only keep the value if it is one the simulation can run with
+    ConfigType config = hunt->next;
+    if (parseConfigOption(&config, option, value) == C_FALSE || validConfig(&config) == C_FALSE) {
+        return C_FALSE;
+    }
+    hunt->next = config;
+    return C_TRUE;
+}
+
+
+/*
+    Function: spectraAddHunter
+    Purpose: Adds a hunter to the hunts built from the next reset on. Every hunter starts in the van.
+    Params:
+        Input:
+            SpectraHuntType *hunt (in/out) - the hunt
+            const char *name (in) - the name of the hunter, unique within the hunt
+        Output: int - the id of the hunter, or -1 if the name is taken, too long or the hunt is full
+*/
+int spectraAddHunter(SpectraHuntType *hunt, const char *name) {
+    if (hunt->numHunters >= MAX_ARR || strlen(name) >= MAX_STR || name[0] == '\0') {
+        return -1;
+    }
+    for (int i = 0; i < hunt->numHunters; i++) {
+        if (strcmp(hunt->hunterNames[i], name) == 0) {
+            return -1;
+        }
+    }
+    strcpy(hunt->hunterNames[hunt->numHunters], name);
+    return hunt->numHunters++;
+}
+
+
+/*
+    Function: cleanSpectraHouse
+    Purpose: Frees the house of the current hunt, if one was built.
+    Params:
+        Input: SpectraHuntType *hunt (in/out) - the hunt
+        Output: void
+*/
+static void cleanSpectraHouse(SpectraHuntType *hunt) {
+    if (hunt->built) {
+        cleanLockstep(&hunt->lockstep);
+        cleanHouse(&hunt->house);
+        hunt->built = C_FALSE;
+    }
+}
+
+
+/*
+    Function: spectraReset
+    Purpose: Builds the house afresh for a seed, with the runtime parameters and hunters set so far, ready for its first tick.
+        The previous house is freed; the map's next-hop table, when movement is directed, is kept for the whole process.
+    Params:
+        Input:
+            SpectraHuntType *hunt (in/out) - the hunt
+            unsigned int seed (in) - the seed of the hunt
+        Output: int - C_TRUE if the house was built, C_FALSE if no hunter was added yet
+*/
+int spectraReset(SpectraHuntType *hunt, unsigned int seed) {
+    if (hunt->numHunters == 0) {
+        return C_FALSE;
+    }
+    cleanSpectraHouse(hunt);
+    hunt->config = hunt->next;
+    hunt->config.hunters = hunt->numHunters;
+    setupHunt(&hunt->house, &hunt->config, seed, hunt->hunterNames, NULL);
+    initLockstep(&hunt->lockstep, &hunt->house, 1);
+    hunt->built = C_TRUE;
+    return C_TRUE;
+}
+
+
+/*
+    Function: spectraPlaceGhost
+    Purpose: Moves the ghost to a room, or changes its class, in place of what the seed picked. Between steps only.
+    Params:
+        Input:
+            SpectraHuntType *hunt (in/out) - the hunt
+            int room (in) - the room to move the ghost to, any but the van (room 0), -1 to leave it where it is
+            int ghostClass (in) - the ghost's class, a SPECTRA_ ghost class, -1 to leave it as it is
+        Output: int - C_TRUE if the ghost was placed, C_FALSE if the house is not built or a value is not valid
+*/
+int spectraPlaceGhost(SpectraHuntType *hunt, int room, int ghostClass) {
+    GhostType *ghost = hunt->built ? hunt->lockstep.ghost : NULL;
+    if (ghost == NULL || room < -1 || room == 0 || room >= hunt->house.rooms.count || ghostClass < -1 || ghostClass >= GHOST_COUNT) {
+        return C_FALSE;
+    }
+    if (room > 0 && ghost->room != hunt->house.roomTable[room]) {
+        moveGhostToRoom(ghost, ghost->room, hunt->house.roomTable[room]);
+    }
+    if (ghostClass >= 0) {
+        ghost->ghostType = ghostClass;
+    }
+    return C_TRUE;
+}
+
+
+/*
+    Function: spectraDestroy
+    Purpose: Frees a hunt and its house.
+    Params:
+        Input: SpectraHuntType *hunt (in) - the hunt, may be NULL
+        Output: void
+*/
+void spectraDestroy(SpectraHuntType *hunt) {
+    if (hunt == NULL) {
+        return;
+    }
+    cleanSpectraHouse(hunt);
+    free(hunt);
+}
+
+
+/*
+    Function: spectraStep
+    Purpose: Runs up to a number of ticks of the hunt, each the ghost acting then every hunter by id, stopping early once the
+        outcome is decided.
+    Params:
+        Input:
+            SpectraHuntType *hunt (in/out) - the hunt, built by spectraReset
+            int ticks (in) - the most ticks to run
+        Output: int - the ticks run, 0 once the hunt is over or if it was never built
+*/
+int spectraStep(SpectraHuntType *hunt, int ticks) {
+    if (!hunt->built) {
+        return 0;
+    }
+    int start = hunt->lockstep.tick;
+    for (int i = 0; i < ticks && stepLockstep(&hunt->lockstep); i++) {
+    }
+    return hunt->lockstep.tick - start;
+}
+
+
+/*
+    Function: spectraRun
+    Purpose: Runs the hunt until its outcome is decided.
+    Params:
+        Input: SpectraHuntType *hunt (in/out) - the hunt, built by spectraReset
+        Output: int - the outcome, SPECTRA_HUNTERS_WON or SPECTRA_GHOST_WON, SPECTRA_RUNNING if it was never built
+*/
+int spectraRun(SpectraHuntType *hunt) {
+    while (hunt->built && stepLockstep(&hunt->lockstep)) {
+    }
+    return spectraOutcome(hunt);
+}
+
+
+/*
+    Function: spectraOutcome
+    Purpose: Returns what the hunt has come to so far.
+    Params:
+        Input: const SpectraHuntType *hunt (in) - the hunt
+        Output: int - SPECTRA_RUNNING, SPECTRA_HUNTERS_WON or SPECTRA_GHOST_WON
+*/
+int spectraOutcome(const SpectraHuntType *hunt) {
+    return hunt->built ? atomic_load(&hunt->house.state) : SPECTRA_RUNNING;
+}
+
+
+/*
+    Function: spectraTicks
+    Purpose: Returns the ticks the hunt has run.
+    Params:
+        Input: const SpectraHuntType *hunt (in) - the hunt
+        Output: int - the ticks run since the last reset
+*/
+int spectraTicks(const SpectraHuntType *hunt) {
+    return hunt->built ? hunt->lockstep.tick : 0;
+}
+
+
+/*
+    Function: spectraRoomCount
+    Purpose: Returns the number of rooms of the house, numbered from 0, the van.
+    Params:
+        Input: const SpectraHuntType *hunt (in) - the hunt
+        Output: int - the rooms, 0 if the house is not built
+*/
+int spectraRoomCount(const SpectraHuntType *hunt) {
+    return hunt->built ? hunt->house.rooms.count : 0;
+}
+
+
+/*
+    Function: spectraRoomName
+    Purpose: Returns the name of a room.
+    Params:
+        Input:
+            const SpectraHuntType *hunt (in) - the hunt
+            int room (in) - the room
+        Output: const char* - the name, owned by the house until the next reset, NULL if there is no such room
+*/
+const char *spectraRoomName(const SpectraHuntType *hunt, int room) {
+    return room >= 0 && room < spectraRoomCount(hunt) ? hunt->house.roomTable[room]->name : NULL;
+}
+
+
+/*
+    Function: spectraRoomHunters
+    Purpose: Returns the number of hunters in a room.
+    Params:
+        Input:
+            const SpectraHuntType *hunt (in) - the hunt
+            int room (in) - the room
+        Output: int - the hunters in the room, -1 if there is no such room
+*/
+int spectraRoomHunters(const SpectraHuntType *hunt, int room) {
+    return room >= 0 && room < spectraRoomCount(hunt) ? hunt->house.roomTable[room]->hunters.count : -1;
+}
+
+
+/*
+    Function: spectraRoomEvidence
+    Purpose: Returns the pieces of one type of evidence left in a room, and not collected yet.
+    Params:
+        Input:
+            const SpectraHuntType *hunt (in) - the hunt
+            int room (in) - the room
+            int evidence (in) - the evidence type, a SPECTRA_ evidence type
+        Output: int - the pieces in the room, -1 if there is no such room or type
+*/
+int spectraRoomEvidence(const SpectraHuntType *hunt, int room, int evidence) {
+    if (room < 0 || room >= spectraRoomCount(hunt) || evidence < 0 || evidence >= EV_COUNT) {
+        return -1;
+    }
+    return hunt->house.roomTable[room]->evidence.counts[evidence];
+}
+
+
+/*
+    Function: spectraGhostRoom
+    Purpose: Returns the room the ghost is in.
+    Params:
+        Input: const SpectraHuntType *hunt (in) - the hunt
+        Output: int - the room, -1 if the house is not built or the ghost left it because of boredom
+*/
+int spectraGhostRoom(const SpectraHuntType *hunt) {
+    return hunt->built && hunt->lockstep.ghostActive ? hunt->lockstep.ghost->room->id : -1;
+}
+
+
+/*
+    Function: spectraGhostClass
+    Purpose: Returns the class of the ghost.
+    Params:
+        Input: const SpectraHuntType *hunt (in) - the hunt
+        Output: int - a SPECTRA_ ghost class, -1 if the house is not built
+*/
+int spectraGhostClass(const SpectraHuntType *hunt) {
+    return hunt->built ? (int)hunt->lockstep.ghost->ghostType : -1;
+}
+
+
+/*
+    Function: spectraHunterCount
+    Purpose: Returns the number of hunters of the current house, in or out of it, with ids from 0.
+    Params:
+        Input: const SpectraHuntType *hunt (in) - the hunt
+        Output: int - the hunters, 0 if the house is not built
+*/
+int spectraHunterCount(const SpectraHuntType *hunt) {
+    return hunt->built ? hunt->house.registry.count : 0;
+}
+
+
+/*
+    Function: spectraHunterRoom
+    Purpose: Returns the room a hunter is in.
+    Params:
+        Input:
+            const SpectraHuntType *hunt (in) - the hunt
+            int hunter (in) - the id of the hunter
+        Output: int - the room, -1 if the hunter left the house or there is no such hunter
+*/
+int spectraHunterRoom(const SpectraHuntType *hunt, int hunter) {
+    if (hunter < 0 || hunter >= spectraHunterCount(hunt) || atomic_load(&hunt->house.registry.table[hunter].exited)) {
+        return -1;
+    }
+    return hunt->house.registry.table[hunter].currentRoom->id;
+}
+
+
+/*
+    Function: spectraHunterFear
+    Purpose: Returns the fear of a hunter, which makes it leave once it reaches --fear-max.
+    Params:
+        Input:
+            const SpectraHuntType *hunt (in) - the hunt
+            int hunter (in) - the id of the hunter
+        Output: int - the fear, -1 if there is no such hunter
+*/
+int spectraHunterFear(const SpectraHuntType *hunt, int hunter) {
+    return hunter >= 0 && hunter < spectraHunterCount(hunt) ? atomic_load(&hunt->house.registry.table[hunter].fear) : -1;
+}
+
+
+/*
+    Function: spectraHunterBoredom
+    Purpose: Returns the boredom of a hunter, which makes it leave once it reaches --boredom-max.
+    Params:
+        Input:
+            const SpectraHuntType *hunt (in) - the hunt
+            int hunter (in) - the id of the hunter
+        Output: int - the boredom, -1 if there is no such hunter
+*/
+int spectraHunterBoredom(const SpectraHuntType *hunt, int hunter) {
+    return hunter >= 0 && hunter < spectraHunterCount(hunt) ? atomic_load(&hunt->house.registry.table[hunter].boredomTimer) : -1;
+}
+
+
+/*
+    Function: spectraSharedEvidence
+    Purpose: Returns the number of distinct evidence types the hunters have shared, three of which identify the ghost.
+    Params:
+        Input: const SpectraHuntType *hunt (in) - the hunt
+        Output: int - the distinct evidence types, 0 if the house is not built
+*/
+int spectraSharedEvidence(const SpectraHuntType *hunt) {
+    // Reviewing only reads the house
+    return hunt->built ? reviewEvidence((HouseType *)&hunt->house) : 0;
+}
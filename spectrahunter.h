@@ -0,0 +1,56 @@
+#ifndef SPECTRAHUNTER_H
+#define SPECTRAHUNTER_H
+
+// The embeddable SpectraHunter library, libspectrahunter.a. A program links it to run hunts in its own process: it builds a
+// house once, steps it a few ticks at a time or to the end, looks at its state between steps, and resets it for the next
+// seed. Hunts are stepped on the calling thread by the lockstep engine, so a seed always plays the same hunt, and the library
+// never starts a thread, sleeps or prints. A hunt may be used by one thread at a time; different hunts are independent.
+
+// What a hunt has come to, as returned by spectraOutcome
+#define SPECTRA_RUNNING 0      // The outcome is not decided yet
+#define SPECTRA_HUNTERS_WON 1  // A hunter left with sufficient evidence
+#define SPECTRA_GHOST_WON 2    // Every hunter left because of fear or boredom
+
+// Evidence types, for spectraRoomEvidence
+#define SPECTRA_EMF 0
+#define SPECTRA_TEMPERATURE 1
+#define SPECTRA_FINGERPRINTS 2
+#define SPECTRA_SOUND 3
+
+// Ghost classes, for spectraPlaceGhost and spectraGhostClass
+#define SPECTRA_POLTERGEIST 0
+#define SPECTRA_BANSHEE 1
+#define SPECTRA_BULLIES 2
+#define SPECTRA_PHANTOM 3
+
+// A hunt and everything it keeps between resets, opaque to the program
+typedef struct SpectraHunt SpectraHuntType;
+
+// Building and reusing a hunt
+SpectraHuntType *spectraCreate(const char *map);
+int spectraSetOption(SpectraHuntType *hunt, const char *option, const char *value);
+int spectraAddHunter(SpectraHuntType *hunt, const char *name);
+int spectraReset(SpectraHuntType *hunt, unsigned int seed);
+int spectraPlaceGhost(SpectraHuntType *hunt, int room, int ghostClass);
+void spectraDestroy(SpectraHuntType *hunt);
+
+// Stepping a hunt
+int spectraStep(SpectraHuntType *hunt, int ticks);
+int spectraRun(SpectraHuntType *hunt);
+
+// Querying a hunt between steps
+int spectraOutcome(const SpectraHuntType *hunt);
+int spectraTicks(const SpectraHuntType *hunt);
+int spectraRoomCount(const SpectraHuntType *hunt);
+const char *spectraRoomName(const SpectraHuntType *hunt, int room);
+int spectraRoomHunters(const SpectraHuntType *hunt, int room);
+int spectraRoomEvidence(const SpectraHuntType *hunt, int room, int evidence);
+int spectraGhostRoom(const SpectraHuntType *hunt);
+int spectraGhostClass(const SpectraHuntType *hunt);
+int spectraHunterCount(const SpectraHuntType *hunt);
+int spectraHunterRoom(const SpectraHuntType *hunt, int hunter);
+int spectraHunterFear(const SpectraHuntType *hunt, int hunter);
+int spectraHunterBoredom(const SpectraHuntType *hunt, int hunter);
+int spectraSharedEvidence(const SpectraHuntType *hunt);
+
+#endif
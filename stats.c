@@ -0,0 +1,114 @@
+#include "defs.h"
+#include <math.h> // for sqrt
+
+
+/*
+    Function: wilsonInterval
+    Purpose: Computes the Wilson score interval of a proportion, which stays sensible near 0 and 1 and for few trials.
+    Params:
+        Input:
+            long long successes (in) - the number of successes
+            long long trials (in) - the number of trials
+            double *low (out) - the lower bound of the interval
+            double *high (out) - the upper bound of the interval
+        Output: void
+*/
+void wilsonInterval(long long successes, long long trials, double *low, double *high) {
+    // With no trials, the proportion could be anything
+    if (trials <= 0) {
+        *low = 0.0;
+        *high = 1.0;
+        return;
+    }
+
+    double n = (double)trials;
+    double p = successes / n;
+    double z2 = CI_Z * CI_Z;
+    // The interval is centred on a shrunk estimate, with a half width that never collapses to 0
+    double centre = (p + z2 / (2.0 * n)) / (1.0 + z2 / n);
+    double half = CI_Z * sqrt(p * (1.0 - p) / n + z2 / (4.0 * n * n)) / (1.0 + z2 / n);
+    *low = centre - half < 0.0 ? 0.0 : centre - half;
+    *high = centre + half > 1.0 ? 1.0 : centre + half;
+}
+
+
+/*
+    Function: estimateMetric
+    Purpose: Returns the successes and trials behind one of the estimated sweep metrics.
+    Params:
+        Input:
+            const SweepSummaryType *summary (in) - the outcomes so far
+            int metric (in) - CI_GHOST_WIN or CI_ACCURACY
+            long long *successes (out) - the number of successes
+            long long *trials (out) - the number of trials
+        Output: void
+*/
+void estimateMetric(const SweepSummaryType *summary, int metric, long long *successes, long long *trials) {
+    if (metric == CI_GHOST_WIN) {
+        // Ghost wins out of every decided hunt
+        *successes = summary->ghostWins;
+        *trials = summary->ghostWins + summary->hunterWins;
+    } else {
+        // Correct matches out of every hunt where a ghost was matched
+        *successes = summary->correct;
+        *trials = summary->identified;
+    }
+}
+
+
+/*
+    Function: sweepConverged
+    Purpose: Checks whether every requested metric has a confidence interval narrower than the target, so dispatch can stop.
+    Params:
+        Input:
+            const SweepSummaryType *summary (in) - the outcomes so far
+            double width (in) - the target full width of each interval, 0 to never stop early
+            int metrics (in) - the metrics that must converge, a mask of CI_GHOST_WIN and CI_ACCURACY
+        Output: int - C_TRUE if every requested metric has converged, C_FALSE otherwise
+*/
+int sweepConverged(const SweepSummaryType *summary, double width, int metrics) {
+    // Early stopping is off, or too few hunts to trust any interval yet
+    if (width <= 0.0 || summary->runs < CI_MIN_RUNS) {
+        return C_FALSE;
+    }
+
+    // Every requested metric must be narrow enough
+    for (int metric = CI_GHOST_WIN; metric <= CI_ACCURACY; metric <<= 1) {
+        if ((metrics & metric) == 0) {
+            continue;
+        }
+        long long successes, trials;
+        double low, high;
+        estimateMetric(summary, metric, &successes, &trials);
+        wilsonInterval(successes, trials, &low, &high);
+        if (high - low > width) {
+            return C_FALSE;
+        }
+    }
+    return C_TRUE;
+}
+
+
+/*
+    Function: printEstimates
+    Purpose: Prints each metric of a sweep with its 95% Wilson interval.
+    Params:
+        Input: const SweepSummaryType *summary (in) - the outcomes of the sweep
+        Output: void
+*/
+void printEstimates(const SweepSummaryType *summary) {
+    const char *names[] = {"Ghost win rate", "Match accuracy"};
+    int index = 0;
+    for (int metric = CI_GHOST_WIN; metric <= CI_ACCURACY; metric <<= 1, index++) {
+        long long successes, trials;
+        double low, high;
+        estimateMetric(summary, metric, &successes, &trials);
+        wilsonInterval(successes, trials, &low, &high);
+        // Metrics with no trials have no estimate to print
+        if (trials == 0) {
+            printf("%-18s n/a\n", names[index]);
+        } else {
+            printf("%-18s %.3f [%.3f, %.3f] over %lld\n", names[index], (double)successes / trials, low, high, trials);
+        }
+    }
+}
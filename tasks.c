@@ -0,0 +1,291 @@
+#include "defs.h"
+#include <sched.h>  // for sched_yield
+
+// The pool every hunt of the tasks engine in the process shares, its threads started by the first hunt
+static TaskPoolType pool = {
+    .lock = PTHREAD_MUTEX_INITIALIZER,
+    .queue = NULL,
+    .queued = 0,
+    .capacity = 0,
+    .queuedTotal = 0,
+    .threads = NULL,
+    .numThreads = 0,
+    .stopping = C_FALSE
+};
+
+
+/*
+    Function: dueBefore
+    Purpose: Orders two queued tasks: the one due first, or the one queued first if they are due at the same time.
+    Params:
+        Input:
+            const AgentTaskType *a (in) - a task
+            const AgentTaskType *b (in) - another task
+        Output: int - C_TRUE if a is resumed before b, C_FALSE otherwise
+*/
+static int dueBefore(const AgentTaskType *a, const AgentTaskType *b) {
+    return a->wakeNanos < b->wakeNanos || (a->wakeNanos == b->wakeNanos && a->order < b->order);
+}
+
+
+/*
+    Function: queueTask
+    Purpose: Adds a task to the pool's queue, sifting it up the heap to its place by wake time, and wakes a thread to resume
+        it. Hunts with different delays share the pool, so a task due now never waits behind one that is not. The caller
+        holds the pool's lock.
+    Params:
+        Input: AgentTaskType *task (in) - the task to queue
+        Output: void
+*/
+static void queueTask(AgentTaskType *task) {
+    if (pool.queued == pool.capacity) {
+        pool.capacity = pool.capacity > 0 ? pool.capacity * 2 : 64;
+        pool.queue = realloc(pool.queue, sizeof(AgentTaskType *) * pool.capacity);
+    }
+    task->order = pool.queuedTotal++;
+    int slot = pool.queued++;
+    while (slot > 0 && dueBefore(task, pool.queue[(slot - 1) / 2])) {
+        pool.queue[slot] = pool.queue[(slot - 1) / 2];
+        slot = (slot - 1) / 2;
+    }
+    pool.queue[slot] = task;
+    pthread_cond_signal(&pool.ready);
+}
+
+
+/*
+    Function: takeTask
+    Purpose: Removes the root of the pool's queue, the task due first, sifting the last task down the heap in its place.
+        The caller holds the pool's lock and the queue is not empty.
+    Params:
+        Output: AgentTaskType* - the task due first
+*/
+static AgentTaskType *takeTask() {
+    AgentTaskType *first = pool.queue[0];
+    AgentTaskType *last = pool.queue[--pool.queued];
+    int slot = 0;
+    while (C_TRUE) {
+        int child = 2 * slot + 1;
+        if (child >= pool.queued) {
+            break;
+        }
+        if (child + 1 < pool.queued && dueBefore(pool.queue[child + 1], pool.queue[child])) {
+            child++;
+        }
+        if (!dueBefore(pool.queue[child], last)) {
+            break;
+        }
+        pool.queue[slot] = pool.queue[child];
+        slot = child;
+    }
+    pool.queue[slot] = last;
+    return first;
+}
+
+
+/*
+    Function: resumeAgent
+    Purpose: Resumes an agent for one action, with the random stream it left off with, then suspends it until its next
+        action is due. The action is the one the threads engine performs, room locks included, so the rules are the same.
+    Params:
+        Input: AgentTaskType *task (in/out) - the agent to resume
+        Output: int - C_TRUE if the agent acts again, C_FALSE if it left the house or the hunt is over
+*/
+static int resumeAgent(AgentTaskType *task) {
+    HouseType *house = task->hunt->house;
+    if (isHuntOver(house)) {
+        return C_FALSE;
+    }
+    seedRandom(task->random);
+    int acting = task->hunter != NULL ? performHunterAction(house, task->hunter) : performGhostAction(house);
+    task->random = randomState();
+    // Sleep in the queue rather than on the thread, so the thread resumes other agents meanwhile
+    if (house->config->actionDelay > 0) {
+        task->wakeNanos = monotonicNanos() + house->config->actionDelay * 1000LL;
+    } else {
+        // As pauseAgent does, give up the CPU between actions, or a pool thread blocked on a room lock this thread keeps
+        // taking would starve
+        task->wakeNanos = 0;
+        sched_yield();
+    }
+    return acting == C_TRUE && !isHuntOver(house);
+}
+
+
+/*
+    Function: taskThread
+    Purpose: Runs in each thread of the pool: resumes the task at the root of the queue once it is due, queues it again if
+        it still acts, and counts it out of its hunt otherwise. Stops once the pool is stopping and the queue is empty.
+    Params:
+        Input: void *arg (in) - unused
+        Output: void
+*/
+static void *taskThread(void *arg) {
+    (void)arg;
+    pthread_mutex_lock(&pool.lock);
+    while (C_TRUE) {
+        if (pool.queued == 0) {
+            if (pool.stopping) {
+                break;
+            }
+            pthread_cond_wait(&pool.ready, &pool.lock);
+            continue;
+        }
+        // The root of the queue is the task due first, whichever hunt it belongs to
+        AgentTaskType *task = pool.queue[0];
+        long long now = monotonicNanos();
+        if (task->wakeNanos > now) {
+            struct timespec until = {task->wakeNanos / 1000000000LL, task->wakeNanos % 1000000000LL};
+            pthread_cond_timedwait(&pool.ready, &pool.lock, &until);
+            continue;
+        }
+        takeTask();
+        pthread_mutex_unlock(&pool.lock);
+
+        int acting = resumeAgent(task);
+
+        pthread_mutex_lock(&pool.lock);
+        if (acting) {
+            queueTask(task);
+        } else if (--task->hunt->live == 0) {
+            pthread_cond_broadcast(&pool.finished);
+        }
+    }
+    pthread_mutex_unlock(&pool.lock);
+    // Add the phases this thread timed to the profile
+    flushProfile();
+    return NULL;
+}
+
+
+/*
+    Function: startPool
+    Purpose: Starts the pool's threads, unless they are running already: the pool keeps the size of the first hunt that
+        started it until stopTasks, whatever later hunts ask for. The caller holds the pool's lock.
+    Params:
+        Input: int numThreads (in) - the number of threads to start
+        Output: void
+*/
+static void startPool(int numThreads) {
+    if (pool.threads != NULL) {
+        return;
+    }
+    // Timed waits count on the monotonic clock, the one wake times are taken from
+    pthread_condattr_t attributes;
+    pthread_condattr_init(&attributes);
+    pthread_condattr_setclock(&attributes, CLOCK_MONOTONIC);
+    pthread_cond_init(&pool.ready, &attributes);
+    pthread_condattr_destroy(&attributes);
+    pthread_cond_init(&pool.finished, NULL);
+
+    pool.stopping = C_FALSE;
+    pool.numThreads = numThreads;
+    pool.threads = malloc(sizeof(pthread_t) * numThreads);
+    for (int i = 0; i < numThreads; i++) {
+        pthread_create(&pool.threads[i], NULL, taskThread, NULL);
+    }
+}
+
+
+/*
+    Function: startHuntTasks
+    Purpose: Queues a task for every hunter and the ghost of a house on the pool, starting the pool if this is the first
+        hunt, and returns at once. Many hunts can run on the pool at the same time.
+    Params:
+        Input:
+            HouseType *house (in/out) - the house of the hunt, set up and not yet simulated
+            HuntTasksType *hunt (out) - the running hunt, to wait for with waitHuntTasks
+        Output: void
+*/
+void startHuntTasks(HouseType *house, HuntTasksType *hunt) {
+    int numHunters = house->registry.count;
+    hunt->house = house;
+    hunt->tasks = malloc(sizeof(AgentTaskType) * (numHunters + 1));
+    hunt->live = numHunters + 1;
+    hunt->startNanos = monotonicNanos();
+    // Every hunter is in the house before any task can exit
+    atomic_store(&house->huntersInHouse, numHunters);
+
+    // Each agent starts on its own stream of the hunt's seed, as in the threads engine
+    for (int i = 0; i <= numHunters; i++) {
+        AgentTaskType *task = &hunt->tasks[i];
+        task->hunt = hunt;
+        task->hunter = i < numHunters ? &house->registry.table[i] : NULL;
+        task->random = deriveSeed(house->seed, i < numHunters ? 2 + i : 1);
+        task->wakeNanos = 0;
+        if (task->hunter != NULL) {
+            metricsAdd(house->metrics, MET_HUNTERS_ALIVE, 1);
+        }
+    }
+
+    pthread_mutex_lock(&pool.lock);
+    startPool(house->config->taskThreads);
+    for (int i = 0; i <= numHunters; i++) {
+        queueTask(&hunt->tasks[i]);
+    }
+    pthread_mutex_unlock(&pool.lock);
+}
+
+
+/*
+    Function: waitHuntTasks
+    Purpose: Waits until every task of a hunt has finished, then frees them and times the hunt.
+    Params:
+        Input: HuntTasksType *hunt (in/out) - the hunt started by startHuntTasks
+        Output: void
+*/
+void waitHuntTasks(HuntTasksType *hunt) {
+    pthread_mutex_lock(&pool.lock);
+    while (hunt->live > 0) {
+        pthread_cond_wait(&pool.finished, &pool.lock);
+    }
+    pthread_mutex_unlock(&pool.lock);
+    huntersStopped(hunt->house);
+    free(hunt->tasks);
+    hunt->tasks = NULL;
+    hunt->house->micros = (monotonicNanos() - hunt->startNanos) / 1000;
+}
+
+
+/*
+    Function: runTasks
+    Purpose: Simulates one hunt on the task pool until its outcome is decided.
+    Params:
+        Input: HouseType *house (in/out) - the house where the hunters and the ghost are
+        Output: void
+*/
+void runTasks(HouseType *house) {
+    HuntTasksType hunt;
+    startHuntTasks(house, &hunt);
+    waitHuntTasks(&hunt);
+}
+
+
+/*
+    Function: stopTasks
+    Purpose: Stops the pool's threads once no hunt is running, so their profiles are added and their memory freed. A later
+        hunt starts the pool again.
+    Params:
+        Output: void
+*/
+void stopTasks() {
+    pthread_mutex_lock(&pool.lock);
+    if (pool.threads == NULL) {
+        pthread_mutex_unlock(&pool.lock);
+        return;
+    }
+    pool.stopping = C_TRUE;
+    pthread_cond_broadcast(&pool.ready);
+    pthread_mutex_unlock(&pool.lock);
+
+    for (int i = 0; i < pool.numThreads; i++) {
+        pthread_join(pool.threads[i], NULL);
+    }
+    free(pool.threads);
+    pool.threads = NULL;
+    free(pool.queue);
+    pool.queue = NULL;
+    pool.capacity = 0;
+    pthread_cond_destroy(&pool.ready);
+    pthread_cond_destroy(&pool.finished);
+}
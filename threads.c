@@ -1,4 +1,178 @@
 #include "defs.h"
+#include <sched.h>        // for sched_yield
+#include <linux/futex.h>  // for FUTEX_WAIT_PRIVATE
+#include <sys/syscall.h>  // for SYS_futex
+
+
+/*
+    Function: pauseAgent
+    Purpose: Pauses an agent between actions for the configured delay, or just yields the CPU when the delay is 0 so agents still interleave.
+    Params:
+        Input: HouseType *house (in) - the house where the agent is
+        Output: void
+*/
+void pauseAgent(HouseType *house) {
+    if (house->config->actionDelay > 0) {
+        usleep(house->config->actionDelay);
+    } else {
+        sched_yield();
+    }
+}
+
+
+/*
+    Function: restAgent
+    Purpose: Sleeps an agent until a deadline under --wake event, on a futex over the hunt's state, so the hunt ending wakes it
+        at once rather than after its delay, and nothing else does.
+    Params:
+        Input:
+            HouseType *house (in) - the house where the agent is
+            long long deadline (in) - the monotonic time to sleep until
+        Output: void
+*/
+static void restAgent(HouseType *house, long long deadline) {
+    while (!isHuntOver(house)) {
+        long long left = deadline - monotonicNanos();
+        if (left <= 0) {
+            break;
+        }
+        struct timespec timeout = {left / 1000000000LL, left % 1000000000LL};
+        syscall(SYS_futex, &house->state, FUTEX_WAIT_PRIVATE, HUNT_RUNNING, &timeout, NULL, 0);
+    }
+}
+
+
+/*
+    Function: takePlanned
+    Purpose: Takes the next action a hunter drew ahead.
+    Params:
+        Input: HunterType *hunter (in/out) - the hunter, with at least one action drawn ahead
+        Output: int - the action, as drawn by randInt(0, 3)
+*/
+static int takePlanned(HunterType *hunter) {
+    int action = hunter->planned[0];
+    hunter->plannedCount--;
+    memmove(hunter->planned, hunter->planned + 1, hunter->plannedCount);
+    return action;
+}
+
+
+/*
+    Function: planIdle
+    Purpose: Draws a hunter's coming actions ahead, from its own stream, to count the periods in which it would change nothing
+        but its boredom timer: collecting in a room without the ghost or evidence it detects, or reviewing while no review can
+        end the hunt. A move, a review that could end the hunt, or the period it would leave bored, is still acted on time.
+        Runs under the lock of the hunter's room, reading the room's events first, so any change to the room after the
+        lock is released is seen by parkHunter.
+    Params:
+        Input:
+            HouseType *house (in) - the house where the hunter is
+            HunterType *hunter (in/out) - the hunter that just acted and stays in its room
+        Output: void
+*/
+static void planIdle(HouseType *house, HunterType *hunter) {
+    RoomType *room = hunter->currentRoom;
+    hunter->seenEvents = atomic_load(&room->events);
+    hunter->idlePeriods = 0;
+    if ((room->ghost != NULL && room->ghost->room == room) || room->evidence.counts[hunter->equipmentType] > 0) {
+        return;
+    }
+    // Reviews end the hunt only once three types are known and, with directed movement, from the Van
+    int reviewIdle = __builtin_popcount(atomic_load(&house->evidenceMask)) < 3 || (house->routes != NULL && room->id != 0);
+    int boredom = atomic_load_explicit(&hunter->boredomTimer, memory_order_relaxed);
+    while (hunter->idlePeriods < WAKE_PLAN) {
+        if (hunter->idlePeriods == hunter->plannedCount) {
+            hunter->planned[hunter->plannedCount++] = randInt(0, 3);
+        }
+        int action = hunter->planned[hunter->idlePeriods];
+        if (action == 1 || (action != 0 && !reviewIdle) || boredom + 1 >= house->config->boredomMax) {
+            break;
+        }
+        boredom++;
+        hunter->idlePeriods++;
+    }
+}
+
+
+/*
+    Function: skipIdle
+    Purpose: Applies idle periods a parked hunter slept through, as they would have been acted: each adds to the boredom timer
+        and counts its collect or review, without taking the room's lock.
+    Params:
+        Input:
+            HouseType *house (in) - the house where the hunter is
+            HunterType *hunter (in/out) - the hunter
+            int periods (in) - the idle periods to apply, at most the hunter's planned ones
+        Output: void
+*/
+static void skipIdle(HouseType *house, HunterType *hunter, int periods) {
+    for (int i = 0; i < periods; i++) {
+        int action = takePlanned(hunter);
+        atomic_store_explicit(&hunter->boredomTimer, atomic_load_explicit(&hunter->boredomTimer, memory_order_relaxed) + 1,
+                              memory_order_relaxed);
+        if (action == 0) {
+            metricsAdd(house->metrics, MET_HUNTER_COLLECT, 1);
+        } else {
+            metricsAdd(house->metrics, MET_HUNTER_REVIEW, 1);
+            LOG(LOG_HUNTER_REVIEW, l_hunterReview(hunter->name, reviewEvidence(house) >= 3 ? LOG_SUFFICIENT : LOG_INSUFFICIENT));
+        }
+    }
+    metricsAdd(house->metrics, MET_IDLE_SKIPPED, periods);
+}
+
+
+/*
+    Function: parkHunter
+    Purpose: Paces a hunter between actions under --wake event. A hunter with idle periods ahead parks on its room's event
+        count, sleeping in the kernel through them and the period after, so it takes no timer wakeup and no lock for them.
+        The ghost entering, evidence dropped, a review becoming able to end the hunt, or the hunt ending wakes it early; it then
+        applies the idle periods that went by and acts again when the current period is up, so it never acts faster than
+        --delay. A hunter with nothing to skip rests for the delay, woken only by the hunt ending.
+    Params:
+        Input:
+            HouseType *house (in) - the house where the hunter is
+            HunterType *hunter (in/out) - the hunter that just acted
+        Output: void
+*/
+void parkHunter(HouseType *house, HunterType *hunter) {
+    int idle = hunter->idlePeriods;
+    if (house->config->actionDelay <= 0) {
+        sched_yield();
+        return;
+    }
+    if (idle == 0) {
+        restAgent(house, monotonicNanos() + house->config->actionDelay * 1000LL);
+        return;
+    }
+    hunter->idlePeriods = 0;
+    RoomType *room = hunter->currentRoom;
+    unsigned int seen = hunter->seenEvents;
+    long long period = house->config->actionDelay * 1000LL;
+    long long start = monotonicNanos();
+    long long deadline = start + (idle + 1) * period;
+    // Count the hunter in before looking at the events, the reverse of signalRoom
+    atomic_fetch_add(&room->parked, 1);
+    while (atomic_load(&room->events) == seen && !isHuntOver(house)) {
+        long long left = deadline - monotonicNanos();
+        if (left <= 0) {
+            break;
+        }
+        // Returns at once if an event was counted since the hunter planned
+        struct timespec timeout = {left / 1000000000LL, left % 1000000000LL};
+        syscall(SYS_futex, &room->events, FUTEX_WAIT_PRIVATE, seen, &timeout, NULL, 0);
+    }
+    atomic_fetch_sub(&room->parked, 1);
+
+    // The periods that went by before anything happened changed nothing but the boredom timer
+    long long elapsed = (monotonicNanos() - start) / period;
+    int slept = elapsed < idle ? (int)elapsed : idle;
+    skipIdle(house, hunter, slept);
+    if (slept < idle && !isHuntOver(house)) {
+        // Woken early: the rest of the drawn actions are acted as usual, from the end of the current period
+        metricsAdd(house->metrics, MET_EVENT_WAKEUPS, 1);
+        restAgent(house, start + (slept + 1) * period);
+    }
+}
 
 
 /*
@@ -11,14 +185,25 @@
 void *ghostThread(void *arg){
     // Cast the argument to HouseType
     HouseType *house = (HouseType *)arg;
+    // The ghost draws from its own stream of the hunt's seed
+    seedRandom(deriveSeed(house->seed, 1));
 
-    // Infinite loop for the ghost's actions
-    while (C_TRUE) {
+    // Act until the hunt is over or the ghost leaves
+    while (!isHuntOver(house)) {
         // Perform the ghost's action, passing in the house
-        performGhostAction(house);
-        // Sleep for a while before the next action
-        usleep(10000);
+        if (performGhostAction(house) == C_FALSE) {
+            break;
+        }
+        // Sleep for a while before the next action, the ghost acts every period whatever the pacing
+        if (house->config->wake == WAKE_EVENT && house->config->actionDelay > 0) {
+            restAgent(house, monotonicNanos() + house->config->actionDelay * 1000LL);
+        } else {
+            pauseAgent(house);
+        }
     }
+    // Add the phases this thread timed to the profile
+    flushProfile();
+    return NULL;
 }
 
 
@@ -35,16 +220,189 @@ void *hunterThread(void *arg){
     // Get the house and the hunter from the thread data
     HouseType *house = threadData->house;
     HunterType *hunter = threadData->hunter;
+    // Each hunter draws from its own stream of the hunt's seed
+    seedRandom(deriveSeed(house->seed, 2 + threadData->hunter->id));
     // Free the memory allocated for thread data
     free(threadData);
 
-    // Infinite loop for the hunter's actions
-    while (C_TRUE) {
+    // Act until the hunt is over or the hunter leaves
+    while (!isHuntOver(house)) {
         // Perform the hunter's action, passing in the house and the hunter
-        performHunterAction(house, hunter);
-        // Sleep for a while before the next action
-        usleep(10000);
+        if (performHunterAction(house, hunter) == C_FALSE) {
+            break;
+        }
+        // Sleep for a while before the next action, or through the idle periods ahead
+        if (house->config->wake == WAKE_EVENT) {
+            parkHunter(house, hunter);
+        } else {
+            pauseAgent(house);
+        }
+    }
+    // Add the phases this thread timed to the profile
+    flushProfile();
+    return NULL;
+}
+
+
+/*
+    Function: profileDrawn
+    Purpose: Ends the timing of an agent picking its action, when the action is profiled, and starts timing its details.
+    Params:
+        Input:
+            IntentType *intent (out) - the action picked, marked as timed or not
+            enum ProfilePhase phase (in) - the phase of picking the action
+            uint64_t start (in) - what profileStart returned when the agent started deciding
+        Output: uint64_t - the clock when the details started, 0 when the action is not timed
+*/
+static uint64_t profileDrawn(IntentType *intent, enum ProfilePhase phase, uint64_t start) {
+    intent->timed = start != 0;
+    intent->ticks = 0;
+    if (start == 0) {
+        return 0;
+    }
+    uint64_t now = profileClock();
+    recordPhase(phase, now - start);
+    return now;
+}
+
+
+/*
+    Function: profileApplied
+    Purpose: Records the time a profiled action took, from working out its details when deciding to applying it.
+    Params:
+        Input:
+            enum ProfilePhase phase (in) - the phase of the action
+            const IntentType *intent (in) - the action, with the ticks its details took
+            uint64_t start (in) - the clock when applying started, 0 when the action is not timed
+        Output: void
+*/
+static void profileApplied(enum ProfilePhase phase, const IntentType *intent, uint64_t start) {
+    if (start != 0) {
+        recordPhase(phase, intent->ticks + profileClock() - start);
+    }
+}
+
+
+/*
+    Function: decideGhost
+    Purpose: Decides the ghost's action from the state of the house, updating only the ghost's own boredom. Draws every random
+        number of the action, and touches nothing other agents read, so the lockstep engine can decide for agents in parallel.
+    Params:
+        Input: 
+            HouseType *house (in) - the house where the ghost is
+            GhostType *ghost (in/out) - the ghost to decide for
+            RoomType *currentRoom (in) - the room the ghost is in
+            IntentType *intent (out) - what the ghost will do
+        Output: void
+*/
+void decideGhost(HouseType *house, GhostType *ghost, RoomType *currentRoom, IntentType *intent) {
+    uint64_t start = profileStart();
+    intent->action = ACT_IDLE;
+    intent->moveTo = NULL;
+    // Increase the ghost's boredom timer
+    ghost->boredomTimer++;
+
+    // If there's a hunter in the room
+    if (isHunterPresent(currentRoom) == C_TRUE) {
+        // Reset the ghost's boredom timer
+        ghost->boredomTimer = 0;
+        int action = randInt(0, 1);
+        // If the action is 0, leave evidence
+        if (action == 0) {
+            intent->action = ACT_EVIDENCE;
+        }
+    } else {
+        int action = randInt(0, 2);
+        // If the action is 0, move the ghost, and if it is 1, leave evidence
+        if (action == 0) {
+            intent->action = ACT_MOVE;
+        } else if (action == 1) {
+            intent->action = ACT_EVIDENCE;
+        }
+    }
+    uint64_t drawn = profileDrawn(intent, PROF_GHOST_DECIDE, start);
+
+    // Pick the room to move to by the hunt's movement policy, or the evidence to leave
+    if (intent->action == ACT_MOVE) {
+        intent->moveTo = chooseGhostMove(house, currentRoom);
+    } else if (intent->action == ACT_EVIDENCE) {
+        intent->evidence = randomEvidence(ghost->ghostType);
+    }
+    if (drawn != 0) {
+        intent->ticks = profileClock() - drawn;
+    }
+}
+
+
+/*
+    Function: applyGhost
+    Purpose: Applies the action the ghost decided on to its room and the house, and makes it leave once bored.
+        The caller must own the room, and performs any move itself, since moving touches the room next door.
+    Params:
+        Input: 
+            HouseType *house (in) - the house where the ghost is
+            GhostType *ghost (in) - the ghost acting
+            RoomType *currentRoom (in) - the room the ghost is in
+            const IntentType *intent (in) - what the ghost decided to do
+            RoomType **moveTo (out) - the room to move to, when STEP_MOVING is returned
+        Output: int - STEP_STAYED, STEP_MOVING, or STEP_EXITED if it left because of boredom
+*/
+int applyGhost(HouseType *house, GhostType *ghost, RoomType *currentRoom, const IntentType *intent, RoomType **moveTo) {
+    int outcome = STEP_STAYED;
+    // Every ghost action is a tick spent in its room
+    heatAdd(house, currentRoom, HEAT_GHOST_TICKS);
+    uint64_t start = intent->timed ? profileClock() : 0;
+    if (intent->action == ACT_EVIDENCE) {
+        // Leave the evidence, and let directed hunters know where it is
+        if (leaveEvidence(&(currentRoom->evidence), intent->evidence, house->config) == C_FALSE) {
+            heatAdd(house, currentRoom, HEAT_EVIDENCE_FORGOTTEN);
+        } else if (house->samples != NULL) {
+            atomic_fetch_add_explicit(&house->roomEvidence, 1, memory_order_relaxed);
+        }
+        atomic_store_explicit(&house->evidenceHint[intent->evidence], currentRoom->id, memory_order_relaxed);
+        // Wake the hunters parked in the room, there is evidence to collect
+        if (house->config->wake == WAKE_EVENT) {
+            signalRoom(currentRoom);
+        }
+        LOG(LOG_GHOST_EVIDENCE, l_ghostEvidence(intent->evidence, currentRoom->name));
+        metricsAdd(house->metrics, MET_GHOST_EVIDENCE, 1);
+        ghost->evidenceDropped++;
+        heatAdd(house, currentRoom, HEAT_EVIDENCE_DROPPED);
+        profileApplied(PROF_GHOST_EVIDENCE, intent, start);
+    } else if (intent->action == ACT_MOVE) {
+        *moveTo = intent->moveTo;
+        outcome = *moveTo != NULL ? STEP_MOVING : STEP_STAYED;
+        metricsAdd(house->metrics, MET_GHOST_MOVE, 1);
+        profileApplied(PROF_GHOST_MOVE, intent, start);
+    } else {
+        metricsAdd(house->metrics, MET_GHOST_IDLE, 1);
+    }
+
+    // If the ghost's boredom timer reaches the maximum, it leaves instead
+    if (ghost->boredomTimer >= house->config->boredomMax) {
+        LOG(LOG_GHOST_EXIT, l_ghostExit(LOG_BORED));
+        return STEP_EXITED;
     }
+    return outcome;
+}
+
+
+/*
+    Function: stepGhost
+    Purpose: Applies the ghost's rules for one action in its room: boredom, leaving evidence, and choosing whether to move or leave.
+        The caller must own the room, and performs any move itself, since moving touches the room next door.
+    Params:
+        Input: 
+            HouseType *house (in) - the house where the ghost is
+            GhostType *ghost (in) - the ghost to act
+            RoomType *currentRoom (in) - the room the ghost is in
+            RoomType **moveTo (out) - the room to move to, when STEP_MOVING is returned
+        Output: int - STEP_STAYED, STEP_MOVING, or STEP_EXITED if it left because of boredom
+*/
+int stepGhost(HouseType *house, GhostType *ghost, RoomType *currentRoom, RoomType **moveTo) {
+    IntentType intent;
+    decideGhost(house, ghost, currentRoom, &intent);
+    return applyGhost(house, ghost, currentRoom, &intent, moveTo);
 }
 
 
@@ -53,9 +411,11 @@ void *hunterThread(void *arg){
     Purpose: Performs all of the simulation actions for the ghost in the house.
     Params:
         Input: HouseType *house (in) - the house where the ghost is
-        Output: void
+        Output: int - C_TRUE if the ghost is still in the house, C_FALSE if it left because of boredom
 */
-void performGhostAction(HouseType *house) {
+int performGhostAction(HouseType *house) {
+    // Count the tick, sampling the hunt's state before the ghost acts
+    countTick(house);
     // Get the first room in the house
     RoomNodeType *currentRoomNode = house->rooms.head;
     // Loop through all rooms
@@ -63,45 +423,26 @@ void performGhostAction(HouseType *house) {
         RoomType *currentRoom = currentRoomNode->room;
 
         // Wait for the semaphore to be available
-        sem_wait(&(currentRoom->roomSem));
+        uint64_t start = profileStart();
+        lockRoom(currentRoom, house->metrics);
+        profileStop(PROF_GHOST_SCAN, start);
 
         // If there's a ghost in the room
         if (currentRoom->ghost != NULL) {
             GhostType *currentGhost = currentRoom->ghost;
-            // Increase the ghost's boredom timer
-            currentGhost->boredomTimer++;
-
-            // If there's a hunter in the room
-            if (isHunterPresent(currentRoom) == C_TRUE) {
-                // Reset the ghost's boredom timer
-                currentGhost->boredomTimer = 0;
-                int action = randInt(0, 1);
-                // If the action is 0, leave evidence
-                if (action == 0) {
-                    enum EvidenceType evidence = randomEvidence(currentGhost->ghostType);
-                    insertAtHeadEvidence(&(currentRoom->evidences), evidence);
-                    l_ghostEvidence(evidence, currentRoom->name);
-                }
-            } else {
-                int action = randInt(0, 2);
-                // If the action is 0, move the ghost to a random room
-                if (action == 0) {
-                    moveGhostToRandomRoom(currentGhost, currentRoom);
-                    l_ghostMove(currentRoom->name);
-                } else if (action == 1) {
-                    // If the action is 1, leave evidence
-                    enum EvidenceType evidence = randomEvidence(currentGhost->ghostType);
-                    insertAtHeadEvidence(&(currentRoom->evidences), evidence);
-                    l_ghostEvidence(evidence, currentRoom->name);
+            RoomType *moveTo = NULL;
+            int outcome = stepGhost(house, currentGhost, currentRoom, &moveTo);
+            // Move the ghost to the room it picked
+            if (outcome == STEP_MOVING) {
+                moveGhostToRoom(currentGhost, currentRoom, moveTo);
+                // Wake the hunters parked where the ghost went
+                if (house->config->wake == WAKE_EVENT) {
+                    signalRoom(moveTo);
                 }
-            }
-
-            // If the ghost's boredom timer reaches the maximum
-            if (currentGhost->boredomTimer >= BOREDOM_MAX) {
-                l_ghostExit(LOG_BORED);
-                // Release the semaphore before exiting the thread
+            } else if (outcome == STEP_EXITED) {
+                // Release the semaphore before leaving the house
                 sem_post(&(currentRoom->roomSem));
-                pthread_exit(NULL);
+                return C_FALSE;
             }
         }
 
@@ -110,85 +451,211 @@ void performGhostAction(HouseType *house) {
         // Move to the next room
         currentRoomNode = currentRoomNode->next;
     }
+    return C_TRUE;
 }
 
 
 /*
-    Function: performHunterAction
-    Purpose: Performs all of the simulation actions for a given hunter in the house.
+    Function: decideHunter
+    Purpose: Decides a hunter's action from the state of the house, updating only the hunter's own fear and boredom. Draws every
+        random number of the action but those of the radio, and touches nothing other agents read, so the lockstep engine can
+        decide for agents in parallel.
     Params:
         Input: 
             HouseType *house (in) - the house where the hunter is
-            HunterType *hunter (in) - the hunter to perform the action
+            HunterType *hunter (in/out) - the hunter to decide for
+            IntentType *intent (out) - what the hunter will do
         Output: void
 */
-void performHunterAction(HouseType *house, HunterType *hunter) {
+void decideHunter(HouseType *house, HunterType *hunter, IntentType *intent) {
+    uint64_t start = profileStart();
     // Get the current room of the hunter
     RoomType *currentRoom = hunter->currentRoom;
-
-    // Lock the room to prevent other threads from accessing it
-    sem_wait(&(currentRoom->roomSem));
+    intent->moveTo = NULL;
 
     // If there is a ghost in the room and the ghost's room is the current room
     if (currentRoom->ghost != NULL && currentRoom->ghost->room == currentRoom) {
-        // Increase the hunter's fear
-        hunter->fear += 1;
+        // Increase the hunter's fear, and remember where the ghost was. Only the hunter's own thread writes its fear, boredom
+        // and exit, but the ghost's thread samples them, so the stores are atomic, though relaxed
+        atomic_store_explicit(&hunter->fear, atomic_load_explicit(&hunter->fear, memory_order_relaxed) + 1, memory_order_relaxed);
+        hunter->ghostSeen = currentRoom->id;
+        heatAdd(house, currentRoom, HEAT_FEAR);
         // Reset the hunter's boredom timer
-        hunter->boredomTimer = 0;
+        atomic_store_explicit(&hunter->boredomTimer, 0, memory_order_relaxed);
     } else {
         // Increase the hunter's boredom timer
-        hunter->boredomTimer += 1;
+        atomic_store_explicit(&hunter->boredomTimer, atomic_load_explicit(&hunter->boredomTimer, memory_order_relaxed) + 1,
+                              memory_order_relaxed);
     }
 
-    // Generate a random action for the hunter
-    int action = randInt(0, 3);
-    // If the action is 0
-    if (action == 0) {
+    // Generate a random action for the hunter, or take the one drawn ahead under --wake event
+    int action = hunter->plannedCount > 0 ? takePlanned(hunter) : randInt(0, 3);
+    // Collect evidence in the room, move, or review the evidence in the house
+    intent->action = action == 0 ? ACT_COLLECT : action == 1 ? ACT_MOVE : ACT_REVIEW;
+    uint64_t drawn = profileDrawn(intent, PROF_HUNTER_DECIDE, start);
+
+    if (intent->action == ACT_MOVE) {
+        // Pick the room to move the hunter to, by the hunt's movement policy
+        intent->moveTo = chooseHunterMove(house, hunter);
+    } else if (intent->action == ACT_REVIEW) {
+        // Count the evidence the hunter knows of
+        intent->evidenceCount = reviewHunterEvidence(house, hunter);
+    }
+    if (drawn != 0) {
+        intent->ticks = profileClock() - drawn;
+    }
+}
+
+
+/*
+    Function: applyHunter
+    Purpose: Applies the action a hunter decided on to its room and the house, and makes it leave with enough evidence, or once
+        too scared or bored. The caller must own the room, and performs any move itself, since moving touches the room next door.
+    Params:
+        Input: 
+            HouseType *house (in) - the house where the hunter is
+            HunterType *hunter (in) - the hunter acting
+            const IntentType *intent (in) - what the hunter decided to do
+            RoomType **moveTo (out) - the room to move to, when STEP_MOVING is returned
+        Output: int - STEP_STAYED, STEP_MOVING, or STEP_EXITED if it left the house
+*/
+int applyHunter(HouseType *house, HunterType *hunter, const IntentType *intent, RoomType **moveTo) {
+    // Get the current room of the hunter
+    RoomType *currentRoom = hunter->currentRoom;
+    int outcome = STEP_STAYED;
+    uint64_t start = intent->timed ? profileClock() : 0;
+
+    if (intent->action == ACT_COLLECT) {
         // Collect evidence in the room
         collectEvidence(house, hunter, currentRoom);
-    } else if (action == 1) {
-        // Move the hunter to a random room
-        moveHunterToRandomRoom(hunter, currentRoom);
+        metricsAdd(house->metrics, MET_HUNTER_COLLECT, 1);
+        profileApplied(PROF_HUNTER_COLLECT, intent, start);
+    } else if (intent->action == ACT_MOVE) {
+        *moveTo = intent->moveTo;
+        outcome = *moveTo != NULL ? STEP_MOVING : STEP_STAYED;
+        // Forget the evidence hint once the hunter found its room empty
+        int hint = currentRoom->id;
+        if (house->routes != NULL) {
+            atomic_compare_exchange_strong(&house->evidenceHint[hunter->equipmentType], &hint, -1);
+        }
+        // Let a directed ghost know where the hunters are heading
+        if (*moveTo != NULL) {
+            atomic_store_explicit(&house->hunterHint, (*moveTo)->id, memory_order_relaxed);
+            hunter->moves++;
+            heatAdd(house, *moveTo, HEAT_HUNTER_VISITS);
+        }
+        metricsAdd(house->metrics, MET_HUNTER_MOVE, 1);
+        profileApplied(PROF_HUNTER_MOVE, intent, start);
     } else {
-        // Review the evidence in the house
-        int uniqueEvidenceCount = reviewEvidence(house);
-        // If there are at least 3 unique pieces of evidence
-        if (uniqueEvidenceCount >= 3) {
+        metricsAdd(house->metrics, MET_HUNTER_REVIEW, 1);
+        int uniqueEvidenceCount = intent->evidenceCount;
+        LOG(LOG_HUNTER_REVIEW, l_hunterReview(hunter->name, uniqueEvidenceCount >= 3 ? LOG_SUFFICIENT : LOG_INSUFFICIENT));
+        // If there are at least 3 unique pieces of evidence, and with directed movement the hunter made it back to the Van
+        if (uniqueEvidenceCount >= 3 && (house->routes == NULL || currentRoom->id == 0)) {
             // Log the hunter's exit due to evidence
-            l_hunterExit(hunter->name, LOG_EVIDENCE);
-            // Remove the hunter from the house
-            removeHunterFromHouse(house, hunter);
-            // Free the memory allocated for the hunter
-            free(hunter);
-            // Unlock the room before exiting the thread
-            sem_post(&(currentRoom->roomSem));
-            pthread_exit(NULL);
-        }   
+            LOG(LOG_HUNTER_EXIT, l_hunterExit(hunter->name, LOG_EVIDENCE));
+            metricsAdd(house->metrics, MET_HUNTERS_ALIVE, -1);
+            // Remove the hunter from its room, the only room it is ever listed in
+            removeHunterFromRoom(currentRoom, hunter);
+            // Stop others sending to the hunter's radio, which the house keeps
+            if (hunter->radio != NULL) {
+                atomic_store_explicit(&hunter->radio->listening, C_FALSE, memory_order_relaxed);
+            }
+            // The hunters have won, which ends the hunt
+            atomic_store_explicit(&hunter->exited, C_TRUE, memory_order_relaxed);
+            hunterExited(house, C_TRUE);
+            profileApplied(PROF_HUNTER_REVIEW, intent, start);
+            return STEP_EXITED;
+        }
+        profileApplied(PROF_HUNTER_REVIEW, intent, start);
     }
 
     // If the hunter's fear or boredom reaches the maximum
-    if (hunter->fear >= FEAR_MAX || hunter->boredomTimer >= BOREDOM_MAX) {
+    int fear = atomic_load_explicit(&hunter->fear, memory_order_relaxed);
+    if (fear >= house->config->fearMax || atomic_load_explicit(&hunter->boredomTimer, memory_order_relaxed) >= house->config->boredomMax) {
         // If the hunter's fear reaches the maximum
-        if (hunter->fear >= FEAR_MAX) {
-            // Add the hunter to the list of hunters who exited due to fear
-            house->huntersExitedFear->hunters[house->huntersExitedFear->size++] = hunter;
+        if (fear >= house->config->fearMax) {
+            // Add the hunter to the list of hunters who exited due to fear, hunters in other rooms may exit at the same time
+            house->huntersExitedFear.hunters[__atomic_fetch_add(&house->huntersExitedFear.size, 1, __ATOMIC_RELAXED)] = hunter;
             // Log the hunter's exit due to fear
-            l_hunterExit(hunter->name, LOG_FEAR);
+            LOG(LOG_HUNTER_EXIT, l_hunterExit(hunter->name, LOG_FEAR));
         } else {
             // Add the hunter to the list of hunters who exited due to boredom
-            house->huntersExitedBoredom->hunters[house->huntersExitedBoredom->size++] = hunter;
+            house->huntersExitedBoredom.hunters[__atomic_fetch_add(&house->huntersExitedBoredom.size, 1, __ATOMIC_RELAXED)] = hunter;
             // Log the hunter's exit due to boredom
-            l_hunterExit(hunter->name, LOG_BORED);
+            LOG(LOG_HUNTER_EXIT, l_hunterExit(hunter->name, LOG_BORED));
         }
-        // Remove the hunter from the house
-        removeHunterFromHouse(house, hunter);
-        // Unlock the room before exiting the thread
-        sem_post(&(currentRoom->roomSem));
-        pthread_exit(NULL);
+        metricsAdd(house->metrics, MET_HUNTERS_ALIVE, -1);
+        // Remove the hunter from its room, the only room it is ever listed in
+        removeHunterFromRoom(currentRoom, hunter);
+        // Stop others sending to the hunter's radio
+        if (hunter->radio != NULL) {
+            atomic_store_explicit(&hunter->radio->listening, C_FALSE, memory_order_relaxed);
+        }
+        // The last hunter out ends the hunt
+        atomic_store_explicit(&hunter->exited, C_TRUE, memory_order_relaxed);
+        hunterExited(house, C_FALSE);
+        return STEP_EXITED;
+    }
+
+    return outcome;
+}
+
+
+/*
+    Function: stepHunter
+    Purpose: Applies a hunter's rules for one action in its room: radio, fear and boredom, collecting, reviewing, leaving, and
+        choosing whether to move. The caller must own the room, and performs any move itself, since moving touches the room next door.
+    Params:
+        Input: 
+            HouseType *house (in) - the house where the hunter is
+            HunterType *hunter (in) - the hunter to act
+            RoomType **moveTo (out) - the room to move to, when STEP_MOVING is returned
+        Output: int - STEP_STAYED, STEP_MOVING, or STEP_EXITED if it left the house
+*/
+int stepHunter(HouseType *house, HunterType *hunter, RoomType **moveTo) {
+    // Take in radio reports before acting on what the hunter knows
+    if (hunter->radio != NULL) {
+        runRadio(house, hunter->radio);
+    }
+    IntentType intent;
+    decideHunter(house, hunter, &intent);
+    return applyHunter(house, hunter, &intent, moveTo);
+}
+
+
+/*
+    Function: performHunterAction
+    Purpose: Performs all of the simulation actions for a given hunter in the house.
+    Params:
+        Input: 
+            HouseType *house (in) - the house where the hunter is
+            HunterType *hunter (in) - the hunter to perform the action
+        Output: int - C_TRUE if the hunter is still in the house, C_FALSE if it left
+*/
+int performHunterAction(HouseType *house, HunterType *hunter) {
+    // Get the current room of the hunter
+    RoomType *currentRoom = hunter->currentRoom;
+
+    // Lock the room to prevent other threads from accessing it
+    uint64_t start = profileStart();
+    lockRoom(currentRoom, house->metrics);
+    profileStop(PROF_HUNTER_LOCK, start);
+
+    // Act, moving the hunter to the room it picked
+    RoomType *moveTo = NULL;
+    int outcome = stepHunter(house, hunter, &moveTo);
+    if (outcome == STEP_MOVING) {
+        moveHunterToRoom(hunter, currentRoom, moveTo);
+    } else if (outcome == STEP_STAYED && house->config->wake == WAKE_EVENT && house->config->engine == ENGINE_THREADS &&
+               house->config->actionDelay > 0 && hunter->radio == NULL) {
+        // Find the idle periods ahead while the room is still locked; a hunter with a radio takes reports in every action
+        planIdle(house, hunter);
     }
 
     // Unlock the room
     sem_post(&(currentRoom->roomSem));
+    return outcome != STEP_EXITED ? C_TRUE : C_FALSE;
 }
 
 
@@ -198,25 +665,27 @@ void performHunterAction(HouseType *house, HunterType *hunter) {
     Params:
         Input: 
             HouseType *house (in) - the house where the hunters and the ghost are
-            char hunterNames[][MAX_STR] (in) - the names of the hunters
-            int numHunters (in) - the number of hunters
         Output: void
 */
-void createThreads(HouseType *house, char hunterNames[][MAX_STR], int numHunters) {
+void createThreads(HouseType *house) {
+    int numHunters = house->registry.count;
     // Create an array of pthread_t for the hunter threads
     pthread_t hunterThreads[numHunters];
     // Create a pthread_t for the ghost thread
     pthread_t ghostPThread;
+    // Every hunter is in the house before any thread can exit
+    atomic_store(&house->huntersInHouse, numHunters);
 
-    // Loop through all hunters
+    // Loop through all hunters, in id order
     for (int i = 0; i < numHunters; i++) {
-        // Find the current hunter by name
-        HunterType *currentHunter = findHunterByName(house, hunterNames[i]);
+        HunterType *currentHunter = &house->registry.table[i];
         // Allocate memory for the thread data
         ThreadDataType *threadData = malloc(sizeof(ThreadDataType));
         // Set the house and hunter in the thread data
         threadData->house = house;
         threadData->hunter = currentHunter;
+        // The hunter is in the house from now until it exits or the hunt ends
+        metricsAdd(house->metrics, MET_HUNTERS_ALIVE, 1);
         // Create a new thread for the current hunter
         pthread_create(&hunterThreads[i], NULL, hunterThread, (void *)threadData);
     }
@@ -225,10 +694,34 @@ void createThreads(HouseType *house, char hunterNames[][MAX_STR], int numHunters
     pthread_create(&ghostPThread, NULL, ghostThread, (void *)house);
 
     // Wait for all hunter threads to finish
-    for (int i = 0; i < NUM_HUNTERS; i++) {
+    for (int i = 0; i < numHunters; i++) {
         pthread_join(hunterThreads[i], NULL);
     }
 
     // Wait for the ghost thread to finish
     pthread_join(ghostPThread, NULL);
-}
\ No newline at end of file
+    huntersStopped(house);
+}
+
+/*
+    Function: simulateHunt
+    Purpose: Simulates a hunt until its outcome is decided, with the engine picked by the hunt's config.
+    Params:
+        Input: 
+            HouseType *house (in) - the house where the hunters and the ghost are
+        Output: void
+*/
+void simulateHunt(HouseType *house) {
+    long long start = monotonicNanos();
+    if (house->config->engine == ENGINE_ACTOR) {
+        runRoomActors(house);
+    } else if (house->config->engine == ENGINE_LOCKSTEP) {
+        runLockstep(house);
+    } else if (house->config->engine == ENGINE_TASKS) {
+        runTasks(house);
+    } else {
+        createThreads(house);
+    }
+    // Time the hunt, for throughput figures
+    house->micros = (monotonicNanos() - start) / 1000;
+}
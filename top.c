@@ -0,0 +1,78 @@
+#include "defs.h"
+#include <signal.h> // for kill
+#include <time.h>   // for time
+
+
+/*
+    Function: printMetrics
+    Purpose: Prints every counter of a metrics file along with its rate since the previous refresh.
+    Params:
+        Input:
+            MetricsType *metrics (in) - the mapped metrics to print
+            long long previous[] (in/out) - the values printed last refresh, updated to the current values
+            int interval (in) - the number of seconds since the previous refresh
+        Output: void
+*/
+void printMetrics(MetricsType *metrics, long long previous[], int interval) {
+    // Report the writer and whether it is still running
+    int alive = kill(metrics->pid, 0) == 0;
+    printf("SpectraHunter metrics, pid %d (%s), up %llds\n\n", metrics->pid, alive ? "running" : "exited",
+           (long long)time(NULL) - metrics->startTime);
+    printf("%-24s %14s %12s\n", "counter", "value", "per second");
+
+    // Print each counter with its rate over the last interval
+    for (int i = 0; i < MET_COUNT; i++) {
+        long long value = atomic_load_explicit(&metrics->counters[i], memory_order_relaxed);
+        printf("%-24s %14lld %12lld\n", metricName(i), value, (value - previous[i]) / interval);
+        previous[i] = value;
+    }
+}
+
+
+/*
+    Function: main
+    Purpose: Entry point of fp-top. Maps the metrics file written by a running simulator and refreshes its counters every second.
+    Params:
+        Input:
+            int argc (in) - the number of command line arguments
+            char *argv[] (in) - the command line arguments, [FILE] [--once]
+    Returns: int - status code of the program execution
+*/
+int main(int argc, char *argv[]) {
+    // Default to the file name used in the README example
+    const char *path = "fp.metrics";
+    int once = C_FALSE;
+
+    // Parse the arguments
+    for (int i = 1; i < argc; i++) {
+        if (strcmp(argv[i], "--once") == 0) {
+            once = C_TRUE;
+        } else {
+            path = argv[i];
+        }
+    }
+
+    // Map the metrics file
+    MetricsType *metrics = attachMetrics(path);
+    if (metrics == NULL) {
+        fprintf(stderr, "%s: not a metrics file, start the simulator with --metrics %s first\n", path, path);
+        return EXIT_FAILURE;
+    }
+
+    // Print a single snapshot when asked to
+    long long previous[MET_COUNT] = {0};
+    if (once) {
+        printMetrics(metrics, previous, 1);
+        closeMetrics(metrics);
+        return EXIT_SUCCESS;
+    }
+
+    // Otherwise refresh every second until interrupted
+    while (C_TRUE) {
+        // Clear the terminal and move the cursor home
+        printf("\033[H\033[2J");
+        printMetrics(metrics, previous, 1);
+        fflush(stdout);
+        sleep(1);
+    }
+}
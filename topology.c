@@ -0,0 +1,210 @@
+#define _GNU_SOURCE     // for sched_setaffinity and the CPU_* macros
+#include "defs.h"
+#include <dirent.h>      // for opendir
+#include <sched.h>       // for sched_getaffinity
+#include <sys/syscall.h> // for SYS_set_mempolicy
+
+// Memory policy preferring one node, from linux/mempolicy.h, which is not always installed
+#define MPOL_PREFERRED_NODE 1
+
+
+/*
+    Function: parseCpuList
+    Purpose: Reads a kernel CPU list such as "0-3,8-11" and keeps the CPUs the process may run on.
+    Params:
+        Input:
+            const char *list (in) - the CPU list
+            const cpu_set_t *allowed (in) - the CPUs the process may run on
+            TopologyType *topology (in/out) - the topology, whose CPU list the kept CPUs are appended to
+        Output: int - the number of CPUs kept
+*/
+static int parseCpuList(const char *list, const cpu_set_t *allowed, TopologyType *topology) {
+    int kept = 0;
+    const char *c = list;
+    while (*c >= '0' && *c <= '9') {
+        // Each entry is a CPU or a range of CPUs
+        char *end;
+        int first = (int)strtol(c, &end, 10);
+        int last = first;
+        if (*end == '-') {
+            last = (int)strtol(end + 1, &end, 10);
+        }
+        for (int cpu = first; cpu <= last && cpu < CPU_SETSIZE; cpu++) {
+            if (CPU_ISSET(cpu, allowed) && topology->totalCpus < TOPOLOGY_MAX_CPUS) {
+                topology->cpus[topology->totalCpus++] = cpu;
+                kept++;
+            }
+        }
+        c = *end == ',' ? end + 1 : end;
+    }
+    return kept;
+}
+
+
+/*
+    Function: readTopology
+    Purpose: Finds the NUMA nodes of the machine and the CPUs of each that the process may run on, from /sys. Machines without
+        NUMA, or without /sys, are one node holding every usable CPU.
+    Params:
+        Input: TopologyType *topology (out) - the topology found
+        Output: void
+*/
+void readTopology(TopologyType *topology) {
+    topology->numNodes = 0;
+    topology->totalCpus = 0;
+    cpu_set_t allowed;
+    CPU_ZERO(&allowed);
+    if (sched_getaffinity(0, sizeof(allowed), &allowed) != 0) {
+        CPU_SET(0, &allowed);
+    }
+
+    // Read each node's CPUs, skipping nodes with memory but no usable CPU
+    DIR *dir = opendir("/sys/devices/system/node");
+    struct dirent *entry;
+    while (dir != NULL && (entry = readdir(dir)) != NULL && topology->numNodes < TOPOLOGY_MAX_NODES) {
+        int id;
+        if (sscanf(entry->d_name, "node%d", &id) != 1) {
+            continue;
+        }
+        char path[MAX_STR * 4];
+        char list[MAX_STR * 16];
+        snprintf(path, sizeof(path), "/sys/devices/system/node/node%d/cpulist", id);
+        FILE *file = fopen(path, "r");
+        if (file == NULL) {
+            continue;
+        }
+        int read = fgets(list, sizeof(list), file) != NULL;
+        fclose(file);
+        int node = topology->numNodes;
+        topology->firstCpu[node] = topology->totalCpus;
+        topology->numCpus[node] = read ? parseCpuList(list, &allowed, topology) : 0;
+        if (topology->numCpus[node] > 0) {
+            topology->nodeIds[node] = id;
+            topology->numNodes++;
+        }
+    }
+    if (dir != NULL) {
+        closedir(dir);
+    }
+
+    // Without node information, every usable CPU is on node 0
+    if (topology->numNodes == 0) {
+        topology->totalCpus = 0;
+        for (int cpu = 0; cpu < CPU_SETSIZE && topology->totalCpus < TOPOLOGY_MAX_CPUS; cpu++) {
+            if (CPU_ISSET(cpu, &allowed)) {
+                topology->cpus[topology->totalCpus++] = cpu;
+            }
+        }
+        topology->numNodes = 1;
+        topology->nodeIds[0] = 0;
+        topology->firstCpu[0] = 0;
+        topology->numCpus[0] = topology->totalCpus;
+    }
+}
+
+
+/*
+    Function: planPlacement
+    Purpose: Places each worker slot on a node, spreading consecutive slots across nodes, and with core affinity on one CPU of
+        that node. A slot keeps its placement when its worker is replaced, so the houses it simulates stay on the same node.
+    Params:
+        Input:
+            const TopologyType *topology (in) - the usable CPUs and nodes
+            int affinity (in) - AFFINITY_NONE, AFFINITY_NODE or AFFINITY_CORE
+            WorkerType workers[] (in/out) - the workers, whose node and cpu are set
+            int numWorkers (in) - the number of workers
+        Output: void
+*/
+void planPlacement(const TopologyType *topology, int affinity, WorkerType workers[], int numWorkers) {
+    for (int i = 0; i < numWorkers; i++) {
+        workers[i].node = -1;
+        workers[i].cpu = -1;
+        if (affinity == AFFINITY_NONE) {
+            continue;
+        }
+        int node = i % topology->numNodes;
+        workers[i].node = node;
+        if (affinity == AFFINITY_CORE) {
+            int slot = (i / topology->numNodes) % topology->numCpus[node];
+            workers[i].cpu = topology->cpus[topology->firstCpu[node] + slot];
+        }
+    }
+}
+
+
+/*
+    Function: applyPlacement
+    Purpose: Pins the calling worker process to its planned CPUs, and on machines with several nodes asks for its memory to come
+        from its node. Threads the worker starts later inherit both, so every house it builds is allocated and simulated there.
+        A placement the kernel refuses is reported and otherwise ignored.
+    Params:
+        Input:
+            const TopologyType *topology (in) - the usable CPUs and nodes
+            const WorkerType *worker (in) - the worker's placement
+        Output: void
+*/
+void applyPlacement(const TopologyType *topology, const WorkerType *worker) {
+    if (worker->node < 0) {
+        return;
+    }
+
+    // Pin to the one planned CPU, or to every CPU of the node
+    cpu_set_t cpus;
+    CPU_ZERO(&cpus);
+    if (worker->cpu >= 0) {
+        CPU_SET(worker->cpu, &cpus);
+    } else {
+        for (int i = 0; i < topology->numCpus[worker->node]; i++) {
+            CPU_SET(topology->cpus[topology->firstCpu[worker->node] + i], &cpus);
+        }
+    }
+    if (sched_setaffinity(0, sizeof(cpus), &cpus) != 0) {
+        perror("sched_setaffinity");
+    }
+
+    // Memory is only worth steering when there is another node it could land on
+    if (topology->numNodes > 1) {
+        unsigned long mask = 1UL << topology->nodeIds[worker->node];
+        if (syscall(SYS_set_mempolicy, MPOL_PREFERRED_NODE, &mask, sizeof(mask) * 8) != 0) {
+            perror("set_mempolicy");
+        }
+    }
+}
+
+
+/*
+    Function: printTopology
+    Purpose: Prints the nodes and CPUs the process may use, and where each worker is placed.
+    Params:
+        Input:
+            const TopologyType *topology (in) - the usable CPUs and nodes
+            int affinity (in) - AFFINITY_NONE, AFFINITY_NODE or AFFINITY_CORE
+            const WorkerType workers[] (in) - the workers, with their placement planned
+            int numWorkers (in) - the number of workers
+        Output: void
+*/
+void printTopology(const TopologyType *topology, int affinity, const WorkerType workers[], int numWorkers) {
+    printf("Topology:          %d node%s, %d usable CPU%s\n", topology->numNodes, topology->numNodes == 1 ? "" : "s",
+           topology->totalCpus, topology->totalCpus == 1 ? "" : "s");
+    for (int node = 0; node < topology->numNodes; node++) {
+        printf("  node %-3d         CPUs", topology->nodeIds[node]);
+        for (int i = 0; i < topology->numCpus[node]; i++) {
+            printf(" %d", topology->cpus[topology->firstCpu[node] + i]);
+        }
+        printf("\n");
+    }
+    if (affinity == AFFINITY_NONE) {
+        printf("Placement:         none, workers are left to the scheduler\n");
+        return;
+    }
+    for (int i = 0; i < numWorkers; i++) {
+        if (workers[i].cpu >= 0) {
+            printf("  worker %-3d       node %d, CPU %d\n", i, topology->nodeIds[workers[i].node], workers[i].cpu);
+        } else {
+            printf("  worker %-3d       node %d, all its CPUs\n", i, topology->nodeIds[workers[i].node]);
+        }
+    }
+    if (topology->numNodes == 1) {
+        printf("Placement:         single node, memory is already local\n");
+    }
+}
@@ -1,4 +1,23 @@
 #include "defs.h"
+#include <time.h> // for clock_gettime
+
+// The calling thread's random stream, 0 until it is seeded
+static __thread unsigned int seed = 0;
+
+/*
+    Returns a pseudo randomly generated number in the range [0, 1), from the calling thread's stream.
+    Kept in double precision, as a float would round the top values up to exactly 1.
+*/
+static double randUnit()
+{
+    // Seed an unseeded thread for random number generation
+    if (seed == 0) {
+        // Use current time and thread ID to seed the random number generator
+        seed = (unsigned int)time(NULL) ^ (unsigned int)pthread_self();
+    }
+    // Divide by one more than the largest value so 1 itself is never returned
+    return (double) rand_r(&seed) / ((double) RAND_MAX + 1.0);
+}
 
 /*
     Returns a pseudo randomly generated number, in the range min to (max - 1), inclusively
@@ -8,8 +27,77 @@
 */
 int randInt(int min, int max)
 {
-    // Convert the result of randFloat to an integer and return it
-    return (int) randFloat(min, max);
+    // Scale in double precision, as rounding a float could land exactly on max
+    return min + (int) (randUnit() * (double) (max - min));
+}
+
+
+/*
+    Seeds the calling thread's random stream, so a hunt can be replayed from its seed.
+        in:   the seed, 0 is replaced since it means unseeded
+*/
+void seedRandom(unsigned int newSeed)
+{
+    seed = newSeed != 0 ? newSeed : 1;
+}
+
+
+/*
+    Returns the calling thread's random stream where it stands, so an agent moving to another thread can carry on with it.
+    return:   the state of the stream, to be passed to seedRandom
+*/
+unsigned int randomState()
+{
+    return seed;
+}
+
+
+/*
+    Derives the seed of one random stream of a hunt, so each agent gets an independent stream.
+        in:   the seed of the hunt
+        in:   the stream number, e.g. 0 for setup, 1 for the ghost, 2 and up for the hunters
+    return:   the seed of the stream
+*/
+unsigned int deriveSeed(unsigned int huntSeed, int stream)
+{
+    // Mix the two with a murmur-style finalizer so nearby seeds give unrelated streams
+    unsigned int x = huntSeed * 0x9e3779b9u + (unsigned int) stream * 0x85ebca6bu;
+    x ^= x >> 16;
+    x *= 0x7feb352du;
+    x ^= x >> 15;
+    x *= 0x846ca68bu;
+    x ^= x >> 16;
+    return x;
+}
+
+
+/*
+    Continues a 64-bit FNV-1a hash over some bytes, start from FNV_OFFSET.
+        in:   the hash so far
+        in:   the bytes to hash
+        in:   the number of bytes
+    return:   the hash including the bytes
+*/
+uint64_t hashBytes(uint64_t hash, const void *data, size_t size)
+{
+    const unsigned char *bytes = data;
+    for (size_t i = 0; i < size; i++) {
+        hash ^= bytes[i];
+        hash *= 0x100000001b3ULL;
+    }
+    return hash;
+}
+
+
+/*
+    Returns the time on the monotonic clock, for measuring how long things take.
+    return:   nanoseconds since an arbitrary starting point
+*/
+long long monotonicNanos()
+{
+    struct timespec now;
+    clock_gettime(CLOCK_MONOTONIC, &now);
+    return now.tv_sec * 1000000000LL + now.tv_nsec;
 }
 
 
@@ -21,15 +109,8 @@ int randInt(int min, int max)
     return:   randomly generated floating point number in the range [min, max)
 */
 float randFloat(float min, float max) {
-    // Initialize seed for random number generation
-    static __thread unsigned int seed = 0;
-    if (seed == 0) {
-        // Use current time and thread ID to seed the random number generator
-        seed = (unsigned int)time(NULL) ^ (unsigned int)pthread_self();
-    }
-
     // Generate a random float between 0 and 1
-    float random = ((float) rand_r(&seed)) / (float) RAND_MAX;
+    float random = (float) randUnit();
     // Calculate the range of the random number
     float diff = max - min;
     // Scale the random number by the range